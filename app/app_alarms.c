@@ -0,0 +1,194 @@
+/**
+* @file    app_alarms.c
+* @brief   **Alarm table and next alarm schedule**
+*
+*   This file keeps a table of ALARMS_NUMBER recurring alarms, every enabled alarm is expanded
+*   on one entry per weekday it repeats, the entries are kept sorted by the minute of the week
+*   they happen, so the next alarm is found with a binary search. The schedule is only rebuilt
+*   when an alarm is changed, nothing is done on every second.
+*/
+#include "app_alarms.h"
+#include <string.h>
+
+/**
+  * @defgroup Alarms_week values to calculate the minute of the week
+  @{ */
+#define DAYS_PER_WEEK       7u      /*!< Days of the week*/
+#define MINUTES_PER_DAY     1440u   /*!< Minutes of one day*/
+#define MINUTES_PER_HOUR    60u     /*!< Minutes of one hour*/
+#define HOURS_PER_DAY       24u     /*!< Hours of one day*/
+#define SCHEDULE_SIZE       (ALARMS_NUMBER * DAYS_PER_WEEK)    /*!< Max number of entries on the schedule*/
+/**
+  @} */
+
+/**
+* @brief  Table with the alarm configuration
+*/
+static APP_AlarmTypeDef AlarmTable[ALARMS_NUMBER];
+
+/**
+* @brief  Sorted schedule, minute of the week of each entry, the alarm slot and the weekday
+*/
+static uint16_t ScheduleKey[SCHEDULE_SIZE];
+static uint8_t ScheduleSlot[SCHEDULE_SIZE];
+static uint8_t ScheduleDay[SCHEDULE_SIZE];
+
+/**
+* @brief  Number of entries on the schedule
+*/
+static uint8_t ScheduleCount;
+
+static void Alarms_Rebuild( void );
+
+/**
+* @brief   **Init function for the alarm table**
+*
+*   All the alarms of the table are disabled and the schedule is emptied.
+*/
+void Alarms_Init( void )
+{
+    (void)memset( AlarmTable, 0, sizeof(AlarmTable) );
+    ScheduleCount = 0u;
+}
+
+/**
+* @brief   **Configures one alarm of the table**
+*
+*   The function validates the parameters, copies them to the table and rebuilds
+*   the sorted schedule, an alarm with no weekdays is stored as disabled.
+*
+* @param   slot[in]    position of the alarm on the table
+* @param   alarm[in]   alarm configuration
+*
+* @retval  TRUE if the alarm was stored, otherwise FALSE
+*/
+uint8_t Alarms_Set( uint8_t slot, const APP_AlarmTypeDef *alarm )
+{
+    uint8_t alarm_set = FALSE;
+
+    if( (slot < ALARMS_NUMBER) && (alarm->hour < HOURS_PER_DAY) && (alarm->minute < MINUTES_PER_HOUR) &&
+        (alarm->weekdays <= ALARMS_ALL_DAYS) )
+    {
+        AlarmTable[slot] = *alarm;
+        if( alarm->weekdays == 0u )
+        {
+            AlarmTable[slot].enable = FALSE;
+        }
+        Alarms_Rebuild();
+        alarm_set = TRUE;
+    }
+
+    return alarm_set;
+}
+
+/**
+* @brief   **Gets the configuration of one alarm of the table**
+*
+* @param   slot[in]    position of the alarm on the table
+* @param   alarm[out]  alarm configuration
+*
+* @retval  TRUE if the slot exists, otherwise FALSE
+*/
+uint8_t Alarms_Get( uint8_t slot, APP_AlarmTypeDef *alarm )
+{
+    uint8_t alarm_get = FALSE;
+
+    if( slot < ALARMS_NUMBER )
+    {
+        *alarm = AlarmTable[slot];
+        alarm_get = TRUE;
+    }
+
+    return alarm_get;
+}
+
+/**
+* @brief   **Gets the next alarm after the given time**
+*
+*   The function calculates the minute of the week of the given time and looks with a
+*   binary search for the first entry of the schedule that is after it, if there is none
+*   the first entry of the week is the next alarm. An alarm on the current minute is
+*   considered already happened.
+*
+* @param   wday[in]        current day of the week, 1 monday to 7 sunday like the RTC
+* @param   hour[in]        current hour
+* @param   minute[in]      current minute
+* @param   slot[out]       slot of the next alarm
+* @param   next_wday[out]  day of the week of the next alarm, 1 monday to 7 sunday
+*
+* @retval  TRUE if there is an enabled alarm, otherwise FALSE
+*/
+uint8_t Alarms_Next( uint8_t wday, uint8_t hour, uint8_t minute, uint8_t *slot, uint8_t *next_wday )
+{
+    uint8_t alarm_found = FALSE;
+    uint16_t now = (uint16_t)( (((uint32_t)wday - 1u) * MINUTES_PER_DAY) + ((uint32_t)hour * MINUTES_PER_HOUR) + minute );
+    uint8_t low = 0u;
+    uint8_t high = ScheduleCount;
+    uint8_t middle;
+
+    if( ScheduleCount > 0u )
+    {
+        while( low < high )
+        {
+            middle = (low + high) >> 1u;
+            if( ScheduleKey[middle] <= now )
+            {
+                low = middle + 1u;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+
+        if( low == ScheduleCount )
+        {
+            /*no alarm left this week, the next one is the first of the week*/
+            low = 0u;
+        }
+        *slot      = ScheduleSlot[low];
+        *next_wday = ScheduleDay[low];
+        alarm_found = TRUE;
+    }
+
+    return alarm_found;
+}
+
+/**
+* @brief   **Rebuilds the sorted schedule**
+*
+*   Each enabled alarm adds one entry for every day it repeats, the entries are
+*   placed with an insertion sort, this is only done when the table changes.
+*/
+static void Alarms_Rebuild( void )
+{
+    uint16_t key;
+    uint8_t pos;
+
+    ScheduleCount = 0u;
+    for( uint8_t slot = 0u; slot < ALARMS_NUMBER; slot++ )
+    {
+        if( AlarmTable[slot].enable == TRUE )
+        {
+            for( uint8_t day = 0u; day < DAYS_PER_WEEK; day++ )
+            {
+                if( (AlarmTable[slot].weekdays & (1u << day)) != 0u )
+                {
+                    key = (uint16_t)( ((uint32_t)day * MINUTES_PER_DAY) + ((uint32_t)AlarmTable[slot].hour * MINUTES_PER_HOUR) + AlarmTable[slot].minute );
+                    pos = ScheduleCount;
+                    while( (pos > 0u) && (ScheduleKey[pos - 1u] > key) )
+                    {
+                        ScheduleKey[pos]  = ScheduleKey[pos - 1u];
+                        ScheduleSlot[pos] = ScheduleSlot[pos - 1u];
+                        ScheduleDay[pos]  = ScheduleDay[pos - 1u];
+                        pos--;
+                    }
+                    ScheduleKey[pos]  = key;
+                    ScheduleSlot[pos] = slot;
+                    ScheduleDay[pos]  = day + 1u;
+                    ScheduleCount++;
+                }
+            }
+        }
+    }
+}
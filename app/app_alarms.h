@@ -0,0 +1,43 @@
+/**
+* @file    <app_alarms.h>
+* @brief   **Header file for app_alarms.c**
+*
+*   This file contains the declaration for the functions on the .c file
+*   and the structure of each alarm of the table.
+*   To use this aplication you need to first call the Alarms_Init function,
+*   then configure the alarms with Alarms_Set and ask for the next one with Alarms_Next.
+* @note    The table does not access the RTC, app_clock is in charge of programming
+*          the alarm returned by Alarms_Next
+*/
+#ifndef APP_ALARMS_H__
+#define APP_ALARMS_H__
+
+#include "app_bsp.h"
+
+/**
+  * @defgroup Alarms_conf alarm table configuration
+  @{ */
+#define ALARMS_NUMBER       8u      /*!< Number of alarms in the table*/
+#define ALARMS_ALL_DAYS     0x7Fu   /*!< Weekday mask to repeat an alarm every day, bit 0 is monday*/
+/**
+  @} */
+
+/**
+* @brief   Structure with the configuration of one alarm
+*/
+typedef struct _APP_AlarmTypeDef
+{
+  uint8_t hour;         /*!< hour of the alarm, range 0 to 23 */
+  uint8_t minute;       /*!< minutes of the alarm, range 0 to 59 */
+  uint8_t weekdays;     /*!< days the alarm repeats, bit 0 monday to bit 6 sunday */
+  uint8_t enable;       /*!< TRUE if the alarm is enabled */
+  uint8_t snooze;       /*!< snooze time in minutes, 0 means the alarm cannot be snoozed */
+  uint8_t snooze_max;   /*!< max number of times the alarm can be snoozed */
+} APP_AlarmTypeDef;
+
+void Alarms_Init( void );
+uint8_t Alarms_Set( uint8_t slot, const APP_AlarmTypeDef *alarm );
+uint8_t Alarms_Get( uint8_t slot, APP_AlarmTypeDef *alarm );
+uint8_t Alarms_Next( uint8_t wday, uint8_t hour, uint8_t minute, uint8_t *slot, uint8_t *next_wday );
+
+#endif
@@ -1,4 +1,6 @@
 #include "app_analog.h"
+#include "app_config.h"
+#include "scheduler.h"
 
 /**
   * @defgroup Numbers defines
@@ -17,7 +19,21 @@
 /** 
   * @defgroup DMA values configurations
   @{ */
-#define ARRAY_LENGHT      5u    /*!< Lenght of the array to stored with dma*/
+#define CHANNELS          6u    /*!< Channels of one sequence of the adc*/
+#define SEQUENCES         4u    /*!< Sequences of the buffer, each half has 2 of them*/
+#define ARRAY_LENGHT      (CHANNELS * SEQUENCES)    /*!< Lenght of the array to stored with dma*/
+#define HALF_LENGHT       (ARRAY_LENGHT / TWO)      /*!< Lenght of one half of the array*/
+/**
+  @} */
+
+/** 
+  * @defgroup Filter values of the filters, the filtered values are fixed point with 8 bits of fraction
+  @{ */
+#define FILTER_SHIFT      8u    /*!< Bits of fraction of the filtered values*/
+#define FILTER_ROUND      128u  /*!< Half of one unit, to round the filtered values*/
+#define FILTER_IIR_SHIFT  2u    /*!< Each half gives a quarter of the new value to the filter*/
+#define HALF_SEQUENCES    (SEQUENCES / TWO)         /*!< Sequences averaged on each half*/
+#define FILTER_VALUE(x)   (((x) + FILTER_ROUND) >> FILTER_SHIFT)    /*!< Filtered value rounded to the bits of the adc*/
 /**
   @} */
 
@@ -26,16 +42,35 @@
   @{ */ 
 #define MAX_CONTRAST              15u      /*!< Max value accepted by the lcd contrast command*/
 #define MAX_INTENSITY             100u     /*!< Max value of the backlight pwm*/
-#define MAX_POT_VALUE             255u     /*!< Max value of the pot*/
+#define MAX_POT_VALUE             4095u    /*!< Max value of the pot, 12 bits*/
 #define POT_INTENSITY             0     /*!< Value to use pot intensity*/
 #define POT_CONTRAST              1      /*!< Value to use pot for contrast*/
 #define POT_INTENSITY_CHECK       2    /*!< Value to use pot intensity check*/
 #define POT_CONTRAST_CHECK        3     /*!< Value to use pot for contrast check*/
-#define POT_TEMPERATURE           4     /*!< Value to use pot for contrast check*/
+#define POT_TEMPERATURE           4     /*!< Value of the temperature sensor*/
+#define POT_VREFINT               5     /*!< Value of the internal voltage reference*/
 #define PERCENT_100               100u      /*!< Value to use pot for functinal safety calculations*/
 #define PERCENT_90                90u       /*!< Value to use pot for functinal safety calculations*/
 #define PERCENT_110               110u      /*!< Value to use pot for functinal safety calculations*/
 
+/**
+  @} */
+
+/** 
+  * @defgroup Events values of the change events of the pots
+  @{ */
+#define INPUTS                    2u       /*!< Inputs that send change events*/
+#define SUBSCRIBERS               2u       /*!< Max subscriptions to the change events*/
+#define DEADBAND_DEFAULT          32u      /*!< Counts a pot has to move to send an event, 0.8% of the pot*/
+/**
+  @} */
+
+/** 
+  * @defgroup Temperature values of the calibrated temperature in tenths of C
+  @{ */
+#define TEMP_CAL1_TENTHS          300      /*!< Temperature of TS_CAL1, 30 C*/
+#define TEMP_SPAN_TENTHS          1000     /*!< Temperature from TS_CAL1 to TS_CAL2, 100 C*/
+#define TEMP_TYP_SPAN             341u     /*!< Counts of 100 C with the typical slope of 2.5 mV/C at 3.0 V, when there is no TS_CAL2*/
 /**
   @} */
 
@@ -48,10 +83,55 @@
   @} */
 
 /**
- * @brief  Array were data of the DMA will be stored
+ * @brief  Array were data of the DMA will be stored, the DMA writes one half while the other is filtered
  */
 static uint32_t AdcData[ARRAY_LENGHT];
 
+/**
+ * @brief  Filtered value of each channel, only written by the DMA interrupt
+ */
+static uint32_t Filtered[CHANNELS];
+static uint8_t Filtered_Valid = FALSE;
+
+/**
+ * @brief  Subscription to the change events, the changes are only written by the DMA interrupt
+ *         and taken by the task of the subscriber
+ */
+typedef struct _Analogs_SubscriberTypeDef
+{
+  uint8_t inputs;             /*!< Inputs of @ref Analogs_inputs the subscriber wants */
+  uint8_t work;               /*!< Deferred work of the scheduler posted on a change */
+  volatile uint8_t changes;   /*!< Inputs that changed since the subscriber read them */
+} Analogs_SubscriberTypeDef;
+
+/**
+ * @brief  Subscriptions and number of them
+ */
+static Analogs_SubscriberTypeDef Subscribers[SUBSCRIBERS];
+static uint8_t Subscriptions = CERO;
+
+/**
+ * @brief  Channels of the pot and its check of each input, and the deadband of the input
+ */
+static const uint8_t InputChannels[INPUTS][TWO] =
+{
+  { POT_INTENSITY, POT_INTENSITY_CHECK },
+  { POT_CONTRAST,  POT_CONTRAST_CHECK },
+};
+static uint16_t Deadband[INPUTS] = { DEADBAND_DEFAULT, DEADBAND_DEFAULT };
+
+/**
+ * @brief  Value of each channel of the pots on its last event, the getters of the pots use it
+ */
+static uint16_t Reported[CHANNELS];
+
+/**
+ * @brief  Factory calibration of the temperature sensor and the internal reference, read once
+ */
+static int32_t Ts_Cal1;
+static int32_t Ts_Span;
+static uint32_t Vref_Cal;
+
 /**
  * @brief  Variable DMA configuration
  */
@@ -65,6 +145,10 @@ ADC_HandleTypeDef  AdcHandler;          /*adc handler estructure*/
 
 uint8_t Analogs_GetContrast( void );
 uint8_t Analogs_GetIntensity( void );
+static void Analogs_Filter( const uint32_t *half );
+static void Analogs_Snapshot( uint32_t *values );
+static void Analogs_Reported( uint8_t pot, uint8_t check, uint32_t *values );
+static void Analogs_Events( void );
 
 /**
 * @brief   **This function intiates the functions used by the analog file**
@@ -76,10 +160,15 @@ uint8_t Analogs_GetIntensity( void );
 *  so that the timer will automatically trigger the ADC conversion at each interval,
 *  without any CPU intervention, this timer is every 20ms
 *  tim_frequency=32mhz/64/10000=50ms.
-*  then we confidgure the adc parameters, the resolution will be of 8 bits, it is 
-*  configure to be triggered by the tim and to call the dma to store the data.
-*  lastly we configure the channels to be read by the ADC wich are 2 pots
-*  and the internal temperature sensor.
+*  then we confidgure the adc parameters, the resolution will be of 12 bits with 16 samples
+*  averaged by the hardware oversampling, it is configure to be triggered by the tim and to
+*  call the dma to store the data on a circular buffer of 4 sequences, each half of it is
+*  filtered when the dma ends it.
+*  lastly we configure the channels to be read by the ADC wich are 2 pots with their checks,
+*  the internal temperature sensor and the internal reference, these two need at least 5us
+*  and 4us of sampling time so they take the second sampling time of 160.5 cycles, 20us
+*  with the adc clock of 8MHz (PCLK of 32MHz divided by four). The factory calibration is
+*  read once.
 * 
 */
 void Analogs_Init( void )
@@ -126,17 +215,21 @@ void Analogs_Init( void )
   HAL_NVIC_EnableIRQ( DMA1_Channel1_IRQn );
 
   AdcHandler.Instance                   = ADC1;
-  AdcHandler.Init.ClockPrescaler        = ADC_CLOCK_SYNC_PCLK_DIV4;   /*APB clock divided by two*/
-  AdcHandler.Init.Resolution            = ADC_RESOLUTION8b;           /*8 bit resolution with a Tconv of 8.5*/
+  AdcHandler.Init.ClockPrescaler        = ADC_CLOCK_SYNC_PCLK_DIV4;   /*APB clock of 32MHz divided by four, 8MHz*/
+  AdcHandler.Init.Resolution            = ADC_RESOLUTION_12B;         /*12 bit resolution with a Tconv of 12.5*/
   AdcHandler.Init.ScanConvMode          = ADC_SCAN_SEQ_FIXED;         /*scan adc channels from 0 to 16 in that order*/
   AdcHandler.Init.DataAlign             = ADC_DATAALIGN_RIGHT;        /*data converter is right alightned*/
-  AdcHandler.Init.SamplingTimeCommon1   = ADC_SAMPLETIME_39CYCLES_5;    /*sampling time of 1.5*/  
+  AdcHandler.Init.SamplingTimeCommon1   = ADC_SAMPLETIME_39CYCLES_5;    /*sampling time of the pots*/
+  AdcHandler.Init.SamplingTimeCommon2   = ADC_SAMPLETIME_160CYCLES_5;   /*sampling time of the internal channels, 20us*/
   AdcHandler.Init.ExternalTrigConv      = ADC_EXTERNALTRIG_T4_TRGO;   /*set the timer TIM3 to trigger the ADC*/
   AdcHandler.Init.ExternalTrigConvEdge  = ADC_EXTERNALTRIGCONVEDGE_RISING;  /*only on rising edges*/
   AdcHandler.Init.DMAContinuousRequests = ENABLE;
   AdcHandler.Init.EOCSelection          = ADC_EOC_SEQ_CONV;        /*ISR at the end of one channel conversion*/
   AdcHandler.Init.Overrun               = ADC_OVR_DATA_OVERWRITTEN;   /*data will be overwriten in case is not read it*/
-  AdcHandler.Init.OversamplingMode      = FOUR;   
+  AdcHandler.Init.OversamplingMode      = ENABLE;                     /*each conversion is the average of 16*/
+  AdcHandler.Init.Oversampling.Ratio          = ADC_OVERSAMPLING_RATIO_16;
+  AdcHandler.Init.Oversampling.RightBitShift  = ADC_RIGHTBITSHIFT_4;       /*the sum of 16 back to 12 bits*/
+  AdcHandler.Init.Oversampling.TriggeredMode  = ADC_TRIGGEREDMODE_SINGLE_TRIGGER;   /*the 16 samples with one trigger*/
   HAL_ADC_Init( &AdcHandler );
   
   sChanConfig.Channel = ADC_CHANNEL_0;
@@ -152,7 +245,12 @@ void Analogs_Init( void )
   
   sChanConfig.Channel = ADC_CHANNEL_TEMPSENSOR;
   sChanConfig.Rank = ADC_RANK_CHANNEL_NUMBER;
-  sChanConfig.SamplingTime = ADC_SAMPLETIME_1CYCLE_5;
+  sChanConfig.SamplingTime = ADC_SAMPLINGTIME_COMMON_2;
+  HAL_ADC_ConfigChannel( &AdcHandler, &sChanConfig );
+
+  sChanConfig.Channel = ADC_CHANNEL_VREFINT;
+  sChanConfig.Rank = ADC_RANK_CHANNEL_NUMBER;
+  sChanConfig.SamplingTime = ADC_SAMPLINGTIME_COMMON_2;
   HAL_ADC_ConfigChannel( &AdcHandler, &sChanConfig );
 
 
@@ -169,7 +267,13 @@ void Analogs_Init( void )
   
   HAL_ADCEx_Calibration_Start( &AdcHandler );
 
-  HAL_ADC_Start_DMA( &AdcHandler, &AdcData[CERO], FIVE );
+  /*without TS_CAL2 the typical slope is used*/
+  Ts_Cal1  = (int32_t)*TEMPSENSOR_CAL1_ADDR;
+  Ts_Span  = ((int32_t)*TEMPSENSOR_CAL2_ADDR > Ts_Cal1) ? ((int32_t)*TEMPSENSOR_CAL2_ADDR - Ts_Cal1) : (int32_t)TEMP_TYP_SPAN;
+  Ts_Span  = Ts_Span << FILTER_SHIFT;
+  Vref_Cal = (uint32_t)*VREFINT_CAL_ADDR;
+
+  HAL_ADC_Start_DMA( &AdcHandler, &AdcData[CERO], ARRAY_LENGHT );
 
   HAL_TIM_Base_Start( &TimHandler );
 }
@@ -177,31 +281,42 @@ void Analogs_Init( void )
 /**
 * @brief   **This returns the temperature**
 *
-*  this function returns the temperature given by the internal sensor
-*  this uses the hal function __HAL_ADC_CALC_TEMPERATURE this takes as parameter
-*  the vref of the sensor in wich we will use the define VDD_VALUE that is equal to
-*  3300 note that this value refers to milivolts, the value of the temperature
-*  that is stored by the dma in the position 2 of Adcdata array
+*  this function returns the temperature given by the internal sensor in tenths of C
+*  with its factory calibration, TS_CAL1 and TS_CAL2 are the values of the sensor at 30 C
+*  and 130 C with 3.0 V, the value of the sensor is first taken to 3.0 V with the internal
+*  reference, VREFINT_CAL is its value with 3.0 V, so the supply does not change the reading.
+*  the filtered values keep their 8 bits of fraction for the calculation.
+*  sensor at 3.0 V = sensor * VREFINT_CAL / vrefint
+*  temperature = ((sensor at 3.0 V - TS_CAL1) * 1000 / (TS_CAL2 - TS_CAL1)) + 300
 *  
-* @retval  temperature temperature of the sensor on C
+* @retval  temperature temperature of the sensor in tenths of C
 */
-int8_t Analogs_GetTemperature( void )
+int16_t Analogs_GetTemperature( void )
 {
-  int8_t temperature;
+  int32_t temperature;
+  uint32_t sensor;
+  uint32_t values[CHANNELS];
 
-  temperature = __HAL_ADC_CALC_TEMPERATURE( VDD_VALUE, AdcData[POT_TEMPERATURE], ADC_RESOLUTION8b);
+  Analogs_Snapshot( values );
+  sensor = values[POT_TEMPERATURE];
+  if( values[POT_VREFINT] != CERO )
+  {
+    sensor = (sensor * Vref_Cal) / values[POT_VREFINT];
+  }
+  temperature = ((((int32_t)sensor - (Ts_Cal1 << FILTER_SHIFT)) * TEMP_SPAN_TENTHS) / Ts_Span) + TEMP_CAL1_TENTHS;
 
-  return temperature;
+  return (int16_t)temperature;
 }
 
 /**
 * @brief   **This returns the contrast of the lcd**
 *
 *  this function returns the contrast of the lcd, this is given
-*  by the pot value stored on AdcData[1], and we do a convertion
+*  by the value of the pot on its last event, and we do a convertion
 *  so that the value will be betwen 0 and 15;
 *  this function checks the pot that is connected to another pins
 *  if it is 10% off its value
+*  if a contrast was configured by CAN it is used instead of the pot
 *  
 * @retval  contrast contrast of the sensor
 */
@@ -209,10 +324,17 @@ uint8_t Analogs_GetContrast( void )
 {
   uint8_t contrast;
   uint32_t pot_check;
-  pot_check = ( ((uint32_t)AdcData[POT_CONTRAST])*PERCENT_100 ) / ((uint32_t)AdcData[POT_CONTRAST_CHECK]);
+  uint32_t values[TWO];
+
+  Analogs_Reported( POT_CONTRAST, POT_CONTRAST_CHECK, values );
+  pot_check = ( values[CERO]*PERCENT_100 ) / values[ONE];
   assert_error( (pot_check > PERCENT_90) && (pot_check < PERCENT_110), POT_CONTRAST_ERROR );       /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
 
-  contrast = (AdcData[POT_CONTRAST]*MAX_CONTRAST)/MAX_POT_VALUE;
+  contrast = (values[CERO]*MAX_CONTRAST)/MAX_POT_VALUE;
+  if( Config_Get()->contrast != CONFIG_NO_CONTRAST )
+  {
+    contrast = Config_Get()->contrast;
+  }
   
 
   return contrast;
@@ -222,7 +344,7 @@ uint8_t Analogs_GetContrast( void )
 * @brief   **This returns the intensity of the lcd**
 *
 *  this function returns the intensity of the lcd, this is given
-*  by the pot value stored on AdcData[0], and we do a convertion
+*  by the value of the pot on its last event, and we do a convertion
 *  so that the value will be betwen 0 and 100;
 *  this function checks the pot that is connected to another pins
 *  if it is 10% off its value 
@@ -232,8 +354,235 @@ uint8_t Analogs_GetIntensity( void )
 {
   uint8_t intensity;
   uint32_t pot_check;
-  pot_check = ( ((uint32_t)AdcData[POT_INTENSITY])*PERCENT_100)/ ((uint32_t)AdcData[POT_INTENSITY_CHECK]);
+  uint32_t values[TWO];
+
+  Analogs_Reported( POT_INTENSITY, POT_INTENSITY_CHECK, values );
+  pot_check = ( values[CERO]*PERCENT_100)/ values[ONE];
   assert_error( (pot_check > PERCENT_90) && (pot_check < PERCENT_110), POT_INTENSITY_ERROR );        /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-  intensity = (AdcData[POT_INTENSITY]*MAX_INTENSITY)/MAX_POT_VALUE;
+  intensity = (values[CERO]*MAX_INTENSITY)/MAX_POT_VALUE;
   return intensity;
 }
+
+/**
+* @brief   **Interruption of the first half of the adc buffer**
+*
+*  The dma ended the first half and writes now the second one, so the first half
+*  can be filtered without being changed meanwhile.
+*/
+void HAL_ADC_ConvHalfCpltCallback( ADC_HandleTypeDef *hadc )  /* cppcheck-suppress misra-c2012-8.4 ; no need for a declaration since is a library function*/
+{
+  (void)hadc;
+  Analogs_Filter( &AdcData[CERO] );
+}
+
+/**
+* @brief   **Interruption of the second half of the adc buffer**
+*
+*  The dma ended the second half and starts again with the first one.
+*/
+void HAL_ADC_ConvCpltCallback( ADC_HandleTypeDef *hadc )  /* cppcheck-suppress misra-c2012-8.4 ; no need for a declaration since is a library function*/
+{
+  (void)hadc;
+  Analogs_Filter( &AdcData[HALF_LENGHT] );
+}
+
+/**
+* @brief   **This function filters one half of the adc buffer**
+*
+*  The sequences of the half are averaged for each channel and the average goes to a
+*  first order IIR filter that takes a quarter of it each time, with 8 bits of fraction
+*  so the slow changes are not lost, the divisions are shifts. The first half sets the
+*  filters to its average so they do not start from 0.
+*  filtered = filtered - (filtered / 4) + ((average * 256) / 4)
+*
+* @param   half[in]  first sample of the half
+*/
+static void Analogs_Filter( const uint32_t *half )
+{
+  uint32_t sum;
+
+  for( uint8_t ch = CERO; ch < CHANNELS; ch++ )
+  {
+    sum = CERO;
+    for( uint8_t seq = CERO; seq < HALF_SEQUENCES; seq++ )
+    {
+      sum += half[(seq * CHANNELS) + ch];
+    }
+    /*the average with its fraction, the sequences are a power of 2*/
+    sum = (sum << FILTER_SHIFT) / HALF_SEQUENCES;
+
+    if( Filtered_Valid == FALSE )
+    {
+      Filtered[ch] = sum;
+    }
+    else
+    {
+      Filtered[ch] = (Filtered[ch] - (Filtered[ch] >> FILTER_IIR_SHIFT)) + (sum >> FILTER_IIR_SHIFT);
+    }
+  }
+
+  Analogs_Events();
+  Filtered_Valid = TRUE;
+}
+
+/**
+* @brief   **This function subscribes a deferred work to the change events of the pots**
+*
+*  The work is posted each time one of the inputs moves more than its deadband, and once
+*  with all of them when the first values are filtered. The work takes the inputs that
+*  changed with Analogs_GetChanges and reads them with their getters.
+*
+* @param   inputs[in]  inputs of @ref Analogs_inputs, or-ed
+* @param   work[in]    deferred work of the scheduler
+*
+* @retval  subscription from 1 to n, or 0 if there is no room
+*/
+uint8_t Analogs_Subscribe( uint8_t inputs, uint8_t work )
+{
+  uint8_t subscription = CERO;
+
+  if( Subscriptions < SUBSCRIBERS )
+  {
+    Subscribers[Subscriptions].inputs  = inputs;
+    Subscribers[Subscriptions].work    = work;
+    Subscribers[Subscriptions].changes = CERO;
+    Subscriptions++;
+    subscription = Subscriptions;
+  }
+
+  return subscription;
+}
+
+/**
+* @brief   **This function takes the inputs that changed for a subscription**
+*
+*  The changes are read and cleared with the dma interrupt disabled, a change after
+*  this call posts the work again.
+*
+* @param   subscription[in]  subscription given by Analogs_Subscribe
+*
+* @retval  inputs of @ref Analogs_inputs that changed, or-ed
+*/
+uint8_t Analogs_GetChanges( uint8_t subscription )
+{
+  uint8_t changes = CERO;
+
+  if( (subscription > CERO) && (subscription <= Subscriptions) )
+  {
+    HAL_NVIC_DisableIRQ( DMA1_Channel1_IRQn );
+    changes = Subscribers[subscription - ONE].changes;
+    Subscribers[subscription - ONE].changes = CERO;
+    HAL_NVIC_EnableIRQ( DMA1_Channel1_IRQn );
+  }
+
+  return changes;
+}
+
+/**
+* @brief   **This function sets the deadband of the inputs**
+*
+*  A pot, or its check, has to move more than the deadband from its last event to send
+*  a new one, so the noise of the adc does not send events.
+*
+* @param   inputs[in]    inputs of @ref Analogs_inputs, or-ed
+* @param   deadband[in]  counts of the adc of 12 bits
+*/
+void Analogs_SetDeadband( uint8_t inputs, uint16_t deadband )
+{
+  for( uint8_t input = CERO; input < INPUTS; input++ )
+  {
+    if( (inputs & (ONE << input)) != CERO )
+    {
+      Deadband[input] = deadband;
+    }
+  }
+}
+
+/**
+* @brief   **This function takes the values of a pot and its check on their last event**
+*
+*  The dma interrupt is disabled while they are copied, so both are from the same event.
+*
+* @param   pot[in]      channel of the pot
+* @param   check[in]    channel of its check
+* @param   values[out]  value of the pot and value of the check
+*/
+static void Analogs_Reported( uint8_t pot, uint8_t check, uint32_t *values )
+{
+  HAL_NVIC_DisableIRQ( DMA1_Channel1_IRQn );
+  values[CERO] = Reported[pot];
+  values[ONE]  = Reported[check];
+  HAL_NVIC_EnableIRQ( DMA1_Channel1_IRQn );
+}
+
+/**
+* @brief   **This function sends the change events of the pots, it is called by the dma interrupt**
+*
+*  Each pot and its check are compared with their values on the last event, when one of
+*  them moved more than the deadband both are taken as the new values and the works of
+*  the subscribers of the input are posted. The check sends events too so the getter checks
+*  the pot again when only the check moved. A value in the last deadband of the pot is taken
+*  as the max, the value reported below it is then always more than one deadband away, so the
+*  getters reach the full scale. The low end is not snapped since the check of the pot
+*  divides by it.
+*/
+static void Analogs_Events( void )
+{
+  uint8_t changed = CERO;
+  uint16_t values[TWO];
+  uint16_t delta;
+  uint8_t ch;
+
+  for( uint8_t input = CERO; input < INPUTS; input++ )
+  {
+    for( uint8_t i = CERO; i < TWO; i++ )
+    {
+      ch        = InputChannels[input][i];
+      values[i] = (uint16_t)FILTER_VALUE( Filtered[ch] );
+      /*the last deadband is taken as the end of the pot, or its events could stop before the max*/
+      if( values[i] >= (MAX_POT_VALUE - Deadband[input]) )
+      {
+        values[i] = MAX_POT_VALUE;
+      }
+      delta = (values[i] > Reported[ch]) ? (values[i] - Reported[ch]) : (Reported[ch] - values[i]);
+      if( (Filtered_Valid == FALSE) || (delta > Deadband[input]) )
+      {
+        changed |= (uint8_t)(ONE << input);
+      }
+    }
+
+    if( (changed & (ONE << input)) != CERO )
+    {
+      Reported[InputChannels[input][CERO]] = values[CERO];
+      Reported[InputChannels[input][ONE]]  = values[ONE];
+    }
+  }
+
+  for( uint8_t sub = CERO; (sub < Subscriptions) && (changed != CERO); sub++ )
+  {
+    if( (Subscribers[sub].inputs & changed) != CERO )
+    {
+      Subscribers[sub].changes |= Subscribers[sub].inputs & changed;
+      (void)HIL_SCHEDULER_PostWork( &sched, Subscribers[sub].work );
+    }
+  }
+}
+
+/**
+* @brief   **This function takes the filtered values of all the channels at once**
+*
+*  The dma interrupt is disabled while they are copied, so a pot and its check, or the
+*  sensor and the reference, are always from the same half. The values keep their fraction,
+*  FILTER_VALUE rounds them to the 12 bits of the adc.
+*
+* @param   values[out]  value of each channel with 8 bits of fraction
+*/
+static void Analogs_Snapshot( uint32_t *values )
+{
+  HAL_NVIC_DisableIRQ( DMA1_Channel1_IRQn );
+  for( uint8_t ch = CERO; ch < CHANNELS; ch++ )
+  {
+    values[ch] = Filtered[ch];
+  }
+  HAL_NVIC_EnableIRQ( DMA1_Channel1_IRQn );
+}
@@ -6,7 +6,8 @@
 *   And also has the declarations of the variables that we need.
 *   To use this aplication you need to first use the clock init function
 *   and then you can call the Task function.
-* @note    
+* @note    The pots are not polled, a consumer subscribes with the deferred work of the
+*          scheduler that reads them and the work is posted when a pot moves
 *          
 */
 #ifndef APP_ANALOG_H__
@@ -15,9 +16,20 @@
 #include "app_bsp.h"
 #include "hel_lcd.h"
 
+/**
+  * @defgroup Analogs_inputs inputs that send change events, they can be or-ed on a subscription
+  @{ */
+#define ANALOGS_INPUT_INTENSITY   0x01u   /*!< Pot of the intensity of the backlight*/
+#define ANALOGS_INPUT_CONTRAST    0x02u   /*!< Pot of the contrast of the lcd*/
+/**
+  @} */
+
 void Analogs_Init( void );
-int8_t Analogs_GetTemperature( void );
+int16_t Analogs_GetTemperature( void );
 uint8_t Analogs_GetIntensity( void );
 uint8_t Analogs_GetContrast( void );
+uint8_t Analogs_Subscribe( uint8_t inputs, uint8_t work );
+uint8_t Analogs_GetChanges( uint8_t subscription );
+void Analogs_SetDeadband( uint8_t inputs, uint16_t deadband );
 
 #endif
\ No newline at end of file
@@ -0,0 +1,264 @@
+/**
+* @file    app_backlight.c
+* @brief   **Backlight of the lcd with fades, dimming and blink by DMA**
+*
+*   TIM3 makes the pwm of the backlight with 100 counts per period, so its compare is the
+*   intensity in percent. The changes of intensity are not written by the CPU, TIM16 counts
+*   steps without interrupts and its update request makes DMA1 channel 3 write the next value
+*   of a table on the compare of TIM3. A fade is a table of 25 steps of 10 ms from the value
+*   shown to the new one that runs once, the blink of the alarm is a table of two values that
+*   repeats with steps of 500 ms. After one minute without presses the backlight fades to a
+*   quarter of its level and goes back with the next press.
+*/
+#include "app_backlight.h"
+
+/**
+  * @defgroup Backlight_pwm values of the pwm timer
+  @{ */
+#define BACKLIGHT_PWM_HZ        1000u    /*!< Frequency of the pwm*/
+#define BACKLIGHT_PERIOD        100u     /*!< Counts of one period, the compare is the intensity in percent*/
+#define BACKLIGHT_MAX           100u     /*!< Max intensity*/
+/**
+  @} */
+
+/**
+  * @defgroup Backlight_steps values of the step timer
+  @{ */
+#define BACKLIGHT_STEP_HZ       10000u   /*!< Frequency of TIM16, 0.1 ms per tick*/
+#define BACKLIGHT_TICKS_PER_MS  10u      /*!< Ticks of TIM16 in one ms*/
+#define BACKLIGHT_FADE_STEP_MS  10u      /*!< Length of one step of a fade*/
+#define BACKLIGHT_FADE_STEPS    25u      /*!< Steps of a fade, 250 ms*/
+#define BACKLIGHT_BLINK_MS      500u     /*!< Time on and time off of the blink*/
+#define BACKLIGHT_BLINK_STEPS   2u       /*!< Steps of the blink, off and on*/
+/**
+  @} */
+
+/**
+  * @defgroup Backlight_idle values of the dimming
+  @{ */
+#define BACKLIGHT_IDLE_MS       60000u   /*!< Time without presses to dim the backlight*/
+#define BACKLIGHT_DIM_DIV       4u       /*!< The dimmed backlight is a quarter of the level*/
+/**
+  @} */
+
+/**
+ * @brief  Variables for the pwm and step timers and the DMA channel
+ */
+static TIM_HandleTypeDef TimPwm;
+static TIM_HandleTypeDef TimStep;
+static DMA_HandleTypeDef DmaLevel;
+
+/**
+ * @brief  Values written on the compare of TIM3 by the DMA, one byte per step
+ */
+static uint8_t Steps[BACKLIGHT_FADE_STEPS];
+
+/**
+ * @brief  Level of the pot, and if the backlight is dimmed or blinking
+ */
+static uint8_t Level;
+static uint8_t Dimmed;
+static uint8_t Blinking;
+
+/**
+ * @brief  Time of the last press, to dim the backlight
+ */
+static uint32_t Activity_Tick;
+
+static void Backlight_Fade( uint8_t target );
+static void Backlight_Start( uint32_t mode, uint16_t steps, uint16_t step_ms );
+
+/**
+* @brief   **Init function for the backlight**
+*
+*   TIM3 is the pwm of the backlight on PB4, its pin is configured on HAL_TIM_PWM_MspInit
+*   and the compare is preloaded so each value of the DMA starts on a whole period. TIM16
+*   only gives the DMA request, its interrupt is not enabled because its vector is the
+*   one of FDCAN. The backlight starts off and fades to the level of the pot on its first read.
+*   The timer clock is twice the APB clock when the APB is divided.
+*   Prescaler = (timer clock / (1 kHz * 100)) - 1
+*/
+void Backlight_Init( void )
+{
+    TIM_OC_InitTypeDef sConfig;
+    uint32_t TimerClock = HAL_RCC_GetPCLK1Freq();
+
+    if( (RCC->CFGR & RCC_CFGR_PPRE) != RCC_HCLK_DIV1 )
+    {
+        TimerClock *= 2u;
+    }
+
+    TimPwm.Instance                 = TIM3;
+    TimPwm.Init.Prescaler           = (TimerClock / (BACKLIGHT_PWM_HZ * BACKLIGHT_PERIOD)) - 1u;
+    TimPwm.Init.Period              = BACKLIGHT_PERIOD - 1u;
+    TimPwm.Init.CounterMode         = TIM_COUNTERMODE_UP;
+    TimPwm.Init.AutoReloadPreload   = TIM_AUTORELOAD_PRELOAD_ENABLE;
+    Status = HAL_TIM_PWM_Init( &TimPwm );
+    assert_error( Status == HAL_OK, BACKLIGHT_TIM_INIT_ERROR );    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+
+    sConfig.OCMode     = TIM_OCMODE_PWM1;
+    sConfig.OCPolarity = TIM_OCPOLARITY_HIGH;
+    sConfig.OCFastMode = TIM_OCFAST_DISABLE;
+    sConfig.Pulse      = 0u;
+    Status = HAL_TIM_PWM_ConfigChannel( &TimPwm, &sConfig, TIM_CHANNEL_1 );
+    assert_error( Status == HAL_OK, BACKLIGHT_TIM_INIT_ERROR );    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+    Status = HAL_TIM_PWM_Start( &TimPwm, TIM_CHANNEL_1 );
+    assert_error( Status == HAL_OK, BACKLIGHT_TIM_INIT_ERROR );    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+
+    __HAL_RCC_TIM16_CLK_ENABLE();
+    TimStep.Instance            = TIM16;
+    TimStep.Init.Prescaler      = (TimerClock / BACKLIGHT_STEP_HZ) - 1u;
+    TimStep.Init.Period         = (BACKLIGHT_FADE_STEP_MS * BACKLIGHT_TICKS_PER_MS) - 1u;
+    TimStep.Init.CounterMode    = TIM_COUNTERMODE_UP;
+    Status = HAL_TIM_Base_Init( &TimStep );
+    assert_error( Status == HAL_OK, BACKLIGHT_TIM_INIT_ERROR );    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+
+    __HAL_RCC_DMA1_CLK_ENABLE();
+    DmaLevel.Instance                   = DMA1_Channel3;
+    DmaLevel.Init.Request               = DMA_REQUEST_TIM16_UP;
+    DmaLevel.Init.Direction             = DMA_MEMORY_TO_PERIPH;     /*steps to the compare of TIM3*/
+    DmaLevel.Init.PeriphInc             = DMA_PINC_DISABLE;         /*always the same register*/
+    DmaLevel.Init.MemInc                = DMA_MINC_ENABLE;          /*next step*/
+    DmaLevel.Init.PeriphDataAlignment   = DMA_PDATAALIGN_HALFWORD;  /*the byte is written as a half word*/
+    DmaLevel.Init.MemDataAlignment      = DMA_MDATAALIGN_BYTE;      /*1 byte per step*/
+    DmaLevel.Init.Mode                  = DMA_NORMAL;               /*a fade runs once*/
+    DmaLevel.Init.Priority              = DMA_PRIORITY_LOW;         /*one transfer every 10 ms*/
+    Status = HAL_DMA_Init( &DmaLevel );
+    assert_error( Status == HAL_OK, BACKLIGHT_DMA_ERROR );         /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+
+    Level         = 0u;
+    Dimmed        = FALSE;
+    Blinking      = FALSE;
+    Activity_Tick = HAL_GetTick();
+}
+
+/**
+* @brief   **This function sets the level of the backlight**
+*
+*   The backlight fades to the new level, or to its quarter when it is dimmed. While it
+*   blinks the level is only kept and it is used by the next blink or fade.
+*
+* @param   level[in]  intensity in percent, 0 to 100
+*/
+void Backlight_SetLevel( uint8_t level )
+{
+    Level = (level > BACKLIGHT_MAX) ? BACKLIGHT_MAX : level;
+
+    if( Blinking == FALSE )
+    {
+        Backlight_Fade( (Dimmed == TRUE) ? (Level / BACKLIGHT_DIM_DIV) : Level );
+    }
+}
+
+/**
+* @brief   **This function tells the backlight that the button was pressed**
+*
+*   The time without presses starts again and a dimmed backlight fades back to its level.
+*/
+void Backlight_Activity( void )
+{
+    Activity_Tick = HAL_GetTick();
+
+    if( (Dimmed == TRUE) && (Blinking == FALSE) )
+    {
+        Dimmed = FALSE;
+        Backlight_Fade( Level );
+    }
+}
+
+/**
+* @brief   **This function starts or stops the blink of the backlight**
+*
+*   The blink turns the backlight off and on every 500 ms by itself until it is stopped,
+*   then the backlight fades to its level and the time without presses starts again.
+*
+* @param   blink[in]  TRUE to start the blink, FALSE to stop it
+*/
+void Backlight_Blink( uint8_t blink )
+{
+    if( blink == TRUE )
+    {
+        Blinking = TRUE;
+        Steps[0] = 0u;
+        Steps[1] = Level;
+        Backlight_Start( DMA_CIRCULAR, BACKLIGHT_BLINK_STEPS, BACKLIGHT_BLINK_MS );
+    }
+    else if( Blinking == TRUE )
+    {
+        Blinking = FALSE;
+        Dimmed   = FALSE;
+        Activity_Tick = HAL_GetTick();
+        Backlight_Fade( Level );
+    }
+    else
+    {
+    }
+}
+
+/**
+* @brief   **This function checks the time without presses, it is called by the lcd task**
+*
+*   After one minute without presses the backlight fades to a quarter of its level.
+*/
+void Backlight_Task( void )
+{
+    if( (Dimmed == FALSE) && (Blinking == FALSE) && ((HAL_GetTick() - Activity_Tick) >= BACKLIGHT_IDLE_MS) )
+    {
+        Dimmed = TRUE;
+        Backlight_Fade( Level / BACKLIGHT_DIM_DIV );
+    }
+}
+
+/**
+* @brief   **This function starts a fade from the value shown to a new one**
+*
+*   The fade starts from the compare of TIM3, so a fade stopped on its way starts from
+*   where it was, the divisions of the steps are only done here when it starts.
+*   Step = start + ((target - start) * step / steps)
+*
+* @param   target[in]  intensity at the end of the fade
+*/
+static void Backlight_Fade( uint8_t target )
+{
+    int16_t start = (int16_t)__HAL_TIM_GET_COMPARE( &TimPwm, TIM_CHANNEL_1 );
+    int16_t delta = (int16_t)target - start;
+
+    for( uint8_t i = 0u; i < BACKLIGHT_FADE_STEPS; i++ )
+    {
+        Steps[i] = (uint8_t)(start + ((delta * (int16_t)(i + 1u)) / (int16_t)BACKLIGHT_FADE_STEPS));
+    }
+
+    Backlight_Start( DMA_NORMAL, BACKLIGHT_FADE_STEPS, BACKLIGHT_FADE_STEP_MS );
+}
+
+/**
+* @brief   **This function starts the DMA with the steps on the table**
+*
+*   The step timer and the DMA are stopped, the channel is configured again for a fade that
+*   runs once or a blink that repeats, and both start with the first step one period later.
+*
+* @param   mode[in]     DMA_NORMAL or DMA_CIRCULAR
+* @param   steps[in]    number of steps on the table
+* @param   step_ms[in]  length of one step in ms
+*/
+static void Backlight_Start( uint32_t mode, uint16_t steps, uint16_t step_ms )
+{
+    __HAL_TIM_DISABLE( &TimStep );
+    __HAL_TIM_DISABLE_DMA( &TimStep, TIM_DMA_UPDATE );
+    (void)HAL_DMA_Abort( &DmaLevel );
+
+    if( DmaLevel.Init.Mode != mode )
+    {
+        DmaLevel.Init.Mode = mode;
+        Status = HAL_DMA_Init( &DmaLevel );
+        assert_error( Status == HAL_OK, BACKLIGHT_DMA_ERROR );     /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+    }
+
+    Status = HAL_DMA_Start( &DmaLevel, (uint32_t)Steps, (uint32_t)&TimPwm.Instance->CCR1, steps );
+    assert_error( Status == HAL_OK, BACKLIGHT_DMA_ERROR );         /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+
+    __HAL_TIM_SET_AUTORELOAD( &TimStep, ((uint32_t)step_ms * BACKLIGHT_TICKS_PER_MS) - 1u );
+    __HAL_TIM_SET_COUNTER( &TimStep, 0u );
+    __HAL_TIM_ENABLE_DMA( &TimStep, TIM_DMA_UPDATE );
+    __HAL_TIM_ENABLE( &TimStep );
+}
@@ -0,0 +1,22 @@
+/**
+* @file    <app_backlight.h>
+* @brief   **Header file for app_backlight.c**
+*
+*   This file contains the declaration for the functions on the .c file.
+*   To use this aplication you need to first call the Backlight_Init function, then the
+*   level of the pot is given with Backlight_SetLevel, each press of the button calls
+*   Backlight_Activity and Backlight_Task checks the time to dim the backlight.
+* @note    The fades and the blink are written on the pwm by DMA, the functions only start them
+*/
+#ifndef APP_BACKLIGHT_H__
+#define APP_BACKLIGHT_H__
+
+#include "app_bsp.h"
+
+void Backlight_Init( void );
+void Backlight_SetLevel( uint8_t level );
+void Backlight_Activity( void );
+void Backlight_Blink( uint8_t blink );
+void Backlight_Task( void );
+
+#endif
@@ -21,6 +21,16 @@
   /**
   @} */
 
+  /** 
+  * @defgroup Clock_msg messages sent by the display task to the clock task.
+  @{ */
+  #define    CLOCK_MSG_FLAG_OFF     9u    /*!< The alarm has finished*/
+  #define    CLOCK_MSG_SNOOZE       10u   /*!< The alarm was stopped with the button and can be snoozed*/
+  #define    CLOCK_MSG_CHANGE_TZ    11u   /*!< Change the time zone and daylight saving rule*/
+  #define    CLOCK_MSG_ENABLE_ALARM 12u   /*!< Enable or disable one alarm of the table from the menu*/
+  /**
+  @} */
+
   /** 
   * @defgroup Display Display task values.
   @{ */
@@ -86,37 +96,51 @@
     SHCEDULER_DISPLAY_ERROR,
     SHCEDULER_HEARTH_ERROR,
     POT_CONTRAST_ERROR,
-    POT_INTENSITY_ERROR
+    POT_INTENSITY_ERROR,
+    FDCAN_PROTOCOL_STATUS_ERROR,
+    FDCAN_RECOVERY_ERROR,
+    SHCEDULER_ANALOG_ERROR,
+    SHCEDULER_CANHEALTH_ERROR,
+    RTC_SET_ALARMB_ERROR,
+    TZ_PAR_ERROR,
+    RTC_SMOOTHCALIB_ERROR,
+    SHCEDULER_RTCCAL_ERROR,
+    RTC_SET_WAKEUP_ERROR,
+    STORE_PAR_ERROR,
+    FLASH_UNLOCK_ERROR,
+    FLASH_LOCK_ERROR,
+    FLASH_ERASE_ERROR,
+    SHCEDULER_CONFIG_ERROR,
+    SHCEDULER_STOPWATCH_ERROR,
+    SHCEDULER_LOG_ERROR,
+    BUTTON_TIM_INIT_ERROR,
+    BUZZER_TIM_INIT_ERROR,
+    BUZZER_DMA_ERROR,
+    BACKLIGHT_TIM_INIT_ERROR,
+    BACKLIGHT_DMA_ERROR,
+    FLASH_OPERATION_ERROR,
+    STOPWATCH_TIM_INIT_ERROR
   } App_ErrorsCode;   /* cppcheck-suppress misra-c2012-2.3 ; enum is used on functional safety */
 
   /**
-  * @brief   Structure for message that are recived by CAN to store time and date in stdlib tm format 
-  */
-  typedef struct _APP_TmTypeDef 
-  {
-    uint32_t tm_sec;         /*!< seconds,  range 0 to 59          */
-    uint32_t tm_min;         /*!< minutes, range 0 to 59           */
-    uint32_t tm_min_alarm;   /*!< minutes, range 0 to 59           */
-    uint32_t tm_hour;        /*!< hours, range 0 to 23             */
-    uint32_t tm_hour_alarm;        /*!< hours, range 0 to 23             */
-    uint32_t tm_mday;        /*!< day of the month, range 1 to 31  */
-    uint32_t tm_mon;         /*!< month, range 0 to 11             */
-    uint32_t tm_year_msb;    /*!< year most significant bits in range 1900 2100       */
-    uint32_t tm_year_lsb;    /*!< year least significant bits in range 1900 2100      */
-    uint32_t tm_wday;        /*!< day of the week, range 0 to 6    */
-    uint32_t tm_yday;        /*!< day in the year, range 0 to 365  */
-    uint32_t tm_isdst;       /*!< daylight saving time             */
-  }APP_TmTypeDef;
-
-  /**
-  * @brief   structure with APP_TmTypeDef and a message 
+  * @brief   structure with the time and a message, the time is kept as seconds since
+  *          2000-01-01 00:00:00 (see hil_time.h) so the message is only a few bytes
   */
   typedef struct _APP_MsgTypeDef
   {
-    uint8_t msg;          /*!< Store the message type to send */
-    APP_TmTypeDef tm;     /*!< time and date in stdlib tm format */
+    uint32_t time;            /*!< time and date in seconds since the epoch, a time message only uses the time of the day and a date message only the date */
+    uint8_t msg;              /*!< Store the message type to send */
     uint8_t S_alarm;
     uint8_t F_alarm;
+    uint8_t alarm_hour;       /*!< Hours of the alarm, range 0 to 23 */
+    uint8_t alarm_minute;     /*!< Minutes of the alarm, range 0 to 59 */
+    uint8_t alarm_slot;       /*!< Position of the alarm on the alarm table */
+    uint8_t alarm_days;       /*!< Days the alarm repeats, bit 0 monday to bit 6 sunday */
+    uint8_t alarm_snooze;     /*!< Snooze time in minutes */
+    uint8_t alarm_snooze_max; /*!< Max number of snoozes */
+    uint8_t alarm_enable;     /*!< TRUE to enable the alarm, FALSE to disable it */
+    int8_t  tz_offset;        /*!< Offset of the standard time from UTC in quarters of hour */
+    uint8_t tz_rule;          /*!< Daylight saving rule, see hil_tz.h */
   }APP_MsgTypeDef;
 
   /**
@@ -129,11 +153,6 @@
   */
   extern RTC_HandleTypeDef hrtc;
 
-  /**
-  * @brief  Variable for button state
-  */
-  extern uint8_t button;
-
   /**
   * @brief  Variable for DMA configuration
   */
@@ -143,6 +162,11 @@
   * @brief  Variable for ADC configuration
   */
   extern ADC_HandleTypeDef  AdcHandler;          /*adc handler estructure*/
+
+  /**
+  * @brief  Variable for the timer of the button
+  */
+  extern TIM_HandleTypeDef ButtonHandler;        /*button timer handler estructure*/
      
 #endif
 
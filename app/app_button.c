@@ -0,0 +1,345 @@
+/**
+* @file    app_button.c
+* @brief   **Debounce of the button and its gestures**
+*
+*   The first edge of the button masks its interrupt and starts TIM15 in one pulse mode,
+*   when the debounce time is over the pin is read and the interrupt is enabled again, so a
+*   bouncing button makes at most one interrupt per debounce time. A level different from
+*   the last one is a press or a release, the same timer then waits the long press or the
+*   double press time to tell the gestures apart. The events go to a queue and the deferred
+*   work given on Button_Init is posted, so they are used at task level right away.
+*/
+#include "app_button.h"
+#include "hil_queue.h"
+#include "scheduler.h"
+
+/**
+  * @defgroup Button_times times of the button in ms
+  @{ */
+#define BUTTON_TICK_HZ          1000u    /*!< Frequency of TIM15, 1 ms per tick*/
+#define BUTTON_DEBOUNCE_MS      20u      /*!< Time for the contacts to settle after the first edge*/
+#define BUTTON_LONG_MS          800u     /*!< Holding the button this time is a long press*/
+#define BUTTON_DOUBLE_MS        350u     /*!< Max time from a release to the next press of a double press*/
+/**
+  @} */
+
+/**
+  * @defgroup Button_gesture states of the decoder of the gestures
+  @{ */
+#define GESTURE_IDLE            0u       /*!< Button released*/
+#define GESTURE_DOWN            1u       /*!< First press, waiting for the release or the long press time*/
+#define GESTURE_LONG            2u       /*!< Long press done, waiting for the release*/
+#define GESTURE_UP              3u       /*!< Released after a short press, waiting for a second press*/
+#define GESTURE_SECOND          4u       /*!< Second press, the release is a double press*/
+/**
+  @} */
+
+/**
+  * @defgroup Button_queue events kept until the work runs
+  @{ */
+#define BUTTON_EVENTS           8u       /*!< Events of the queue, a press makes at most 3*/
+/**
+  @} */
+
+/**
+ * @brief  Variable for the timer of the debounce and the gestures
+ */
+TIM_HandleTypeDef ButtonHandler;
+
+/**
+ * @brief  Queue of the events of the button
+ */
+static QUEUE_HandleTypeDef BUTTON_queue;
+
+/**
+ * @brief  Deferred work posted with each event
+ */
+static uint8_t Button_Work;
+
+/**
+ * @brief  Debounce running, stable level of the button and time of the first edge
+ */
+static uint8_t Debouncing;
+static uint8_t Pressed;
+static uint32_t Edge_Tick;
+
+/**
+ * @brief  State of the decoder of the gestures and the time of its timeout
+ */
+static uint8_t Gesture;
+static uint32_t Deadline;
+
+static void Button_Edge( uint8_t pressed, uint32_t tick );
+static void Button_Timeout( void );
+static void Button_Arm( void );
+static void Button_Start( uint32_t time );
+static void Button_Event( uint8_t event, uint32_t tick );
+
+/**
+* @brief   **This function initializes the button**
+*
+*   The pin 7 of the gpio B is an input with interrupt on both edges, TIM15 counts at 1 kHz
+*   in one pulse mode with the update interrupt, both interrupts have the same priority so
+*   they never interrupt each other. The timer clock is twice the APB clock when the APB is
+*   divided.
+*   Prescaler = (timer clock / 1 kHz) - 1
+*
+* @param   work[in]  deferred work of the scheduler posted with each event
+*/
+void Button_Init( uint8_t work )
+{
+    static BUTTON_EventTypeDef button_queue_store[BUTTON_EVENTS];
+    GPIO_InitTypeDef GPIO_InitStruct;
+    uint32_t TimerClock = HAL_RCC_GetPCLK1Freq();
+
+    if( (RCC->CFGR & RCC_CFGR_PPRE) != RCC_HCLK_DIV1 )
+    {
+        TimerClock *= 2u;
+    }
+
+    BUTTON_queue.Buffer   = button_queue_store;
+    BUTTON_queue.Elements = BUTTON_EVENTS;
+    BUTTON_queue.size     = sizeof(BUTTON_EventTypeDef);
+    HIL_QUEUE_Init( &BUTTON_queue );
+
+    Button_Work = work;
+    Debouncing  = FALSE;
+    Pressed     = FALSE;
+    Gesture     = GESTURE_IDLE;
+
+    __HAL_RCC_TIM15_CLK_ENABLE();
+    ButtonHandler.Instance          = TIM15;
+    ButtonHandler.Init.Prescaler    = (TimerClock / BUTTON_TICK_HZ) - 1u;
+    ButtonHandler.Init.Period       = BUTTON_DEBOUNCE_MS;
+    ButtonHandler.Init.CounterMode  = TIM_COUNTERMODE_UP;
+    Status = HAL_TIM_OnePulse_Init( &ButtonHandler, TIM_OPMODE_SINGLE );
+    assert_error( Status == HAL_OK, BUTTON_TIM_INIT_ERROR );       /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+    __HAL_TIM_URS_ENABLE( &ButtonHandler );
+    __HAL_TIM_ENABLE_IT( &ButtonHandler, TIM_IT_UPDATE );
+    HAL_NVIC_SetPriority( TIM15_IRQn, 2, 0 );
+    HAL_NVIC_EnableIRQ( TIM15_IRQn );
+
+    __HAL_RCC_GPIOB_CLK_ENABLE();
+
+    GPIO_InitStruct.Pin = GPIO_PIN_7;                       /*pin to set as input*/
+    GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING_FALLING;     /*input on mode both edges interrupt*/
+    GPIO_InitStruct.Pull = GPIO_NOPULL;                     /*no pull-up niether pull-down*/
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;            /*pin speed*/
+    HAL_GPIO_Init( GPIOB, &GPIO_InitStruct );
+
+    HAL_NVIC_SetPriority( EXTI4_15_IRQn, 2, 0 );
+    HAL_NVIC_EnableIRQ( EXTI4_15_IRQn );
+}
+
+/**
+* @brief   **This function reads an event of the button**
+*
+*   The events are only written on the interrupt of TIM15, so only that interrupt is
+*   disabled while the queue is read.
+*
+* @param   event[out]  event read
+*
+* @retval  TRUE if an event was read, FALSE if there are no more
+*/
+uint8_t Button_GetEvent( BUTTON_EventTypeDef *event )
+{
+    uint8_t read = FALSE;
+
+    if( HIL_QUEUE_IsEmptyISR( &BUTTON_queue, TIM15_IRQn ) == NOT_EMPTY )
+    {
+        (void)HIL_QUEUE_ReadISR( &BUTTON_queue, event, TIM15_IRQn );
+        read = TRUE;
+    }
+
+    return read;
+}
+
+/**
+* @brief   **Interruption for the update event of TIM15**
+*
+*   At the end of a debounce the interrupt of the pin is enabled again before the pin is
+*   read, an edge after the read starts another debounce. Otherwise the time of a gesture
+*   is over. Then the timer waits the time left of the gesture, if there is one.
+*/
+void Button_TimerCallback( void )
+{
+    uint8_t pressed;
+
+    if( Debouncing == TRUE )
+    {
+        Debouncing = FALSE;
+        __HAL_GPIO_EXTI_CLEAR_RISING_IT( GPIO_PIN_7 );
+        __HAL_GPIO_EXTI_CLEAR_FALLING_IT( GPIO_PIN_7 );
+        SET_BIT( EXTI->IMR1, GPIO_PIN_7 );
+
+        pressed = (HAL_GPIO_ReadPin( GPIOB, GPIO_PIN_7 ) == GPIO_PIN_RESET) ? TRUE : FALSE;
+        if( pressed != Pressed )
+        {
+            Pressed = pressed;
+            Button_Edge( pressed, Edge_Tick );
+        }
+    }
+    else
+    {
+        Button_Timeout();
+    }
+
+    Button_Arm();
+}
+
+/**
+ * @brief   **Interruption for falling gpio pin 7 **
+ *
+ *  The first edge of a press masks the interrupt of the pin and starts the debounce,
+ *  the bounces that follow are not seen.
+ */
+ /* cppcheck-suppress misra-c2012-2.7 ; function cannot be modify is a library function */
+void HAL_GPIO_EXTI_Falling_Callback( uint16_t GPIO_Pin )    /* cppcheck-suppress misra-c2012-8.4 ; no need for a declaration since is a library function*/
+{
+    CLEAR_BIT( EXTI->IMR1, GPIO_PIN_7 );
+    Edge_Tick  = HAL_GetTick();
+    Debouncing = TRUE;
+    Button_Start( BUTTON_DEBOUNCE_MS );
+}
+
+/**
+ * @brief   **Interruption for rising gpio pin 7 **
+ *
+ *  The first edge of a release, the same as the press since the level is read
+ *  at the end of the debounce.
+ */
+ /* cppcheck-suppress misra-c2012-2.7 ; function cannot be modify is a library function */
+void HAL_GPIO_EXTI_Rising_Callback( uint16_t GPIO_Pin ) /* cppcheck-suppress misra-c2012-8.4 ; no need for a declaration since is a library function*/
+{
+    CLEAR_BIT( EXTI->IMR1, GPIO_PIN_7 );
+    Edge_Tick  = HAL_GetTick();
+    Debouncing = TRUE;
+    Button_Start( BUTTON_DEBOUNCE_MS );
+}
+
+/**
+* @brief   **This function runs a debounced edge on the decoder of the gestures**
+*
+*   A press waits the long press time and a release of a short press waits the double
+*   press time, both from the first edge.
+*
+* @param   pressed[in]  TRUE for a press, FALSE for a release
+* @param   tick[in]     time of the first edge in ms
+*/
+static void Button_Edge( uint8_t pressed, uint32_t tick )
+{
+    if( pressed == TRUE )
+    {
+        Button_Event( BUTTON_EVENT_PRESS, tick );
+        if( Gesture == GESTURE_UP )
+        {
+            Gesture = GESTURE_SECOND;
+        }
+        else
+        {
+            Gesture  = GESTURE_DOWN;
+            Deadline = tick + BUTTON_LONG_MS;
+        }
+    }
+    else
+    {
+        Button_Event( BUTTON_EVENT_RELEASE, tick );
+        if( Gesture == GESTURE_DOWN )
+        {
+            Gesture  = GESTURE_UP;
+            Deadline = tick + BUTTON_DOUBLE_MS;
+        }
+        else if( Gesture == GESTURE_SECOND )
+        {
+            Gesture = GESTURE_IDLE;
+            Button_Event( BUTTON_EVENT_DOUBLE, tick );
+        }
+        else
+        {
+            Gesture = GESTURE_IDLE;
+        }
+    }
+}
+
+/**
+* @brief   **This function ends the time of a gesture**
+*
+*   A press held until the deadline is a long press and a release without a second
+*   press is a short press.
+*/
+static void Button_Timeout( void )
+{
+    if( (int32_t)(HAL_GetTick() - Deadline) >= 0 )
+    {
+        if( Gesture == GESTURE_DOWN )
+        {
+            Gesture = GESTURE_LONG;
+            Button_Event( BUTTON_EVENT_LONG, Deadline );
+        }
+        else if( Gesture == GESTURE_UP )
+        {
+            Gesture = GESTURE_IDLE;
+            Button_Event( BUTTON_EVENT_SHORT, Deadline );
+        }
+        else
+        {
+            /*no gesture is waiting*/
+        }
+    }
+}
+
+/**
+* @brief   **This function starts the timer for the time left of a gesture**
+*
+*   A deadline already passed, the debounce can take longer than the time left, is run
+*   right away.
+*/
+static void Button_Arm( void )
+{
+    int32_t left;
+
+    if( (Gesture == GESTURE_DOWN) || (Gesture == GESTURE_UP) )
+    {
+        left = (int32_t)(Deadline - HAL_GetTick());
+        if( left > 0 )
+        {
+            Button_Start( (uint32_t)left );
+        }
+        else
+        {
+            Button_Timeout();
+        }
+    }
+}
+
+/**
+* @brief   **This function starts the timer**
+*
+*   The update event comes one tick after the counter reaches the auto reload.
+*
+* @param   time[in]  time to wait in ms
+*/
+static void Button_Start( uint32_t time )
+{
+    __HAL_TIM_DISABLE( &ButtonHandler );
+    __HAL_TIM_SET_AUTORELOAD( &ButtonHandler, time - 1u );
+    __HAL_TIM_SET_COUNTER( &ButtonHandler, 0u );
+    __HAL_TIM_CLEAR_FLAG( &ButtonHandler, TIM_FLAG_UPDATE );
+    __HAL_TIM_ENABLE( &ButtonHandler );
+}
+
+/**
+* @brief   **This function sends an event and posts the work that takes it**
+*
+* @param   event[in]  one of @ref Button_events
+* @param   tick[in]   time of the event in ms
+*/
+static void Button_Event( uint8_t event, uint32_t tick )
+{
+    BUTTON_EventTypeDef button_event;
+
+    button_event.tick  = tick;
+    button_event.event = event;
+    (void)HIL_QUEUE_Write( &BUTTON_queue, &button_event );
+    (void)HIL_SCHEDULER_PostWork( &sched, Button_Work );
+}
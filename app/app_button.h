@@ -0,0 +1,42 @@
+/**
+* @file    <app_button.h>
+* @brief   **Header file for app_button.c**
+*
+*   This file contains the declaration for the functions on the .c file
+*   and the events of the button.
+*   To use this aplication you need to first call the Button_Init function with the
+*   deferred work of the scheduler that takes the events, then that work reads them
+*   with Button_GetEvent.
+* @note    The events are made on the interrupt of TIM15, each one keeps the time of the
+*          first edge of the press or release in ms so its consumer knows how old it is
+*/
+#ifndef APP_BUTTON_H__
+#define APP_BUTTON_H__
+
+#include "app_bsp.h"
+
+/**
+  * @defgroup Button_events events of the button
+  @{ */
+#define BUTTON_EVENT_PRESS      1u   /*!< The button was pressed*/
+#define BUTTON_EVENT_RELEASE    2u   /*!< The button was released*/
+#define BUTTON_EVENT_SHORT      3u   /*!< Short press, released and not pressed again on the double press time*/
+#define BUTTON_EVENT_LONG       4u   /*!< Long press, sent while the button is still held*/
+#define BUTTON_EVENT_DOUBLE     5u   /*!< Double press, sent on the second release*/
+/**
+  @} */
+
+/**
+* @brief   Event of the button
+*/
+typedef struct _BUTTON_EventTypeDef
+{
+  uint32_t tick;      /*!< Time of the first edge of the press or release in ms, HAL_GetTick */
+  uint8_t  event;     /*!< Event, a value of @ref Button_events */
+} BUTTON_EventTypeDef;
+
+void Button_Init( uint8_t work );
+uint8_t Button_GetEvent( BUTTON_EventTypeDef *event );
+void Button_TimerCallback( void );
+
+#endif
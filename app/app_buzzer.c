@@ -0,0 +1,275 @@
+/**
+* @file    app_buzzer.c
+* @brief   **Melodies of the buzzer played by DMA**
+*
+*   TIM14 makes the tone on the buzzer with a fixed period of 100 counts, so its prescaler
+*   sets the frequency and its compare the duty cycle, that is the volume. TIM14 has no DMA
+*   requests, so TIM17 paces the melody in steps of 25 ms: its update request makes one DMA
+*   channel write the prescaler of the next step and its compare 1, one count later, makes a
+*   second channel write the compare. Both channels are circular over the steps of the melody
+*   so it repeats without the CPU, the notes are only turned into steps when it starts. The
+*   prescaler and the compare of TIM14 are preloaded so each step starts on a whole period of
+*   the tone.
+*/
+#include "app_buzzer.h"
+
+/**
+  * @defgroup Buzzer_tone values of the tone timer
+  @{ */
+#define BUZZER_PERIOD           100u     /*!< Counts of one period of the tone, the compare is the duty in percent*/
+#define BUZZER_DUTY_STEP        5u       /*!< Duty cycle in percent of one level of volume*/
+#define BUZZER_REST_PSC         0u       /*!< Prescaler of a rest, the compare is 0 so the pin stays low*/
+/**
+  @} */
+
+/**
+  * @defgroup Buzzer_steps values of the step timer
+  @{ */
+#define BUZZER_STEP_HZ          10000u   /*!< Frequency of TIM17, 0.1 ms per tick*/
+#define BUZZER_STEP_MS          25u      /*!< Length of one step of the melody*/
+#define BUZZER_TICKS_PER_MS     10u      /*!< Ticks of TIM17 in one ms*/
+#define BUZZER_COMPARE_TICK     1u       /*!< Tick of TIM17 of the compare request, after the update one*/
+#define BUZZER_STEPS            64u      /*!< Max steps of a melody, 1.6 seconds*/
+/**
+  @} */
+
+/**
+  * @defgroup Buzzer_melodies values of the melodies
+  @{ */
+#define BUZZER_MELODIES         8u       /*!< One melody for each slot of the alarm table*/
+#define BUZZER_NOTES            8u       /*!< Max notes of a melody, a 0 ms note ends it*/
+#define REST                    0u       /*!< Frequency of a silence*/
+/**
+  @} */
+
+/**
+ * @brief  Note of a melody
+ */
+typedef struct _BUZZER_NoteTypeDef
+{
+    uint16_t frequency;     /*!< Frequency in Hz, REST for a silence */
+    uint16_t duration;      /*!< Duration in ms, multiple of BUZZER_STEP_MS, 0 ends the melody */
+} BUZZER_NoteTypeDef;
+
+/**
+ * @brief  Melody of each alarm, a different one for each slot of the table
+ */
+static const BUZZER_NoteTypeDef Melodies[BUZZER_MELODIES][BUZZER_NOTES] =
+{
+    { { 2093u, 100u }, { REST, 100u }, { 2093u, 100u }, { REST, 100u }, { 2093u, 100u }, { REST, 500u }, { 0u, 0u } },
+    { { 1568u, 150u }, { 2093u, 150u }, { 2637u, 150u }, { 3136u, 300u }, { REST, 650u }, { 0u, 0u } },
+    { { 2637u, 200u }, { 2093u, 200u }, { 2637u, 200u }, { 2093u, 200u }, { REST, 600u }, { 0u, 0u } },
+    { { 3136u, 50u }, { REST, 50u }, { 3136u, 50u }, { REST, 50u }, { 3136u, 50u }, { REST, 50u }, { 3136u, 50u }, { REST, 650u } },
+    { { 2093u, 400u }, { REST, 200u }, { 1568u, 400u }, { REST, 600u }, { 0u, 0u } },
+    { { 1319u, 100u }, { 1568u, 100u }, { 2093u, 100u }, { 2637u, 100u }, { 2093u, 100u }, { 1568u, 100u }, { REST, 600u }, { 0u, 0u } },
+    { { 2794u, 250u }, { REST, 50u }, { 2794u, 250u }, { REST, 50u }, { 2349u, 500u }, { REST, 500u }, { 0u, 0u } },
+    { { 1047u, 200u }, { 2093u, 200u }, { 3136u, 200u }, { REST, 1000u }, { 0u, 0u } },
+};
+
+/**
+ * @brief  Variables for the tone and step timers and the two DMA channels
+ */
+static TIM_HandleTypeDef TimTone;
+static TIM_HandleTypeDef TimStep;
+static DMA_HandleTypeDef DmaPitch;
+static DMA_HandleTypeDef DmaDuty;
+
+/**
+ * @brief  Steps of the melody read by the DMA, prescaler and compare of TIM14
+ */
+static uint16_t Pitch[BUZZER_STEPS];
+static uint16_t Duty[BUZZER_STEPS];
+static uint16_t Steps;
+
+/**
+ * @brief  Clock of TIM14, to get the prescaler of each note
+ */
+static uint32_t ToneClock;
+
+static uint16_t Buzzer_Expand( const BUZZER_NoteTypeDef *melody, uint8_t volume );
+static void Buzzer_DmaInit( DMA_HandleTypeDef *hdma, DMA_Channel_TypeDef *channel, uint32_t request );
+
+/**
+* @brief   **Init function for the buzzer**
+*
+*   TIM14 is the PWM of the buzzer, its pin is configured on HAL_TIM_PWM_MspInit, with the
+*   compare on 0 it is quiet. TIM17 counts one step of the melody and its compare 1 is frozen,
+*   only its DMA request is used. DMA1 channels 4 and 5 are circular without interrupts.
+*   The timer clock is twice the APB clock when the APB is divided.
+*   Prescaler = (timer clock / 10 kHz) - 1
+*/
+void Buzzer_Init( void )
+{
+    TIM_OC_InitTypeDef sConfig;
+
+    ToneClock = HAL_RCC_GetPCLK1Freq();
+    if( (RCC->CFGR & RCC_CFGR_PPRE) != RCC_HCLK_DIV1 )
+    {
+        ToneClock *= 2u;
+    }
+
+    TimTone.Instance                = TIM14;
+    TimTone.Init.Prescaler          = BUZZER_REST_PSC;
+    TimTone.Init.Period             = BUZZER_PERIOD - 1u;
+    TimTone.Init.CounterMode        = TIM_COUNTERMODE_UP;
+    TimTone.Init.AutoReloadPreload  = TIM_AUTORELOAD_PRELOAD_ENABLE;
+    Status = HAL_TIM_PWM_Init( &TimTone );
+    assert_error( Status == HAL_OK, BUZZER_TIM_INIT_ERROR );   /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+
+    sConfig.OCMode     = TIM_OCMODE_PWM1;
+    sConfig.OCPolarity = TIM_OCPOLARITY_HIGH;
+    sConfig.OCFastMode = TIM_OCFAST_DISABLE;
+    sConfig.Pulse      = 0u;
+    Status = HAL_TIM_PWM_ConfigChannel( &TimTone, &sConfig, TIM_CHANNEL_1 );
+    assert_error( Status == HAL_OK, BUZZER_TIM_INIT_ERROR );   /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+    Status = HAL_TIM_PWM_Start( &TimTone, TIM_CHANNEL_1 );
+    assert_error( Status == HAL_OK, BUZZER_TIM_INIT_ERROR );   /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+
+    __HAL_RCC_TIM17_CLK_ENABLE();
+    TimStep.Instance            = TIM17;
+    TimStep.Init.Prescaler      = (ToneClock / BUZZER_STEP_HZ) - 1u;
+    TimStep.Init.Period         = (BUZZER_STEP_MS * BUZZER_TICKS_PER_MS) - 1u;
+    TimStep.Init.CounterMode    = TIM_COUNTERMODE_UP;
+    Status = HAL_TIM_Base_Init( &TimStep );
+    assert_error( Status == HAL_OK, BUZZER_TIM_INIT_ERROR );   /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+    __HAL_TIM_SET_COMPARE( &TimStep, TIM_CHANNEL_1, BUZZER_COMPARE_TICK );
+
+    __HAL_RCC_DMA1_CLK_ENABLE();
+    Buzzer_DmaInit( &DmaPitch, DMA1_Channel4, DMA_REQUEST_TIM17_UP );
+    Buzzer_DmaInit( &DmaDuty, DMA1_Channel5, DMA_REQUEST_TIM17_CH1 );
+    Steps = 0u;
+}
+
+/**
+* @brief   **This function plays the melody of an alarm**
+*
+*   The notes are turned into steps, then both DMA channels are started and an update event
+*   loads the first pitch before the step timer runs, from here the melody repeats by itself. A melody already playing is stopped.
+*
+* @param   slot[in]    slot of the alarm, each one has its own melody
+* @param   volume[in]  BUZZER_VOLUME_MIN to BUZZER_VOLUME_MAX
+*/
+void Buzzer_Play( uint8_t slot, uint8_t volume )
+{
+    Buzzer_Stop();
+
+    Steps = Buzzer_Expand( Melodies[(slot < BUZZER_MELODIES) ? slot : 0u], volume );
+    if( Steps > 0u )
+    {
+        Status = HAL_DMA_Start( &DmaPitch, (uint32_t)Pitch, (uint32_t)&TimTone.Instance->PSC, Steps );
+        assert_error( Status == HAL_OK, BUZZER_DMA_ERROR );    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+        Status = HAL_DMA_Start( &DmaDuty, (uint32_t)Duty, (uint32_t)&TimTone.Instance->CCR1, Steps );
+        assert_error( Status == HAL_OK, BUZZER_DMA_ERROR );    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+
+        __HAL_TIM_ENABLE_DMA( &TimStep, TIM_DMA_UPDATE | TIM_DMA_CC1 );
+        /* the update event clears the counter and writes the prescaler of the first step,
+           so the compare one count later writes the duty of the same step */
+        TimStep.Instance->EGR = TIM_EGR_UG;
+        __HAL_TIM_ENABLE( &TimStep );
+    }
+}
+
+/**
+* @brief   **This function changes the volume of the melody playing**
+*
+*   Only the compare of the notes is written, the DMA reads the new values from the next
+*   step, a step written while it is read takes the old or the new volume.
+*
+* @param   volume[in]  BUZZER_VOLUME_MIN to BUZZER_VOLUME_MAX
+*/
+void Buzzer_Volume( uint8_t volume )
+{
+    uint8_t level = (volume > BUZZER_VOLUME_MAX) ? BUZZER_VOLUME_MAX : volume;
+
+    for( uint16_t i = 0u; i < Steps; i++ )
+    {
+        if( Duty[i] != 0u )
+        {
+            Duty[i] = (uint16_t)level * BUZZER_DUTY_STEP;
+        }
+    }
+}
+
+/**
+* @brief   **This function stops the melody**
+*
+*   The step timer and the DMA channels are stopped and the compare of TIM14 goes to 0,
+*   the preload takes it on the end of the current period of the tone.
+*/
+void Buzzer_Stop( void )
+{
+    __HAL_TIM_DISABLE( &TimStep );
+    __HAL_TIM_DISABLE_DMA( &TimStep, TIM_DMA_UPDATE | TIM_DMA_CC1 );
+    (void)HAL_DMA_Abort( &DmaPitch );
+    (void)HAL_DMA_Abort( &DmaDuty );
+    __HAL_TIM_SET_COMPARE( &TimTone, TIM_CHANNEL_1, 0u );
+}
+
+/**
+* @brief   **This function turns the notes of a melody into steps**
+*
+*   Each note takes its duration in steps with the prescaler of its frequency and the
+*   compare of the volume, a rest has the compare on 0. The divisions are only done here,
+*   once for each note when the melody starts.
+*   Prescaler = (timer clock / (frequency * 100)) - 1
+*
+* @param   melody[in]  notes of the melody
+* @param   volume[in]  BUZZER_VOLUME_MIN to BUZZER_VOLUME_MAX
+*
+* @retval  number of steps, at most BUZZER_STEPS
+*/
+static uint16_t Buzzer_Expand( const BUZZER_NoteTypeDef *melody, uint8_t volume )
+{
+    uint8_t level = (volume > BUZZER_VOLUME_MAX) ? BUZZER_VOLUME_MAX : volume;
+    uint16_t steps = 0u;
+    uint16_t psc;
+    uint16_t duty;
+
+    for( uint8_t n = 0u; (n < BUZZER_NOTES) && (melody[n].duration != 0u); n++ )
+    {
+        if( melody[n].frequency == REST )
+        {
+            psc  = BUZZER_REST_PSC;
+            duty = 0u;
+        }
+        else
+        {
+            psc  = (uint16_t)((ToneClock / ((uint32_t)melody[n].frequency * BUZZER_PERIOD)) - 1u);
+            duty = (uint16_t)level * BUZZER_DUTY_STEP;
+        }
+
+        for( uint16_t ms = 0u; (ms < melody[n].duration) && (steps < BUZZER_STEPS); ms += BUZZER_STEP_MS )
+        {
+            Pitch[steps] = psc;
+            Duty[steps]  = duty;
+            steps++;
+        }
+    }
+
+    return steps;
+}
+
+/**
+* @brief   **This function configures a DMA channel that writes a register of TIM14**
+*
+*   Half words from memory to the register, the memory address increments and the
+*   channel starts again at the end of the steps.
+*
+* @param   hdma[in]     handle of the channel
+* @param   channel[in]  DMA1 channel
+* @param   request[in]  DMAMUX request of TIM17
+*/
+static void Buzzer_DmaInit( DMA_HandleTypeDef *hdma, DMA_Channel_TypeDef *channel, uint32_t request )
+{
+    hdma->Instance                  = channel;
+    hdma->Init.Request              = request;
+    hdma->Init.Direction            = DMA_MEMORY_TO_PERIPH;     /*steps to the register of TIM14*/
+    hdma->Init.PeriphInc            = DMA_PINC_DISABLE;         /*always the same register*/
+    hdma->Init.MemInc               = DMA_MINC_ENABLE;          /*next step*/
+    hdma->Init.PeriphDataAlignment  = DMA_PDATAALIGN_HALFWORD;  /*2 bytes transactions*/
+    hdma->Init.MemDataAlignment     = DMA_MDATAALIGN_HALFWORD;  /*2 bytes transactions*/
+    hdma->Init.Mode                 = DMA_CIRCULAR;             /*repeat the melody*/
+    hdma->Init.Priority             = DMA_PRIORITY_LOW;         /*one transfer every 25 ms*/
+    Status = HAL_DMA_Init( hdma );
+    assert_error( Status == HAL_OK, BUZZER_DMA_ERROR );        /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+}
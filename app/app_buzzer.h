@@ -0,0 +1,29 @@
+/**
+* @file    <app_buzzer.h>
+* @brief   **Header file for app_buzzer.c**
+*
+*   This file contains the declaration for the functions on the .c file
+*   and the volume levels of the buzzer.
+*   To use this aplication you need to first call the Buzzer_Init function and then
+*   you can play the melody of an alarm with Buzzer_Play and stop it with Buzzer_Stop.
+* @note    Once a melody starts it repeats by DMA without the CPU until it is stopped
+*/
+#ifndef APP_BUZZER_H__
+#define APP_BUZZER_H__
+
+#include "app_bsp.h"
+
+/**
+  * @defgroup Buzzer_volume volume levels, the duty cycle of the buzzer is 5% per level
+  @{ */
+#define BUZZER_VOLUME_MIN       1u   /*!< Lowest volume, 5% of duty cycle*/
+#define BUZZER_VOLUME_MAX       10u  /*!< Highest volume, 50% of duty cycle*/
+/**
+  @} */
+
+void Buzzer_Init( void );
+void Buzzer_Play( uint8_t slot, uint8_t volume );
+void Buzzer_Volume( uint8_t volume );
+void Buzzer_Stop( void );
+
+#endif
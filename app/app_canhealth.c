@@ -0,0 +1,363 @@
+/**
+* @file    app_canhealth.c
+* @brief   **CAN bus health monitor**
+*
+*   This file keeps track of the FDCAN error counters, the error warning, error passive
+*   and bus off transitions, the protocol status and an approximate bus load.
+*   When the node goes bus off it is restarted automatically after a back-off time
+*   that doubles on every consecutive bus off, so a noisy harness no longer sends
+*   the clock to the safe state.
+*/
+#include "app_canhealth.h"
+#include "app_log.h"
+#include <string.h>
+
+/**
+  * @defgroup CAN_backoff default back-off values in ms
+  @{ */
+#define CAN_HEALTH_MIN_BACKOFF      100u     /*!< Back-off applied on the first bus off*/
+#define CAN_HEALTH_MAX_BACKOFF      10000u   /*!< Max back-off after consecutive bus off events*/
+#define CAN_HEALTH_STABLE_TIME      10000u   /*!< Time error active needed to reset the back-off*/
+/**
+  @} */
+
+/**
+  * @defgroup CAN_load values for the bus load calculation
+  @{ */
+#define CAN_HEALTH_LOAD_WINDOW      1000u    /*!< Window in ms to calculate the bus load*/
+#define CAN_FRAME_BITS              108u     /*!< Bits of a classic frame with 8 bytes of data*/
+#define CAN_BITRATE_KBPS            100u     /*!< Nominal bitrate configured on Serial_Init*/
+#define CAN_MAX_LOAD                100u     /*!< Max value of the bus load in percent*/
+/**
+  @} */
+
+/**
+  * @defgroup CAN_faults errors that are not caused by the bus and need the safe state
+  @{ */
+#define CAN_HEALTH_FAULTS   (HAL_FDCAN_ERROR_RAM_ACCESS | HAL_FDCAN_ERROR_RAM_WDG | HAL_FDCAN_ERROR_RESERVED_AREA)    /*!< Message RAM faults*/
+/**
+  @} */
+
+/**
+* @brief  Variable with the bus statistics shared by the task and the FDCAN interrupt
+*/
+static CAN_HealthTypeDef CanHealth;
+
+/**
+* @brief  Back-off limits configured by the application
+*/
+static uint32_t MinBackoff = CAN_HEALTH_MIN_BACKOFF;
+static uint32_t MaxBackoff = CAN_HEALTH_MAX_BACKOFF;
+
+/**
+* @brief  Tick values of the last events
+*/
+static uint32_t BusOffTick;
+static uint32_t StableTick;
+static uint32_t LoadTick;
+
+/**
+* @brief  Frames seen on the current bus load window
+*/
+static uint32_t LoadFrames;
+
+/**
+* @brief  State written on the event log the last time it changed
+*/
+static uint8_t LoggedState;
+
+static void CanHealth_BusOff( void );
+static void CanHealth_Recovery( uint32_t tick, uint32_t bus_off );
+
+/**
+* @brief   **Init function for the CAN health monitor**
+*
+*   This function clears the statistics and activates the error status notifications
+*   of the FDCAN, error warning, error passive and bus off will call the
+*   HAL_FDCAN_ErrorStatusCallback, message RAM faults are still reported through
+*   HAL_FDCAN_ErrorCallback. Protocol errors are not activated as interrupts, they
+*   are read from the error logging counter on the task, so a noisy bus cannot
+*   flood the cpu with interruptions.
+*
+*   @note   Serial_Init has to be called first since it starts the FDCAN
+*/
+void CanHealth_Init( void )
+{
+    (void)memset( &CanHealth, 0, sizeof(CanHealth) );
+    CanHealth.state   = CAN_HEALTH_ACTIVE;
+    CanHealth.backoff = MinBackoff;
+    LoadTick   = HAL_GetTick();
+    StableTick = LoadTick;
+    LoadFrames = 0u;
+    LoggedState = CAN_HEALTH_ACTIVE;
+
+    Status = HAL_FDCAN_ActivateNotification( &CANHandler, FDCAN_IT_BUS_OFF | FDCAN_IT_ERROR_PASSIVE | FDCAN_IT_ERROR_WARNING |
+                                             FDCAN_IT_RAM_ACCESS_FAILURE | FDCAN_IT_RESERVED_ADDRESS_ACCESS, 0 );
+    assert_error( Status == HAL_OK, FDCAN_ACTIVATE_NOTIFICATION_ERROR );    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+}
+
+/**
+* @brief   **CAN health task**
+*
+*   The task reads the protocol status and the error counters of the controller,
+*   updates the node state and the protocol error count, runs the bus off recovery
+*   and every CAN_HEALTH_LOAD_WINDOW calculates the bus load with:
+*   load = ( frames * CAN_FRAME_BITS * 100 ) / ( CAN_BITRATE_KBPS * window_ms )
+*   stuff bits are not considered so the value is an approximation.
+*   Every change of the state is written on the event log with the error counters.
+*/
+void CanHealth_Task( void )
+{
+    FDCAN_ProtocolStatusTypeDef protocol;
+    FDCAN_ErrorCountersTypeDef counters;
+    uint32_t tick = HAL_GetTick();
+    uint32_t load;
+
+    Status = HAL_FDCAN_GetProtocolStatus( &CANHandler, &protocol );
+    assert_error( Status == HAL_OK, FDCAN_PROTOCOL_STATUS_ERROR );  /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+    Status = HAL_FDCAN_GetErrorCounters( &CANHandler, &counters );
+    assert_error( Status == HAL_OK, FDCAN_PROTOCOL_STATUS_ERROR );  /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+
+    HAL_NVIC_DisableIRQ( TIM16_FDCAN_IT0_IRQn );
+
+    CanHealth.tec      = (uint8_t)counters.TxErrorCnt;
+    CanHealth.rec      = (uint8_t)counters.RxErrorCnt;
+    CanHealth.activity = (uint8_t)protocol.Activity;
+    if( protocol.LastErrorCode != FDCAN_PROTOCOL_ERROR_NO_CHANGE )
+    {
+        CanHealth.last_error = (uint8_t)protocol.LastErrorCode;
+    }
+    /*the error logging counter is reset on every read*/
+    CanHealth.protocol_errors += counters.ErrorLogging;
+
+    if( (protocol.BusOff == 1u) && (CanHealth.state < CAN_HEALTH_BUS_OFF) )
+    {
+        /*the bus off interrupt was missed, handle it the same way*/
+        CanHealth_BusOff();
+    }
+    CanHealth_Recovery( tick, protocol.BusOff );
+
+    if( CanHealth.state < CAN_HEALTH_BUS_OFF )
+    {
+        if( protocol.ErrorPassive == 1u )
+        {
+            CanHealth.state = CAN_HEALTH_PASSIVE;
+        }
+        else if( protocol.Warning == 1u )
+        {
+            CanHealth.state = CAN_HEALTH_WARNING;
+        }
+        else
+        {
+            CanHealth.state = CAN_HEALTH_ACTIVE;
+        }
+    }
+
+    if( CanHealth.state != CAN_HEALTH_ACTIVE )
+    {
+        StableTick = tick;
+    }
+    else if( (tick - StableTick) >= CAN_HEALTH_STABLE_TIME )
+    {
+        /*the harness looks good again, next bus off will use the shortest back-off*/
+        CanHealth.backoff = MinBackoff;
+    }
+    else{}
+
+    if( (tick - LoadTick) >= CAN_HEALTH_LOAD_WINDOW )
+    {
+        load = ( LoadFrames * CAN_FRAME_BITS * CAN_MAX_LOAD ) / ( CAN_BITRATE_KBPS * (tick - LoadTick) );
+        CanHealth.bus_load = (load > CAN_MAX_LOAD) ? (uint8_t)CAN_MAX_LOAD : (uint8_t)load;
+        LoadFrames = 0u;
+        LoadTick   = tick;
+    }
+
+    HAL_NVIC_EnableIRQ( TIM16_FDCAN_IT0_IRQn );
+
+    if( CanHealth.state != LoggedState )
+    {
+        LoggedState = CanHealth.state;
+        Log_Event( LOG_EVENT_CAN_STATE, LoggedState, CanHealth.tec, CanHealth.rec );
+    }
+}
+
+/**
+* @brief   **Registers a bus off event**
+*
+*   The function changes the state to bus off, counts the event and stores the tick
+*   so the task can wait the back-off time before restarting the controller.
+*/
+static void CanHealth_BusOff( void )
+{
+    CanHealth.state = CAN_HEALTH_BUS_OFF;
+    CanHealth.busoff_count++;
+    BusOffTick = HAL_GetTick();
+}
+
+/**
+* @brief   **Bus off recovery**
+*
+*   When the node is bus off and the back-off time has elapsed the FDCAN is stopped
+*   and started again, this clears the INIT bit set by the hardware on bus off and
+*   the controller waits for 129 occurrences of 11 recessive bits before it joins the bus.
+*   Once the controller reports it is no longer bus off the node is back to error active,
+*   the back-off is doubled up to the max value in case the bus keeps failing.
+*
+* @param   tick[in]      current tick value
+* @param   bus_off[in]   bus off flag read from the protocol status
+*/
+static void CanHealth_Recovery( uint32_t tick, uint32_t bus_off )
+{
+    if( (CanHealth.state == CAN_HEALTH_BUS_OFF) && ((tick - BusOffTick) >= CanHealth.backoff) )
+    {
+        Status = HAL_FDCAN_Stop( &CANHandler );
+        assert_error( Status == HAL_OK, FDCAN_RECOVERY_ERROR );     /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+        Status = HAL_FDCAN_Start( &CANHandler );
+        assert_error( Status == HAL_OK, FDCAN_RECOVERY_ERROR );     /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+        CanHealth.state = CAN_HEALTH_RECOVERING;
+    }
+    else if( (CanHealth.state == CAN_HEALTH_RECOVERING) && (bus_off == 0u) )
+    {
+        CanHealth.state = CAN_HEALTH_ACTIVE;
+        CanHealth.recovery_count++;
+        CanHealth.backoff = ( (CanHealth.backoff * 2u) > MaxBackoff ) ? MaxBackoff : (CanHealth.backoff * 2u);
+        StableTick = tick;
+    }
+    else{}
+}
+
+/**
+* @brief   **Gets a copy of the CAN health statistics**
+*
+* @param   stats[out] Pointer to the structure where the statistics are copied
+*/
+void CanHealth_GetStats( CAN_HealthTypeDef *stats )
+{
+    HAL_NVIC_DisableIRQ( TIM16_FDCAN_IT0_IRQn );
+    *stats = CanHealth;
+    HAL_NVIC_EnableIRQ( TIM16_FDCAN_IT0_IRQn );
+}
+
+/**
+* @brief   **Configures the bus off back-off times**
+*
+*   The first bus off waits min_backoff before restarting the controller, every
+*   consecutive bus off doubles the time until max_backoff is reached.
+*
+* @param   min_backoff[in]   Back-off in ms for the first bus off
+* @param   max_backoff[in]   Max back-off in ms
+*/
+void CanHealth_SetBackoff( uint32_t min_backoff, uint32_t max_backoff )
+{
+    if( (min_backoff > 0u) && (max_backoff >= min_backoff) )
+    {
+        HAL_NVIC_DisableIRQ( TIM16_FDCAN_IT0_IRQn );
+        MinBackoff = min_backoff;
+        MaxBackoff = max_backoff;
+        CanHealth.backoff = min_backoff;
+        HAL_NVIC_EnableIRQ( TIM16_FDCAN_IT0_IRQn );
+    }
+}
+
+/**
+* @brief   **Tells if frames can be transmited**
+*
+* @retval  TRUE if the node is not bus off or recovering, otherwise FALSE
+*/
+uint8_t CanHealth_IsBusOn( void )
+{
+    return ( CanHealth.state < CAN_HEALTH_BUS_OFF ) ? TRUE : FALSE;
+}
+
+/**
+* @brief   **Counts a received frame for the statistics and the bus load**
+*/
+void CanHealth_FrameRx( void )
+{
+    CanHealth.rx_frames++;
+    LoadFrames++;
+}
+
+/**
+* @brief   **Counts a transmited frame for the statistics and the bus load**
+*/
+void CanHealth_FrameTx( void )
+{
+    HAL_NVIC_DisableIRQ( TIM16_FDCAN_IT0_IRQn );
+    CanHealth.tx_frames++;
+    LoadFrames++;
+    HAL_NVIC_EnableIRQ( TIM16_FDCAN_IT0_IRQn );
+}
+
+/**
+* @brief   **Counts a frame that could not be transmited**
+*/
+void CanHealth_FrameDropped( void )
+{
+    HAL_NVIC_DisableIRQ( TIM16_FDCAN_IT0_IRQn );
+    CanHealth.tx_dropped++;
+    HAL_NVIC_EnableIRQ( TIM16_FDCAN_IT0_IRQn );
+}
+
+/**
+* @brief   **Interruption for the FDCAN error status**
+*
+*  This function is called when the controller changes its error warning, error passive
+*  or bus off status, each transition into one of these states is counted, the bus off
+*  also starts the back-off time.
+*
+* @param   hfdcan[in]          structure of CAN.
+* @param   ErrorStatusITs[in]  error status interrupts that were triggered
+*/
+/* cppcheck-suppress misra-c2012-8.4 ; this is a library function */
+void HAL_FDCAN_ErrorStatusCallback( FDCAN_HandleTypeDef *hfdcan, uint32_t ErrorStatusITs )
+{
+    FDCAN_ProtocolStatusTypeDef protocol;
+
+    (void)HAL_FDCAN_GetProtocolStatus( hfdcan, &protocol );
+    if( protocol.LastErrorCode != FDCAN_PROTOCOL_ERROR_NO_CHANGE )
+    {
+        CanHealth.last_error = (uint8_t)protocol.LastErrorCode;
+    }
+
+    if( ((ErrorStatusITs & FDCAN_IT_BUS_OFF) != 0u) && (protocol.BusOff == 1u) )
+    {
+        if( CanHealth.state < CAN_HEALTH_BUS_OFF )
+        {
+            CanHealth_BusOff();
+        }
+    }
+    else if( ((ErrorStatusITs & FDCAN_IT_ERROR_PASSIVE) != 0u) && (protocol.ErrorPassive == 1u) )
+    {
+        CanHealth.passive_count++;
+    }
+    else if( ((ErrorStatusITs & FDCAN_IT_ERROR_WARNING) != 0u) && (protocol.Warning == 1u) )
+    {
+        CanHealth.warning_count++;
+    }
+    else{}
+}
+
+/**
+* @brief   **Interruption for the FDCAN errors**
+*
+*  Message RAM faults are not caused by the bus, those still send the program to the
+*  safe state, any other error only clears the error code so the callback is not called
+*  again on every interruption.
+*
+* @param   hfdcan[in] structure of CAN.
+*/
+/* cppcheck-suppress misra-c2012-8.4 ; this function can`t be modify */
+void HAL_FDCAN_ErrorCallback( FDCAN_HandleTypeDef *hfdcan )
+{
+    if( (hfdcan->ErrorCode & CAN_HEALTH_FAULTS) != 0u )
+    {
+        Status = HAL_ERROR;
+        assert_error( Status == HAL_OK, FDCAN_CALLBACK_ERROR ); /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+    }
+    if( (hfdcan->ErrorCode & HAL_FDCAN_ERROR_FIFO_FULL) != 0u )
+    {
+        CanHealth.tx_dropped++;
+    }
+    hfdcan->ErrorCode = HAL_FDCAN_ERROR_NONE;
+}
@@ -0,0 +1,59 @@
+/**
+* @file    <app_canhealth.h>
+* @brief   **Header file for app_canhealth.c**
+*
+*   This file contains the declaration for the functions on the .c file
+*   and the structure used to report the health of the CAN bus.
+*   To use this aplication you need to first call the Serial_Init function,
+*   then CanHealth_Init and then you can call the CanHealth_Task function.
+* @note    The stats are updated from the FDCAN interrupt and the task, always
+*          read them with CanHealth_GetStats
+*/
+#ifndef APP_CANHEALTH_H__
+#define APP_CANHEALTH_H__
+
+#include "app_bsp.h"
+
+/**
+  * @defgroup CAN_health node states reported by the health monitor
+  @{ */
+#define CAN_HEALTH_ACTIVE       0u   /*!< Node is error active, counters below 96*/
+#define CAN_HEALTH_WARNING      1u   /*!< At least one error counter reached 96*/
+#define CAN_HEALTH_PASSIVE      2u   /*!< At least one error counter reached 128*/
+#define CAN_HEALTH_BUS_OFF      3u   /*!< Transmit error counter went above 255*/
+#define CAN_HEALTH_RECOVERING   4u   /*!< Node is waiting for 129 x 11 recessive bits*/
+/**
+  @} */
+
+/**
+* @brief   Structure with the CAN bus health statistics
+*/
+typedef struct _CAN_HealthTypeDef
+{
+  uint8_t  state;             /*!< Current node state, a value of @ref CAN_health */
+  uint8_t  tec;               /*!< Transmit error counter, range 0 to 255 */
+  uint8_t  rec;               /*!< Receive error counter, range 0 to 127 */
+  uint8_t  last_error;        /*!< Last protocol error code (LEC) read from the controller */
+  uint8_t  activity;          /*!< Communication state (sync, idle, rx, tx) read from the controller */
+  uint8_t  bus_load;          /*!< Approximate bus load on the last window in percent */
+  uint32_t warning_count;     /*!< Number of transitions into error warning */
+  uint32_t passive_count;     /*!< Number of transitions into error passive */
+  uint32_t busoff_count;      /*!< Number of transitions into bus off */
+  uint32_t recovery_count;    /*!< Number of recoveries from bus off */
+  uint32_t protocol_errors;   /*!< Protocol errors reported on the arbitration phase */
+  uint32_t rx_frames;         /*!< Total of frames received */
+  uint32_t tx_frames;         /*!< Total of frames queued for transmition */
+  uint32_t tx_dropped;        /*!< Frames not sent because the bus was off or the fifo was full */
+  uint32_t backoff;           /*!< Back-off time in ms that will be applied on the next bus off */
+} CAN_HealthTypeDef;
+
+void CanHealth_Init( void );
+void CanHealth_Task( void );
+void CanHealth_GetStats( CAN_HealthTypeDef *stats );
+void CanHealth_SetBackoff( uint32_t min_backoff, uint32_t max_backoff );
+uint8_t CanHealth_IsBusOn( void );
+void CanHealth_FrameRx( void );
+void CanHealth_FrameTx( void );
+void CanHealth_FrameDropped( void );
+
+#endif
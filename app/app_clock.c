@@ -1,5 +1,11 @@
 #include "app_clock.h"
 #include "hil_queue.h"
+#include "app_alarms.h"
+#include "hil_time.h"
+#include "hil_tz.h"
+#include "app_rtccal.h"
+#include "app_config.h"
+#include "app_log.h"
 
 /**
  * @brief CLock State machine states.
@@ -18,7 +24,10 @@ typedef enum
     CLOCK_ST_DISPLAY,
     CLOCK_ST_CHECK_ALARM,
     CLOCK_ST_CHECK_FLAG,
-    CLOCK_ST_FLAG_OFF
+    CLOCK_ST_FLAG_OFF,
+    CLOCK_ST_SNOOZE,
+    CLOCK_ST_CHANGE_TZ,
+    CLOCK_ST_ENABLE_ALARM
 } CLOCK_STATES;
 
 /** 
@@ -28,6 +37,30 @@ typedef enum
 /**
   @} */
 
+/** 
+  * @defgroup RTC wakeup values, the wakeup timer is clocked by the 1 Hz used by the seconds.
+  @{ */
+#define WAKEUP_EVERY_SECOND     0u    /*!< Reload of the wakeup timer, one event every ck_spre pulse*/
+#define RTC_IRQ_PRIORITY        2u    /*!< Priority of the RTC interrupt, same as the other peripherals*/
+/**
+  @} */
+
+/** 
+  * @defgroup RTC sub-second values, ck_spre = 32768 / ((ASYNC + 1) * (SYNC + 1)) = 1 Hz.
+  @{ */
+#define CLOCK_ASYNCH_PREDIV     0x7Fu /*!< Asynchronous prescaler, 256 Hz for the sub-second counter*/
+#define CLOCK_SYNCH_PREDIV      0xFFu /*!< Synchronous prescaler, the sub-second counter goes from 255 to 0*/
+#define CLOCK_SUBSECOND_SHIFT   8u    /*!< Shift from 1/256 s of the counter to 1/65536 s of the stamp*/
+/**
+  @} */
+
+/** 
+  * @defgroup Time zone values.
+  @{ */
+#define TZ_QUARTER_MINUTES      15    /*!< The offset is recived in quarters of hour*/
+/**
+  @} */
+
 /**
 * @brief  Variable for rtc configuration
 */
@@ -47,6 +80,41 @@ static RTC_TimeTypeDef sTime;
  */
 static RTC_AlarmTypeDef sAlarm;
 
+/**
+ * @brief  Variable for the snooze alarm configuration
+ */
+static RTC_AlarmTypeDef sAlarmB;
+
+/**
+ * @brief  Slot of the alarm programmed on the alarm A and slot of the alarm that is ringing
+ */
+static uint8_t Scheduled_Slot;
+static uint8_t Ringing_Slot;
+
+/**
+ * @brief  Number of snoozes of the ringing alarm and flag for a snooze programmed on alarm B
+ */
+static uint8_t Snooze_Count;
+static uint8_t Snooze_Pending = FALSE;
+
+/**
+ * @brief  Variable for the time zone and the daylight saving transitions
+ */
+static TZ_HandleTypeDef TimeZone;
+
+/**
+ * @brief  Snapshot of the time refreshed on every second of the RTC and its sequence,
+ *  the sequence is odd while the snapshot is being written
+ */
+static volatile HIL_TIME_EpochTypeDef Snapshot_Time;
+static volatile HIL_TIME_BcdTypeDef Snapshot_Bcd;
+static volatile uint32_t Snapshot_Sequence;
+
+/**
+ * @brief  Sequence of the last snapshot sent to the display
+ */
+static uint32_t Displayed_Sequence;
+
 /**
  * @brief  Variable for Alarm state
  */
@@ -68,6 +136,12 @@ static APP_MsgTypeDef CAN_to_clock_message;
 QUEUE_HandleTypeDef CLOCK_queue;
 
 static void Clock_StMachine(uint8_t state);
+static void Clock_ScheduleAlarm(void);
+static void Clock_Snooze(void);
+static HIL_TIME_EpochTypeDef Clock_ReadRtc(void);
+static void Clock_UpdateSnapshot(void);
+static void Clock_TzSync(void);
+static uint8_t Clock_TzCheck(HIL_TIME_EpochTypeDef wall);
 
 /**
  * @brief   **This function intiates the RTC**
@@ -76,7 +150,9 @@ static void Clock_StMachine(uint8_t state);
  *  format for the clock, the asynchronous prescaler value of 0x7F and the synchronous prescaler value of 0xFF.
  *  The asynchronous and synchronous prescalers divide the input clock to get a frequency of 1hz. 
  *  Then we call the function to initiate the RTC with this parameters. 
- *  Then we set the parameters to set the time to 2:00:00 and date to Monday, April 17, 2023
+ *  If the backup registers say the RTC kept running the time is not changed, otherwise
+ *  we set the parameters to set the time to 2:20:55 and date to Monday, April 11, 2022.
+ *  The alarms and the time zone are taken from the configuration stored on flash.
  *  For the size of the buffer we will take the max amount of msgs that the serial
  *  task can send in 50ms.
  *  the serial task has a max of 10 transmitions per 10 ms, making the conversion 
@@ -90,45 +166,77 @@ void Clock_Init( void )
     /*declare as global variable or static*/
     hrtc.Instance             = RTC;
     hrtc.Init.HourFormat      = RTC_HOURFORMAT_24;
-    hrtc.Init.AsynchPrediv    = 0x7F;
-    hrtc.Init.SynchPrediv     = 0xFF;
+    hrtc.Init.AsynchPrediv    = CLOCK_ASYNCH_PREDIV;
+    hrtc.Init.SynchPrediv     = CLOCK_SYNCH_PREDIV;
     hrtc.Init.OutPut          = RTC_OUTPUT_DISABLE;
     /* initilize the RTC with 24 hour format and no output signal enble */
     Status = HAL_RTC_Init( &hrtc );
     assert_error( Status == HAL_OK, RTC_INIT_ERROR );   /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
 
-    sTime.Hours      = 0x02;
-    sTime.Minutes    = 0x20;
-    sTime.Seconds    = 0x55;
-    sTime.SubSeconds = 0x00;
-    sTime.DayLightSaving = RTC_DAYLIGHTSAVING_NONE;
-    sTime.StoreOperation = RTC_STOREOPERATION_RESET;
-    
-    Status = HAL_RTC_SetTime( &hrtc, &sTime, RTC_FORMAT_BCD );
-    assert_error( Status == HAL_OK, RTC_SETTIME_ERROR );    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-    
-    sDate.WeekDay = RTC_WEEKDAY_MONDAY;
-    sDate.Month   = RTC_MONTH_APRIL;
-    sDate.Date    = 0x11;
-    sDate.Year    = 0x22;
-    
-    Status = HAL_RTC_SetDate( &hrtc, &sDate, RTC_FORMAT_BCD );
-    assert_error( Status == HAL_OK, RTC_SETDATE_ERROR );    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+    /*the backup domain survives the reset, the RTC is only set when it lost the power*/
+    if( Config_IsTimeValid() == FALSE )
+    {
+        sTime.Hours      = 0x02;
+        sTime.Minutes    = 0x20;
+        sTime.Seconds    = 0x55;
+        sTime.SubSeconds = 0x00;
+        sTime.DayLightSaving = RTC_DAYLIGHTSAVING_NONE;
+        sTime.StoreOperation = RTC_STOREOPERATION_RESET;
+        
+        Status = HAL_RTC_SetTime( &hrtc, &sTime, RTC_FORMAT_BCD );
+        assert_error( Status == HAL_OK, RTC_SETTIME_ERROR );    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+        
+        sDate.WeekDay = RTC_WEEKDAY_MONDAY;
+        sDate.Month   = RTC_MONTH_APRIL;
+        sDate.Date    = 0x11;
+        sDate.Year    = 0x22;
+        
+        Status = HAL_RTC_SetDate( &hrtc, &sDate, RTC_FORMAT_BCD );
+        assert_error( Status == HAL_OK, RTC_SETDATE_ERROR );    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+        Config_SetTimeValid();
+    }
+
+    /*the wakeup timer refreshes the time snapshot every time the seconds of the RTC change*/
+    Snapshot_Sequence  = 0u;
+    Displayed_Sequence = 0u;
+    Clock_UpdateSnapshot();
+    Status = HAL_RTCEx_SetWakeUpTimer_IT( &hrtc, WAKEUP_EVERY_SECOND, RTC_WAKEUPCLOCK_CK_SPRE_16BITS );
+    assert_error( Status == HAL_OK, RTC_SET_WAKEUP_ERROR ); /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+    HAL_NVIC_SetPriority( RTC_TAMP_IRQn, RTC_IRQ_PRIORITY, 0 );
+    HAL_NVIC_EnableIRQ( RTC_TAMP_IRQn );
     
+    /*alarm A rings on the next alarm of the table, it matches weekday, hour and minutes*/
     sAlarm.AlarmTime.Hours          = FALSE;
     sAlarm.AlarmTime.Minutes        = FALSE;
     sAlarm.AlarmTime.Seconds        = FALSE;
     sAlarm.AlarmTime.SubSeconds     = FALSE;
     sAlarm.AlarmTime.DayLightSaving = RTC_DAYLIGHTSAVING_NONE;
     sAlarm.AlarmTime.StoreOperation = RTC_STOREOPERATION_RESET;
-    sAlarm.AlarmMask                = RTC_ALARMMASK_DATEWEEKDAY;;
-    sAlarm.AlarmDateWeekDaySel      = RTC_ALARMDATEWEEKDAYSEL_DATE;
+    sAlarm.AlarmMask                = RTC_ALARMMASK_NONE;
+    sAlarm.AlarmDateWeekDaySel      = RTC_ALARMDATEWEEKDAYSEL_WEEKDAY;
     sAlarm.AlarmDateWeekDay         = RTC_WEEKDAY_MONDAY;
     sAlarm.Alarm                    = RTC_ALARM_A;        
-    
+
+    /*alarm B is used for the snooze, the day is not needed since it is always less than one hour*/
+    sAlarmB = sAlarm;
+    sAlarmB.AlarmMask               = RTC_ALARMMASK_DATEWEEKDAY;
+    sAlarmB.Alarm                   = RTC_ALARM_B;
     
     Status = HAL_RTC_DeactivateAlarm(&hrtc, RTC_ALARM_A);
     assert_error( Status == HAL_OK, RTC_SDESACTIVATE_ALARM_ERROR ); /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+    Status = HAL_RTC_DeactivateAlarm(&hrtc, RTC_ALARM_B);
+    assert_error( Status == HAL_OK, RTC_SDESACTIVATE_ALARM_ERROR ); /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+    Alarms_Init();
+    for( uint8_t slot = 0u; slot < ALARMS_NUMBER; slot++ )
+    {
+        (void)Alarms_Set( slot, &Config_Get()->alarms[slot] );
+    }
+    Snooze_Pending = FALSE;
+
+    /*UTC with no daylight saving until a time zone message is recived*/
+    TimeZone.Offset = Config_Get()->tz_offset;
+    TimeZone.Rule   = Config_Get()->tz_rule;
+    Clock_TzSync();
     
     /*Clock to display buffer*/
     static APP_MsgTypeDef clock_queue_store[CLOCK_DATA_PER50MS];
@@ -138,6 +246,7 @@ void Clock_Init( void )
     HIL_QUEUE_Init(&CLOCK_queue);
 
     Alarm_State = ALARM_OFF;
+    Clock_ScheduleAlarm();
 }
 
 /**
@@ -150,15 +259,24 @@ void Clock_Init( void )
 *   will be using the HIL_QUEUE_IsEmpty to see if the circular buffer has any message and if it does
 *   then it will read the message and call the function Clock_StMachine with the value
 *   CAN_to_clock_message.msg wich is the action to be taken.      
+*   The display is updated each time the RTC refreshes the time snapshot, so the seconds
+*   shown follow the RTC and never skip or repeat.
 *
 */
 void Clock_Task( void )
 {    
+    HIL_TIME_EpochTypeDef now;
+
+    if( Clock_GetTime( &now ) != Displayed_Sequence )
+    {
+        Display_msg();
+    }
+
     while( HIL_QUEUE_IsEmptyISR( &SERIAL_queue, RTC_TAMP_IRQn ) == NOT_EMPTY )
     {
         /*Read the first message*/
         (void)HIL_QUEUE_ReadISR( &SERIAL_queue, &CAN_to_clock_message, RTC_TAMP_IRQn);
-        if ((Alarm_State != ALARM_ACTIVE) || (CAN_to_clock_message.msg == (uint8_t)CLOCK_ST_FLAG_OFF))
+        if ((Alarm_State != ALARM_ACTIVE) || (CAN_to_clock_message.msg == (uint8_t)CLOCK_ST_FLAG_OFF) || (CAN_to_clock_message.msg == (uint8_t)CLOCK_ST_SNOOZE))
         {
             Clock_StMachine(CAN_to_clock_message.msg);
         }
@@ -181,20 +299,36 @@ void Clock_Task( void )
 */
 static void Clock_StMachine(uint8_t Clockstate)
 {
-   
+    APP_AlarmTypeDef NewAlarm;
+    HIL_TIME_TmTypeDef NewTime;
+    HIL_TIME_EpochTypeDef RtcTime;
+    HIL_TIME_EpochTypeDef RealTime;
+    int32_t Delta;
+
     switch(Clockstate)
     {   
         case CLOCK_ST_CHANGE_TIME:
         
-            sTime.Hours          = CAN_to_clock_message.tm.tm_hour;
-            sTime.Minutes        = CAN_to_clock_message.tm.tm_min;
-            sTime.Seconds        = CAN_to_clock_message.tm.tm_sec;
+            /*the error of the RTC against the time recived is used to learn the crystal offset*/
+            (void)Clock_GetTime( &RtcTime );
+            RealTime = HIL_TIME_AddDays( CAN_to_clock_message.time, HIL_TIME_DiffDays( RtcTime, 0u ) );
+            RtcCal_Sync( RtcTime, RealTime );
+            Delta = (int32_t)(RealTime - RtcTime);
+            Delta = (Delta > LOG_DELTA_MAX) ? LOG_DELTA_MAX : ((Delta < -LOG_DELTA_MAX) ? -LOG_DELTA_MAX : Delta);
+            Log_Event( LOG_EVENT_SET_TIME, (uint8_t)((uint32_t)Delta >> 16u), (uint8_t)((uint32_t)Delta >> 8u), (uint8_t)Delta );
+            HIL_TIME_FromEpoch( CAN_to_clock_message.time, &NewTime );
+            sTime.Hours          = NewTime.hour;
+            sTime.Minutes        = NewTime.min;
+            sTime.Seconds        = NewTime.sec;
             sTime.SubSeconds     = 0x00;
             sTime.DayLightSaving = RTC_DAYLIGHTSAVING_NONE;
             sTime.StoreOperation = RTC_STOREOPERATION_RESET;
             
-            Status = HAL_RTC_SetTime( &hrtc, &sTime, RTC_FORMAT_BCD );
+            Status = HAL_RTC_SetTime( &hrtc, &sTime, RTC_FORMAT_BIN );
             assert_error( Status == HAL_OK, RTC_SETTIME_ERROR );    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+            (void)Clock_ReadRtc();
+            Clock_TzSync();
+            Clock_ScheduleAlarm();
             CAN_to_clock_message.msg = CLOCK_ST_DISPLAY;
             (void)HIL_QUEUE_WriteISR( &SERIAL_queue, &CAN_to_clock_message, RTC_TAMP_IRQn);
             
@@ -203,13 +337,18 @@ static void Clock_StMachine(uint8_t Clockstate)
         
         case CLOCK_ST_CHANGE_DATE:
         
-            sDate.WeekDay   = CAN_to_clock_message.tm.tm_wday;
-            sDate.Month     = CAN_to_clock_message.tm.tm_mon;
-            sDate.Date      = CAN_to_clock_message.tm.tm_mday;
-            sDate.Year      = CAN_to_clock_message.tm.tm_year_lsb;
+            HIL_TIME_FromEpoch( CAN_to_clock_message.time, &NewTime );
+            sDate.WeekDay   = NewTime.wday;
+            sDate.Month     = NewTime.mon;
+            sDate.Date      = NewTime.mday;
+            sDate.Year      = NewTime.year;
 
-            Status = HAL_RTC_SetDate( &hrtc, &sDate, RTC_FORMAT_BCD );
+            Status = HAL_RTC_SetDate( &hrtc, &sDate, RTC_FORMAT_BIN );
             assert_error( Status == HAL_OK, RTC_SETDATE_ERROR );        /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+            Log_Event( LOG_EVENT_SET_DATE, NewTime.mday, NewTime.mon, NewTime.year );
+            (void)Clock_ReadRtc();
+            Clock_TzSync();
+            Clock_ScheduleAlarm();
 
             CAN_to_clock_message.msg = CLOCK_ST_DISPLAY;
             (void)HIL_QUEUE_WriteISR( &SERIAL_queue, &CAN_to_clock_message, RTC_TAMP_IRQn);
@@ -218,20 +357,39 @@ static void Clock_StMachine(uint8_t Clockstate)
         
         case CLOCK_ST_CHANGE_ALARM:
         
-            sAlarm.AlarmTime.Hours      = CAN_to_clock_message.tm.tm_hour;      
-            sAlarm.AlarmTime.Minutes    = CAN_to_clock_message.tm.tm_min;              
-            Status = HAL_RTC_DeactivateAlarm(&hrtc, RTC_ALARM_A);
-            assert_error( Status == HAL_OK, RTC_SDESACTIVATE_ALARM_ERROR ); /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-            Status = HAL_RTC_SetAlarm_IT(&hrtc, &sAlarm, RTC_FORMAT_BCD);
-            assert_error( Status == HAL_OK, RTC_SET_ALARM_ERROR );  /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-            Alarm_State = ALARM_ON;
+            NewAlarm.hour       = CAN_to_clock_message.alarm_hour;
+            NewAlarm.minute     = CAN_to_clock_message.alarm_minute;
+            NewAlarm.weekdays   = CAN_to_clock_message.alarm_days;
+            NewAlarm.enable     = TRUE;
+            NewAlarm.snooze     = CAN_to_clock_message.alarm_snooze;
+            NewAlarm.snooze_max = CAN_to_clock_message.alarm_snooze_max;
+            if( Alarms_Set( CAN_to_clock_message.alarm_slot, &NewAlarm ) == TRUE )
+            {
+                Config_SetAlarm( CAN_to_clock_message.alarm_slot, &NewAlarm );
+            }
+            Clock_ScheduleAlarm();
+            CAN_to_clock_message.msg = CLOCK_ST_DISPLAY;
+            (void)HIL_QUEUE_WriteISR( &SERIAL_queue, &CAN_to_clock_message, RTC_TAMP_IRQn);
+        break;
+
+        case CLOCK_ST_ENABLE_ALARM:
+            /*the menu only changes the enable, the rest of the alarm is kept*/
+            if( Alarms_Get( CAN_to_clock_message.alarm_slot, &NewAlarm ) == TRUE )
+            {
+                NewAlarm.enable = CAN_to_clock_message.alarm_enable;
+                (void)Alarms_Set( CAN_to_clock_message.alarm_slot, &NewAlarm );
+                Config_SetAlarm( CAN_to_clock_message.alarm_slot, &NewAlarm );
+            }
+            Clock_ScheduleAlarm();
             CAN_to_clock_message.msg = CLOCK_ST_DISPLAY;
             (void)HIL_QUEUE_WriteISR( &SERIAL_queue, &CAN_to_clock_message, RTC_TAMP_IRQn);
         break;
         
         case CLOCK_ST_ALARM_OFF:
-            Status = HAL_RTC_DeactivateAlarm(&hrtc, RTC_ALARM_A);
+            /*a message while the alarm rings dismisses it, also the pending snooze*/
+            Status = HAL_RTC_DeactivateAlarm(&hrtc, RTC_ALARM_B);
             assert_error( Status == HAL_OK, RTC_SDESACTIVATE_ALARM_ERROR ); /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */ 
+            Snooze_Pending = FALSE;
             Alarm_Flag_Clock = TRUE;
             CAN_to_clock_message.msg = CLOCK_ST_DISPLAY;
             Display_msg();
@@ -244,6 +402,24 @@ static void Clock_StMachine(uint8_t Clockstate)
         case CLOCK_ST_FLAG_OFF:
             Alarm_State =  ALARM_OFF;
             Alarm_Flag_Clock = FALSE;   
+            Clock_ScheduleAlarm();
+        break;
+
+        case CLOCK_ST_SNOOZE:
+            Clock_Snooze();
+            Alarm_State =  ALARM_OFF;
+            Alarm_Flag_Clock = FALSE;   
+            Clock_ScheduleAlarm();
+        break;
+
+        case CLOCK_ST_CHANGE_TZ:
+            /*the time on the RTC is kept as local time, only the daylight saving state is updated*/
+            TimeZone.Offset = (int16_t)CAN_to_clock_message.tz_offset * TZ_QUARTER_MINUTES;
+            TimeZone.Rule   = CAN_to_clock_message.tz_rule;
+            Config_SetTz( TimeZone.Offset, TimeZone.Rule );
+            Clock_TzSync();
+            CAN_to_clock_message.msg = CLOCK_ST_DISPLAY;
+            (void)HIL_QUEUE_WriteISR( &SERIAL_queue, &CAN_to_clock_message, RTC_TAMP_IRQn);
         break;
          
         default:
@@ -252,46 +428,358 @@ static void Clock_StMachine(uint8_t Clockstate)
     }
 }
 
+/**
+* @brief   **This function programs the next alarm of the table on the alarm A**
+*
+*  The function takes the current time from the snapshot and asks the alarm table for the next alarm,
+*  only that alarm is programmed on the RTC alarm A matching the weekday, hour and minutes.
+*  If there is no alarm enabled the alarm A is deactivated. The state is only changed
+*  when no alarm is ringing, it will be ALARM_ON if an alarm or a snooze is programmed.
+*/
+static void Clock_ScheduleAlarm(void)
+{
+    APP_AlarmTypeDef NextAlarm;
+    HIL_TIME_TmTypeDef Now;
+    HIL_TIME_EpochTypeDef now;
+    uint8_t slot;
+    uint8_t wday;
+    uint8_t alarm_found;
+
+    (void)Clock_GetTime( &now );
+    HIL_TIME_FromEpoch( now, &Now );
+
+    Status = HAL_RTC_DeactivateAlarm(&hrtc, RTC_ALARM_A);
+    assert_error( Status == HAL_OK, RTC_SDESACTIVATE_ALARM_ERROR ); /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+
+    alarm_found = Alarms_Next( Now.wday, Now.hour, Now.min, &slot, &wday );
+    if( alarm_found == TRUE )
+    {
+        (void)Alarms_Get( slot, &NextAlarm );
+        sAlarm.AlarmTime.Hours   = NextAlarm.hour;
+        sAlarm.AlarmTime.Minutes = NextAlarm.minute;
+        sAlarm.AlarmTime.Seconds = 0u;
+        sAlarm.AlarmDateWeekDay  = wday;
+        Status = HAL_RTC_SetAlarm_IT(&hrtc, &sAlarm, RTC_FORMAT_BIN);
+        assert_error( Status == HAL_OK, RTC_SET_ALARM_ERROR );  /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+        Scheduled_Slot = slot;
+    }
+
+    if( Alarm_State != ALARM_ACTIVE )
+    {
+        Alarm_State = ( (alarm_found == TRUE) || (Snooze_Pending == TRUE) ) ? ALARM_ON : ALARM_OFF;
+    }
+}
+
+/**
+* @brief   **This function programs the snooze of the ringing alarm on the alarm B**
+*
+*  If the alarm that is ringing has a snooze time and has not been snoozed more than
+*  its max value the alarm B is programmed snooze minutes after the current time,
+*  otherwise the alarm is just stopped.
+*/
+static void Clock_Snooze(void)
+{
+    APP_AlarmTypeDef RingingAlarm;
+    HIL_TIME_TmTypeDef SnoozeTime;
+    HIL_TIME_EpochTypeDef now;
+
+    (void)Alarms_Get( Ringing_Slot, &RingingAlarm );
+    if( (RingingAlarm.snooze > 0u) && (Snooze_Count < RingingAlarm.snooze_max) )
+    {
+        (void)Clock_GetTime( &now );
+        HIL_TIME_FromEpoch( now + ((uint32_t)RingingAlarm.snooze * HIL_TIME_SEC_PER_MIN), &SnoozeTime );
+        sAlarmB.AlarmTime.Hours   = SnoozeTime.hour;
+        sAlarmB.AlarmTime.Minutes = SnoozeTime.min;
+        sAlarmB.AlarmTime.Seconds = SnoozeTime.sec;
+
+        Status = HAL_RTC_DeactivateAlarm(&hrtc, RTC_ALARM_B);
+        assert_error( Status == HAL_OK, RTC_SDESACTIVATE_ALARM_ERROR ); /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+        Status = HAL_RTC_SetAlarm_IT(&hrtc, &sAlarmB, RTC_FORMAT_BIN);
+        assert_error( Status == HAL_OK, RTC_SET_ALARMB_ERROR );  /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+        Snooze_Count++;
+        Snooze_Pending = TRUE;
+    }
+}
+
+/**
+* @brief   **This function reads the RTC after it was changed by the clock task**
+*
+*  The snapshot is refreshed with the RTC interrupt disabled so the wakeup event
+*  can not write it at the same time, it is only needed after the time or the date
+*  are set or the daylight saving changes the hour, otherwise the snapshot is up to date.
+*
+* @retval  seconds since 2000-01-01 00:00:00
+*/
+static HIL_TIME_EpochTypeDef Clock_ReadRtc(void)
+{
+    HIL_TIME_EpochTypeDef now;
+
+    HAL_NVIC_DisableIRQ( RTC_TAMP_IRQn );
+    Clock_UpdateSnapshot();
+    HAL_NVIC_EnableIRQ( RTC_TAMP_IRQn );
+
+    (void)Clock_GetTime( &now );
+    return now;
+}
+
+/**
+* @brief   **This function reads the RTC and writes the time snapshot**
+*
+*  The time and date are read in BCD format like the RTC keeps them, so the HAL does
+*  not convert them, the display shows the BCD values and the seconds since the epoch
+*  are calculated from them converted to binary. The date has to be read after the time
+*  to unlock the shadow registers. Local variables are used since it runs on the RTC
+*  interrupt, even for the HAL status, so it does not overwrite the Status of the task it
+*  interrupted, the sequence is odd while the snapshot is being written.
+*/
+static void Clock_UpdateSnapshot(void)
+{
+    RTC_TimeTypeDef RtcTime;
+    RTC_DateTypeDef RtcDate;
+    HIL_TIME_TmTypeDef CurrentTime;
+    HAL_StatusTypeDef RtcStatus;
+
+    /* Get the RTC current Time */
+    RtcStatus = HAL_RTC_GetTime( &hrtc, &RtcTime, RTC_FORMAT_BCD );
+    assert_error( RtcStatus == HAL_OK, RTC_GET_TIME_ERROR );    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+    /* Get the RTC current Date */
+    RtcStatus = HAL_RTC_GetDate( &hrtc, &RtcDate, RTC_FORMAT_BCD );
+    assert_error( RtcStatus == HAL_OK, RTC_GET_DATE_ERROR );    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+
+    CurrentTime.hour = HIL_TIME_BcdToBin( RtcTime.Hours );
+    CurrentTime.min  = HIL_TIME_BcdToBin( RtcTime.Minutes );
+    CurrentTime.sec  = HIL_TIME_BcdToBin( RtcTime.Seconds );
+    CurrentTime.mday = HIL_TIME_BcdToBin( RtcDate.Date );
+    CurrentTime.mon  = HIL_TIME_BcdToBin( RtcDate.Month );
+    CurrentTime.year = HIL_TIME_BcdToBin( RtcDate.Year );
+
+    Snapshot_Sequence++;
+    Snapshot_Time     = HIL_TIME_ToEpoch( &CurrentTime );
+    Snapshot_Bcd.hour = RtcTime.Hours;
+    Snapshot_Bcd.min  = RtcTime.Minutes;
+    Snapshot_Bcd.sec  = RtcTime.Seconds;
+    Snapshot_Bcd.mday = RtcDate.Date;
+    Snapshot_Bcd.mon  = RtcDate.Month;
+    Snapshot_Bcd.year = RtcDate.Year;
+    Snapshot_Bcd.wday = RtcDate.WeekDay;
+    Snapshot_Sequence++;
+}
+
+/**
+* @brief   **This function gets the time of the last second of the RTC**
+*
+*  The snapshot is copied until the sequence is even and did not change during the copy,
+*  that way a second event in the middle of the read is detected and the read is done again.
+*  The registers of the RTC are not read so any task can call it.
+*
+* @param   time[out]   seconds since 2000-01-01 00:00:00
+*
+* @retval  sequence of the snapshot, it changes every second
+*/
+uint32_t Clock_GetTime( HIL_TIME_EpochTypeDef *time )
+{
+    uint32_t sequence;
+
+    do
+    {
+        sequence = Snapshot_Sequence;
+        *time    = Snapshot_Time;
+    } while( ((sequence & 1u) != 0u) || (sequence != Snapshot_Sequence) );
+
+    return sequence;
+}
+
+/**
+* @brief   **This function gets the calendar of the last second of the RTC in BCD**
+*
+*  The snapshot is copied the same way as Clock_GetTime, the values are the ones of the
+*  RTC registers so they can be shown without any division.
+*
+* @param   bcd[out]   calendar fields in BCD
+*
+* @retval  sequence of the snapshot, it changes every second
+*/
+uint32_t Clock_GetCalendar( HIL_TIME_BcdTypeDef *bcd )
+{
+    uint32_t sequence;
+
+    do
+    {
+        sequence  = Snapshot_Sequence;
+        bcd->sec  = Snapshot_Bcd.sec;
+        bcd->min  = Snapshot_Bcd.min;
+        bcd->hour = Snapshot_Bcd.hour;
+        bcd->mday = Snapshot_Bcd.mday;
+        bcd->mon  = Snapshot_Bcd.mon;
+        bcd->year = Snapshot_Bcd.year;
+        bcd->wday = Snapshot_Bcd.wday;
+    } while( ((sequence & 1u) != 0u) || (sequence != Snapshot_Sequence) );
+
+    return sequence;
+}
+
+/**
+* @brief   **This function gets the time with the fraction of the second**
+*
+*  The fraction is read from the sub-second down counter of the RTC and the seconds from the
+*  snapshot, with the interrupts masked so the wakeup event can not refresh the snapshot between
+*  both reads. If the second rolled over but its interrupt is still pending the snapshot is one
+*  second behind the counter, the wakeup flag is checked before and after the read and if it got
+*  set in the middle the counter is read again so both values belong to the new second.
+*  The registers are read directly instead of with HAL_RTC_GetTime, reading the date register
+*  releases the shadow registers locked by the sub-second read so the next read is not stale.
+*
+* @param   stamp[out]   seconds since 2000-01-01 00:00:00 and fraction in 1/65536 s, 1/256 s of resolution
+*/
+void Clock_GetTimestamp( HIL_TIME_StampTypeDef *stamp )
+{
+    uint32_t primask = __get_PRIMASK();
+    uint32_t pending;
+    uint32_t ssr;
+    HIL_TIME_EpochTypeDef seconds;
+
+    __disable_irq();
+    pending = __HAL_RTC_WAKEUPTIMER_GET_FLAG( &hrtc, RTC_FLAG_WUTF );
+    ssr     = hrtc.Instance->SSR;
+    if( (pending == 0u) && (__HAL_RTC_WAKEUPTIMER_GET_FLAG( &hrtc, RTC_FLAG_WUTF ) != 0u) )
+    {
+        ssr     = hrtc.Instance->SSR;
+        pending = 1u;
+    }
+    (void)hrtc.Instance->DR;
+    seconds = Snapshot_Time;
+    __set_PRIMASK( primask );
+
+    if( pending != 0u )
+    {
+        seconds++;
+    }
+
+    /*after a shift operation the counter can be above the prescaler for a moment*/
+    stamp->seconds    = seconds;
+    stamp->subseconds = (ssr > CLOCK_SYNCH_PREDIV) ? 0u : (uint16_t)((CLOCK_SYNCH_PREDIV - ssr) << CLOCK_SUBSECOND_SHIFT);
+}
+
+/**
+* @brief   **This function gets the offset of the local time from UTC**
+*
+*  The offset of the standard time plus one hour while the daylight saving is active, the
+*  state is the backup bit of the RTC so it is the same the clock task uses.
+*
+* @retval  offset in minutes
+*/
+int16_t Clock_GetUtcOffset( void )
+{
+    int16_t offset = TimeZone.Offset;
+
+    if( HAL_RTC_DST_ReadStoreOperation( &hrtc ) != 0u )
+    {
+        offset += (int16_t)(HIL_TIME_SEC_PER_HOUR / HIL_TIME_SEC_PER_MIN);
+    }
+
+    return offset;
+}
+
+/**
+* @brief   **This function updates the daylight saving state after the time or the rule changed**
+*
+*  The time on the RTC is the local wall clock time, if the daylight saving is active at that time
+*  the standard time is one hour behind, the state is stored on the backup bit of the RTC and the
+*  transitions of the current and next year are calculated from the standard time.
+*/
+static void Clock_TzSync(void)
+{
+    HIL_TIME_EpochTypeDef wall;
+    HIL_TIME_EpochTypeDef standard;
+
+    (void)Clock_GetTime( &wall );
+    standard = (wall >= HIL_TIME_SEC_PER_HOUR) ? (wall - HIL_TIME_SEC_PER_HOUR) : wall;
+
+    HIL_TZ_Init( &TimeZone, standard );
+    if( HIL_TZ_IsDst( &TimeZone, standard ) == TRUE )
+    {
+        HAL_RTC_DST_SetStoreOperation( &hrtc );
+    }
+    else
+    {
+        HAL_RTC_DST_ClearStoreOperation( &hrtc );
+        HIL_TZ_Init( &TimeZone, wall );
+    }
+}
+
+/**
+* @brief   **This function applies the daylight saving changes**
+*
+*  Called every second, the standard time is compared only against the next precalculated
+*  transition, when it is reached the RTC adds or subtracts one hour by hardware and the
+*  backup bit keeps the daylight saving state, then the alarm is programmed again since
+*  the wall clock jumped.
+*
+* @param   wall[in] current time of the RTC
+*
+* @retval  TRUE if the time of the RTC changed, otherwise FALSE
+*/
+static uint8_t Clock_TzCheck(HIL_TIME_EpochTypeDef wall)
+{
+    uint8_t changed = FALSE;
+    uint8_t dst = (HAL_RTC_DST_ReadStoreOperation( &hrtc ) != 0u) ? TRUE : FALSE;
+    HIL_TIME_EpochTypeDef standard = (dst == TRUE) ? (wall - HIL_TIME_SEC_PER_HOUR) : wall;
+
+    switch( HIL_TZ_Check( &TimeZone, standard ) )
+    {
+        case HIL_TZ_DST_START:
+            if( dst == FALSE )
+            {
+                HAL_RTC_DST_Add1Hour( &hrtc );
+                HAL_RTC_DST_SetStoreOperation( &hrtc );
+                changed = TRUE;
+            }
+        break;
+
+        case HIL_TZ_DST_END:
+            if( dst == TRUE )
+            {
+                HAL_RTC_DST_Sub1Hour( &hrtc );
+                HAL_RTC_DST_ClearStoreOperation( &hrtc );
+                changed = TRUE;
+            }
+        break;
+
+        default:
+        break;
+    }
+
+    if( changed == TRUE )
+    {
+        (void)Clock_ReadRtc();
+        Clock_ScheduleAlarm();
+    }
+
+    return changed;
+}
+
 /**
 * @brief   **This function send a message to app_display**
 *
-*  The function first gets the data of the rtc and stores it on the ClockMsg
+*  The function first gets the time snapshot and stores it on the ClockMsg
 *  variable then gives ClockMsg.msg the DISPLAY_MESSAGE value wich tells the 
 *  app_display to display data on the lcd and sends this message through the 
 *  circular buffer. 
-*  this function will also be called every second by the software timer configured
-*  on the main function.   
-*  if the button is pressed this function will also send the alarm data
+*  this function will also be called by the clock task every time the RTC
+*  refreshes the snapshot, once every second.
 */
 void Display_msg(void)
 {
     APP_MsgTypeDef ClockMsg;
 
-    /* Get the RTC current Time */
-    Status = HAL_RTC_GetTime( &hrtc, &sTime, RTC_FORMAT_BIN );
-    assert_error( Status == HAL_OK, RTC_GET_TIME_ERROR );       /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-    /* Get the RTC current Date */
-    Status = HAL_RTC_GetDate( &hrtc, &sDate, RTC_FORMAT_BIN );
-    assert_error( Status == HAL_OK, RTC_GET_DATE_ERROR );       /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-    ClockMsg.tm.tm_year_msb = CAN_to_clock_message.tm.tm_year_msb;
-    ClockMsg.tm.tm_mon = sDate.Month;
-    ClockMsg.tm.tm_mday = sDate.Date;
-    ClockMsg.tm.tm_year_lsb = sDate.Year;
-    ClockMsg.tm.tm_wday = sDate.WeekDay;
-
-    ClockMsg.tm.tm_hour = sTime.Hours;
-    ClockMsg.tm.tm_min = sTime.Minutes;
-    ClockMsg.tm.tm_sec = sTime.Seconds;
-
-    ClockMsg.S_alarm = Alarm_State;
-    ClockMsg.F_alarm = Alarm_Flag_Clock;
-
-    if (button == TRUE)
+    Displayed_Sequence = Clock_GetTime( &ClockMsg.time );
+    if( Clock_TzCheck( ClockMsg.time ) == TRUE )
     {
-        HAL_RTC_GetAlarm(&hrtc, &sAlarm, RTC_ALARM_A, RTC_FORMAT_BIN);
-        ClockMsg.tm.tm_hour_alarm = sAlarm.AlarmTime.Hours;
-        ClockMsg.tm.tm_min_alarm = sAlarm.AlarmTime.Minutes;
+        Displayed_Sequence = Clock_GetTime( &ClockMsg.time );
     }
+    ClockMsg.S_alarm = Alarm_State;
+    ClockMsg.F_alarm = Alarm_Flag_Clock;
+    ClockMsg.alarm_slot = Ringing_Slot;
     ClockMsg.msg = DISPLAY_MESSAGE;
     (void)HIL_QUEUE_WriteISR( &CLOCK_queue, &ClockMsg, RTC_TAMP_IRQn );
 }
@@ -308,4 +796,34 @@ void Display_msg(void)
 void HAL_RTC_AlarmAEventCallback( RTC_HandleTypeDef *hrtc ) /* cppcheck-suppress misra-c2012-2.7 ; this is a library function */
 {
     Alarm_State = ALARM_ACTIVE ;
+    Ringing_Slot = Scheduled_Slot;
+    Snooze_Count = 0u;
+    Log_Event( LOG_EVENT_ALARM, Ringing_Slot, 0u, 0u );
+}
+
+/**
+* @brief   **Interruption for the snooze alarm **
+*
+*  This function will be triggered when the snooze time of the ringing alarm has passed,
+*  the alarm rings again the same way as the alarm A.
+*/
+/* cppcheck-suppress misra-c2012-8.4 ; function cannot be modify is a library function */
+/* cppcheck-suppress misra-c2012-5.8 ; file is added*/
+void HAL_RTCEx_AlarmBEventCallback( RTC_HandleTypeDef *hrtc ) /* cppcheck-suppress misra-c2012-2.7 ; this is a library function */
+{
+    Alarm_State = ALARM_ACTIVE ;
+    Snooze_Pending = FALSE;
+}
+
+/**
+* @brief   **Interruption for the wakeup timer **
+*
+*  This function will be triggered every time the seconds of the RTC change,
+*  the time snapshot is refreshed so the tasks do not need to read the RTC.
+*/
+/* cppcheck-suppress misra-c2012-8.4 ; function cannot be modify is a library function */
+/* cppcheck-suppress misra-c2012-5.8 ; file is added*/
+void HAL_RTCEx_WakeUpTimerEventCallback( RTC_HandleTypeDef *hrtc ) /* cppcheck-suppress misra-c2012-2.7 ; this is a library function */
+{
+    Clock_UpdateSnapshot();
 }
\ No newline at end of file
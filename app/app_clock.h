@@ -14,10 +14,15 @@
 
 #include "app_bsp.h"
 #include "scheduler.h"
+#include "hil_time.h"
 
 void Clock_Init( void );
 void Clock_Task( void );
 void Display_msg(void); 
+uint32_t Clock_GetTime( HIL_TIME_EpochTypeDef *time );
+uint32_t Clock_GetCalendar( HIL_TIME_BcdTypeDef *bcd );
+void Clock_GetTimestamp( HIL_TIME_StampTypeDef *stamp );
+int16_t Clock_GetUtcOffset( void );
 
 /**
   * @brief  Variable for scheduler.
@@ -0,0 +1,247 @@
+/**
+* @file    app_config.c
+* @brief   **Persistent configuration**
+*
+*   The alarms, the crystal curve, the time zone, the CAN ID and the contrast are kept on
+*   the two last pages of the flash with the record store of hil_store, a change is written
+*   after one second without changes so a burst of CAN messages is only one record.
+*   The values that change often or that tell if the RTC kept running, the learned offset
+*   of the crystal and the valid time flag, are kept on the RTC backup registers that are
+*   not erased by a reset while the backup domain has power.
+*/
+#include "app_config.h"
+#include "hil_store.h"
+#include "hil_tz.h"
+#include <string.h>
+
+/**
+  * @defgroup Config_flash pages used to store the configuration, the linker does not use them
+  @{ */
+#define CONFIG_FLASH_ADDRESS    0x0807F000u     /*!< Address of the first page, the last 4K of the flash*/
+#define CONFIG_FLASH_BANK       FLASH_BANK_2    /*!< The pages are on the second bank*/
+#define CONFIG_FLASH_PAGE       126u            /*!< Number of the first page on the second bank*/
+/**
+  @} */
+
+/**
+  * @defgroup Config_backup use of the RTC backup registers
+  @{ */
+#define CONFIG_BKP_VALID        RTC_BKP_DR0     /*!< Register with the valid time mark*/
+#define CONFIG_BKP_OFFSET       RTC_BKP_DR1     /*!< Register with the learned offset of the crystal*/
+#define CONFIG_BKP_OFFSET_CHECK RTC_BKP_DR2     /*!< Register with the offset inverted to check it*/
+#define CONFIG_VALID_MARK       0xC10C0001u     /*!< Value of the valid mark, it is 0 after a backup domain reset*/
+/**
+  @} */
+
+/**
+  * @defgroup Config_save values to save the configuration
+  @{ */
+#define CONFIG_SAVE_DELAY       10u     /*!< Task periods without changes before writing, one second*/
+/**
+  @} */
+
+/**
+* @brief  Configuration in use, the flash has the same values once Dirty is FALSE
+*/
+static CONFIG_DataTypeDef Config;
+
+/**
+* @brief  Flag for changes not written yet and periods since the last change
+*/
+static uint8_t Dirty;
+static uint8_t SaveDelay;
+
+/**
+* @brief  Record store on flash
+*/
+static STORE_HandleTypeDef ConfigStore;
+
+/**
+* @brief   **Init function for the persistent configuration**
+*
+*   The last valid record of the flash is loaded, reading the headers and checking
+*   one CRC, if there is none the default values are used. It has to be the first
+*   init so the other tasks start with the values stored.
+*/
+void Config_Init( void )
+{
+    ConfigStore.Address = CONFIG_FLASH_ADDRESS;
+    ConfigStore.Bank    = CONFIG_FLASH_BANK;
+    ConfigStore.Page    = CONFIG_FLASH_PAGE;
+    ConfigStore.Size    = sizeof(CONFIG_DataTypeDef);
+    HIL_STORE_Init( &ConfigStore );
+
+    if( HIL_STORE_Read( &ConfigStore, &Config ) == FALSE )
+    {
+        (void)memset( &Config, 0, sizeof(Config) );
+        Config.curve.k        = RTCCAL_DEFAULT_K;
+        Config.curve.turnover = RTCCAL_DEFAULT_TURNOVER;
+        Config.curve.offset   = 0;
+        Config.curve.learn    = TRUE;
+        Config.tz_offset      = 0;
+        Config.tz_rule        = HIL_TZ_RULE_NONE;
+        Config.contrast       = CONFIG_NO_CONTRAST;
+        Config.node_id        = CONFIG_DEFAULT_NODE_ID;
+    }
+
+    Dirty     = FALSE;
+    SaveDelay = 0u;
+}
+
+/**
+* @brief   **Task function for the persistent configuration**
+*
+*   Once the configuration did not change for CONFIG_SAVE_DELAY periods a new record is
+*   written, if the store is erasing a page the write is tried again on the next period.
+*   The erase is done with interrupts so the task never waits for it.
+*/
+void Config_Task( void )
+{
+    if( Dirty == TRUE )
+    {
+        SaveDelay++;
+        if( SaveDelay >= CONFIG_SAVE_DELAY )
+        {
+            if( HIL_STORE_Write( &ConfigStore, &Config ) == TRUE )
+            {
+                Dirty     = FALSE;
+                SaveDelay = 0u;
+            }
+        }
+    }
+}
+
+/**
+* @brief   **Gets the configuration**
+*
+* @retval  pointer to the configuration in use, it can not be modified
+*/
+const CONFIG_DataTypeDef *Config_Get( void )
+{
+    return &Config;
+}
+
+/**
+* @brief   **Changes one alarm of the table**
+*
+* @param   slot[in]    position of the alarm on the table, less than ALARMS_NUMBER
+* @param   alarm[in]   alarm configuration
+*/
+void Config_SetAlarm( uint8_t slot, const APP_AlarmTypeDef *alarm )
+{
+    if( slot < ALARMS_NUMBER )
+    {
+        Config.alarms[slot] = *alarm;
+        Dirty     = TRUE;
+        SaveDelay = 0u;
+    }
+}
+
+/**
+* @brief   **Changes the crystal curve**
+*
+* @param   curve[in]   crystal curve
+*/
+void Config_SetCurve( const RtcCal_CurveTypeDef *curve )
+{
+    Config.curve = *curve;
+    Dirty     = TRUE;
+    SaveDelay = 0u;
+}
+
+/**
+* @brief   **Changes the time zone**
+*
+* @param   offset[in]  minutes of the standard time from UTC
+* @param   rule[in]    daylight saving rule
+*/
+void Config_SetTz( int16_t offset, uint8_t rule )
+{
+    Config.tz_offset = offset;
+    Config.tz_rule   = rule;
+    Dirty     = TRUE;
+    SaveDelay = 0u;
+}
+
+/**
+* @brief   **Changes the CAN ID and the contrast**
+*
+*   The CAN ID is used after the next reset, the contrast is used right away.
+*
+* @param   node_id[in]   CAN ID of the messages received, up to CONFIG_MAX_NODE_ID
+* @param   contrast[in]  contrast of the lcd or CONFIG_NO_CONTRAST
+*/
+void Config_SetNode( uint16_t node_id, uint8_t contrast )
+{
+    Config.node_id  = node_id;
+    Config.contrast = contrast;
+    Dirty     = TRUE;
+    SaveDelay = 0u;
+}
+
+/**
+* @brief   **Tells if the RTC kept the time**
+*
+*   The mark is written once the RTC is configured, a backup domain reset clears it,
+*   so if it is there the RTC has been running since the time was set.
+*
+* @retval  TRUE if the time of the RTC is valid, otherwise FALSE
+*/
+uint8_t Config_IsTimeValid( void )
+{
+    return (HAL_RTCEx_BKUPRead( &hrtc, CONFIG_BKP_VALID ) == CONFIG_VALID_MARK) ? TRUE : FALSE;
+}
+
+/**
+* @brief   **Marks the time of the RTC as valid**
+*/
+void Config_SetTimeValid( void )
+{
+    HAL_RTCEx_BKUPWrite( &hrtc, CONFIG_BKP_VALID, CONFIG_VALID_MARK );
+}
+
+/**
+* @brief   **Gets the learned offset of the crystal from the backup registers**
+*
+* @param   offset[out]  offset at the turnover temperature in ppb
+*
+* @retval  TRUE if the backup registers had a valid offset, otherwise FALSE
+*/
+uint8_t Config_GetCalOffset( int32_t *offset )
+{
+    uint32_t value = HAL_RTCEx_BKUPRead( &hrtc, CONFIG_BKP_OFFSET );
+    uint8_t valid = FALSE;
+
+    if( (Config_IsTimeValid() == TRUE) && (HAL_RTCEx_BKUPRead( &hrtc, CONFIG_BKP_OFFSET_CHECK ) == ~value) )
+    {
+        *offset = (int32_t)value;
+        valid   = TRUE;
+    }
+
+    return valid;
+}
+
+/**
+* @brief   **Stores the learned offset of the crystal on the backup registers**
+*
+*   It is written on every sync, the flash only gets it when the curve is configured.
+*
+* @param   offset[in]  offset at the turnover temperature in ppb
+*/
+void Config_SetCalOffset( int32_t offset )
+{
+    HAL_RTCEx_BKUPWrite( &hrtc, CONFIG_BKP_OFFSET, (uint32_t)offset );
+    HAL_RTCEx_BKUPWrite( &hrtc, CONFIG_BKP_OFFSET_CHECK, ~(uint32_t)offset );
+}
+
+/**
+* @brief   **Ends the erase of a page of the store**
+*
+*  It is called from the flash interrupt when an erase finished or failed, if the erase
+*  was not from this store nothing is done. A failed erase goes to the safe state once
+*  the state is cleared.
+*/
+void Config_EraseCallback( void )
+{
+    HIL_STORE_EraseCallback( &ConfigStore );
+}
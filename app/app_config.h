@@ -0,0 +1,56 @@
+/**
+* @file    <app_config.h>
+* @brief   **Header file for app_config.c**
+*
+*   This file contains the declaration for the functions on the .c file
+*   and the structure with the configuration kept on flash.
+*   To use this aplication you need to first call the Config_Init function before
+*   the init of the other tasks, then you can call the Config_Task function.
+*   The functions of the backup registers can only be used after Clock_Init.
+* @note    The configuration is written on flash one second after the last change,
+*          the values that change often are kept on the RTC backup registers
+*/
+#ifndef APP_CONFIG_H__
+#define APP_CONFIG_H__
+
+#include "app_bsp.h"
+#include "app_alarms.h"
+#include "app_rtccal.h"
+
+/**
+  * @defgroup Config_values configuration values
+  @{ */
+#define CONFIG_NO_CONTRAST      0xFFu   /*!< The contrast is taken from the pot*/
+#define CONFIG_DEFAULT_NODE_ID  0x111u  /*!< CAN ID of the messages received by default*/
+#define CONFIG_MAX_NODE_ID      0x7EDu  /*!< Max node ID, the log entries use the ID plus 0x12 and must stay a standard CAN ID*/
+#define CONFIG_MAX_CONTRAST     15u     /*!< Max value accepted by the lcd contrast command*/
+/**
+  @} */
+
+/**
+* @brief   Structure with the configuration stored on flash
+*/
+typedef struct _CONFIG_DataTypeDef
+{
+  APP_AlarmTypeDef    alarms[ALARMS_NUMBER];  /*!< Alarm table */
+  RtcCal_CurveTypeDef curve;                  /*!< Crystal curve, the learned offset is also on the backup registers */
+  int16_t             tz_offset;              /*!< Minutes of the standard time from UTC */
+  uint8_t             tz_rule;                /*!< Daylight saving rule, see hil_tz.h */
+  uint8_t             contrast;               /*!< Contrast of the lcd, CONFIG_NO_CONTRAST to use the pot */
+  uint16_t            node_id;                /*!< CAN ID of the messages received */
+} CONFIG_DataTypeDef;
+
+void Config_Init( void );
+void Config_Task( void );
+const CONFIG_DataTypeDef *Config_Get( void );
+void Config_SetAlarm( uint8_t slot, const APP_AlarmTypeDef *alarm );
+void Config_SetCurve( const RtcCal_CurveTypeDef *curve );
+void Config_SetTz( int16_t offset, uint8_t rule );
+void Config_SetNode( uint16_t node_id, uint8_t contrast );
+uint8_t Config_IsTimeValid( void );
+void Config_SetTimeValid( void );
+uint8_t Config_GetCalOffset( int32_t *offset );
+void Config_SetCalOffset( int32_t offset );
+void Config_EraseCallback( void );
+
+#endif
@@ -2,64 +2,91 @@
 #include "hel_lcd.h"
 #include "hil_queue.h"
 #include "app_analog.h"
+#include "hil_time.h"
+#include "app_clock.h"
+#include "app_stopwatch.h"
+#include "app_menu.h"
+#include "app_alarms.h"
+#include "app_config.h"
+#include "app_canhealth.h"
+#include "app_button.h"
+#include "app_buzzer.h"
+#include "app_backlight.h"
+#include "scheduler.h"
 
+/** 
+  * @defgroup Screens what the lcd shows, the fields of the layout are shown on a mask of them.
+  @{ */
+#define SCREEN_CLOCK        0x001u   /*!<time, alarm mark and temperature on the second row*/
+#define SCREEN_RINGING      0x004u   /*!<alarm ringing on the second row*/
+#define SCREEN_STOPWATCH    0x008u   /*!<the stopwatch owns the second row*/
+#define SCREEN_BIG          0x010u   /*!<hours and minutes with big digits on both rows*/
+#define SCREEN_PAGE_TIME    0x020u   /*!<menu page of the time and the offset from UTC*/
+#define SCREEN_PAGE_DATE    0x040u   /*!<menu page of the date and the day of the year*/
+#define SCREEN_PAGE_ALARMS  0x080u   /*!<menu page of one alarm of the table*/
+#define SCREEN_PAGE_TEMP    0x100u   /*!<menu page of the temperature with its min and max*/
+#define SCREEN_PAGE_DIAG    0x200u   /*!<menu page of the CAN state and the contrast*/
+#define SCREEN_DATE         0x00Fu   /*!<screens with the date on the first row*/
 /**
- * @brief LCD-state machine states.
- *
- * This enumeration represents the various types of states of the machine
+  @} */
+
+/**
+ * @brief  Formatter of a field, writes exactly the width of the field on text
  */
-typedef enum
-/* cppcheck-suppress misra-c2012-2.4 ; enum is used on state machine */
-{
-    IDLE = 0U,
-    PRINTH_MONTH,
-    PRINTH_DAY,
-    PRINTH_YEAR,
-    PRINTH_WDAY,
-    CHECK_ALARM,
-    CHECK_BUTTON,
-    PRINT_A,
-    PRINTH_HOUR,
-    PRINTH_MINUTES,
-    PRINTH_SECONDS,
-    PRINT_ALARM_STATUS,
-    PRINT_ALARM_OFF,
-    PRINT_ALARM_ON,
-    PRINT_ALARM,
-    BUZZER_STATE,
-    FLAG_STATE,
-    COUNTER_STATE
-}States_LCD;
+typedef void (*Display_FormatTypeDef)( char *text );
+
+/**
+ * @brief  Field of the layout of the lcd
+ */
+typedef struct _Display_FieldTypeDef
+{
+    uint8_t row;                    /*!< FIRST_ROW or SECOND_ROW */
+    uint8_t col;                    /*!< Column of the first character */
+    uint8_t width;                  /*!< Number of characters */
+    uint16_t screens;               /*!< Mask of the screens that show the field, values of @ref Screens */
+    Display_FormatTypeDef format;   /*!< Formatter of the field, NULL for a fixed text */
+    const char *text;               /*!< Fixed text when there is no formatter */
+} Display_FieldTypeDef;
 
 /** 
   * @defgroup Alarm state defines .
   @{ */
 #define ONE_MINUTE          60u      /*!<value for counter to 60 seconds*/    
-#define EVEN_SECONDS        2u       /*!<value for use for even numbers*/
+#define CRESCENDO_SECONDS   6u       /*!<seconds of the alarm on each volume of the buzzer*/
 /**
   @} */
 
 /** 
-  * @defgroup ascii number .
+  * @defgroup Button owners, the release and the gestures of the button go to the one that took the press.
   @{ */
-#define ASCII               48u      /*!<value for getting the ascii value of a number*/    
+#define BUTTON_NONE         0u       /*!<no press yet*/
+#define BUTTON_ALARM        1u       /*!<the press stopped the alarm*/
+#define BUTTON_STOPWATCH    2u       /*!<the press went to the stopwatch*/
+#define BUTTON_MENU         3u       /*!<the press went to the menu*/
 /**
   @} */
 
 /** 
-  * @defgroup PWM defines .
+  * @defgroup Big_digits values of the big digits mode, each digit is 3 columns on both rows.
   @{ */
-#define PERIOD_1KHZ             3200     /*!<value for counter to 60 seconds*/    
-#define PREESCALER_1KHZ         10      /*!<value for counter to 60 seconds*/
-#define PWM_50                  500     /*!<value for 50% of pwm*/
-#define PWM_0                   0       /*!<value for 0% of pwm*/
+#define BIG_DIGIT_COLS      3u       /*!<columns of one big digit*/
+#define BIG_COLON           0xA5u    /*!<middle dot of the character ROM*/
+#define BIG_FULL            0xFFu    /*!<full block of the character ROM*/
+#define GLYPH_LT            0u       /*!<left top corner*/
+#define GLYPH_UB            1u       /*!<upper bar*/
+#define GLYPH_RT            2u       /*!<right top corner*/
+#define GLYPH_LL            3u       /*!<left lower corner*/
+#define GLYPH_LB            4u       /*!<lower bar*/
+#define GLYPH_LR            5u       /*!<right lower corner*/
+#define GLYPH_UMB           6u       /*!<upper and middle bars*/
+#define GLYPH_LMB           7u       /*!<middle and lower bars*/
 /**
   @} */
+
 /** 
-  * @defgroup PWM for lcd configuration values
+  * @defgroup Menu_formats values of the formatters of the menu pages.
   @{ */
-#define PREESCALER      320    /*!< Preescaler to get 1000hz*/
-#define PERIOD          100    /*!< Period to get 1000 hz*/
+#define MINUTES_PER_HOUR    60u      /*!<minutes of one hour, the offset from UTC is in minutes*/
 /**
   @} */
 
@@ -69,6 +96,7 @@ typedef enum
   */
 #define CERO        0u    /*!< Value for counter: 0 */
 #define ONE         1u    /*!< Value for counter: 1 */
+#define TWO         2u    /*!< Value for counter: 2 */
 #define THREE       3u    /*!< Value for counter: 3 */
 #define FOUR        4u    /*!< Value for counter: 4 */
 #define FIVE        5u    /*!< Value for counter: 5 */
@@ -78,7 +106,11 @@ typedef enum
 #define NINE        9u    /*!< Value for counter: 9 */
 #define TEN         10u   /*!< Value for counter: 10 */
 #define ELEVEN      11u   /*!< Value for counter: 11 */
-#define THIRTEEN    13u  /*!< Value for counter: 13 */
+#define TWELVE      12u   /*!< Value for counter: 12 */
+#define THIRTEEN    13u   /*!< Value for counter: 13 */
+#define FOURTEEN    14u   /*!< Value for counter: 14 */
+#define FIFTEEN     15u   /*!< Value for counter: 15 */
+#define SIXTEEN     16u   /*!< Value for counter: 16 */
 /**
   * @}
   */
@@ -94,9 +126,14 @@ LCD_HandleTypeDef LCDHandle;
 static APP_MsgTypeDef clock_display;
 
 /**
-* @brief  Variable for button state
+ * @brief  Calendar fields of the last second of the RTC, in BCD
+ */
+static HIL_TIME_BcdTypeDef display_bcd;
+
+/**
+* @brief  Owner of the press of the button, one of @ref Button
 */
-uint8_t button;
+static uint8_t button_owner;
 
 /**
 * @brief  Variable for button turning off the alarm
@@ -104,27 +141,218 @@ uint8_t button;
 static uint8_t button_flag;
 
 /**
- * @brief  Variable for tim used by the pwm
+* @brief  Deferred work posted with the events of the button
+*/
+static uint8_t button_work;
+
+/**
+* @brief  Deferred work and subscription of the change events of the pots, contrast sent
+*         to the lcd and configured by CAN when it was sent, and a contrast the lcd queue
+*         had no room for
+*/
+static uint8_t analog_work;
+static uint8_t analog_subscription;
+static uint8_t display_contrast = UINT8_MAX;
+static uint8_t display_config_contrast;
+static uint8_t display_contrast_pending = FALSE;
+
+/**
+ * @brief  Temperature shown, read once per refresh, and its min and max since the last reset
+ */
+static uint8_t display_temperature;
+static int16_t display_tenths;
+static uint8_t display_temp_min = UINT8_MAX;
+static uint8_t display_temp_max = CERO;
+
+/**
+ * @brief  Data of the menu pages, only read when its page is shown
+ */
+static HIL_TIME_TmTypeDef display_tm;
+static APP_AlarmTypeDef display_alarm;
+static CAN_HealthTypeDef display_can;
+
+static void Display_Refresh( void );
+static void Display_ButtonWork( void );
+static void Display_AnalogWork( void );
+static void Display_Contrast( void );
+static uint8_t Display_Button( const BUTTON_EventTypeDef *event );
+static uint16_t Display_Screen( void );
+static void Display_Ringing( void );
+static void Display_Render( uint16_t screen );
+static void Display_TwoDigits( char *text, uint8_t value );
+static void Display_ThreeDigits( char *text, uint16_t value );
+static void Format_Month( char *text );
+static void Format_Day( char *text );
+static void Format_Year( char *text );
+static void Format_Wday( char *text );
+static void Format_AlarmMark( char *text );
+static void Format_Time( char *text );
+static void Format_Temperature( char *text );
+static void Format_TempTenths( char *text );
+static void Format_UtcOffset( char *text );
+static void Format_YearDay( char *text );
+static void Format_AlarmSlot( char *text );
+static void Format_AlarmEnable( char *text );
+static void Format_AlarmTime( char *text );
+static void Format_AlarmDays( char *text );
+static void Format_TempMin( char *text );
+static void Format_TempMax( char *text );
+static void Format_CanState( char *text );
+static void Format_CanTec( char *text );
+static void Format_CanRec( char *text );
+static void Format_Contrast( char *text );
+static void Format_BigTop( char *text );
+static void Format_BigBottom( char *text );
+static void Format_Seconds( char *text );
+static void Display_BigRow( char *text, uint8_t half );
+
+/**
+ * @brief  Layout of the lcd, the date on the first row is on the clock, ringing and stopwatch
+ *         screens, the big digits and the pages of the menu take both rows
+ *
+ *   " JAN,01 2000 MO "
+ *   "A  12:30:45 25C "   clock
+ *   "    ALARM!!!    "   ringing
+ *   "## ##.## ##    A"   big digits, 2 rows
+ *   "## ##.## ##   45"
+ *   "TIME   UTC+01:00"   time page
+ *   "    12:30:45    "
+ *   "DATE    DAY 031 "   date page
+ *   " 2024-JAN-31 MO "
+ *   "ALARM 1      ON "   alarms page
+ *   "07:00 MTWTF--   "
+ *   "TEMP   25.3C    "   temperature page
+ *   "MIN 20C  MAX 27C"
+ *   "CAN ACTV TEC 000"   diagnostics page
+ *   "REC 000 CONTR PT"
+ */
+static const Display_FieldTypeDef Layout[] =
+{
+    { FIRST_ROW,  CERO,     ONE,     SCREEN_DATE,       NULL,               " " },
+    { FIRST_ROW,  ONE,      THREE,   SCREEN_DATE,       Format_Month,       NULL },
+    { FIRST_ROW,  FOUR,     ONE,     SCREEN_DATE,       NULL,               "," },
+    { FIRST_ROW,  FIVE,     TWO,     SCREEN_DATE,       Format_Day,         NULL },
+    { FIRST_ROW,  SEVEN,    ONE,     SCREEN_DATE,       NULL,               " " },
+    { FIRST_ROW,  EIGHT,    FOUR,    SCREEN_DATE,       Format_Year,        NULL },
+    { FIRST_ROW,  TWELVE,   ONE,     SCREEN_DATE,       NULL,               " " },
+    { FIRST_ROW,  THIRTEEN, THREE,   SCREEN_DATE,       Format_Wday,        NULL },
+    { SECOND_ROW, CERO,     ONE,     SCREEN_CLOCK,      Format_AlarmMark,   NULL },
+    { SECOND_ROW, ONE,      TWO,     SCREEN_CLOCK,      NULL,               "  " },
+    { SECOND_ROW, THREE,    EIGHT,   SCREEN_CLOCK,      Format_Time,        NULL },
+    { SECOND_ROW, ELEVEN,   ONE,     SCREEN_CLOCK,      NULL,               " " },
+    { SECOND_ROW, TWELVE,   TWO,     SCREEN_CLOCK,      Format_Temperature, NULL },
+    { SECOND_ROW, FOURTEEN, TWO,     SCREEN_CLOCK,      NULL,               "C " },
+    { SECOND_ROW, CERO,     SIXTEEN, SCREEN_RINGING,    NULL,               "    ALARM!!!    " },
+    { FIRST_ROW,  CERO,     THIRTEEN,SCREEN_BIG,        Format_BigTop,      NULL },
+    { FIRST_ROW,  THIRTEEN, TWO,     SCREEN_BIG,        NULL,               "  " },
+    { FIRST_ROW,  FIFTEEN,  ONE,     SCREEN_BIG,        Format_AlarmMark,   NULL },
+    { SECOND_ROW, CERO,     THIRTEEN,SCREEN_BIG,        Format_BigBottom,   NULL },
+    { SECOND_ROW, THIRTEEN, ONE,     SCREEN_BIG,        NULL,               " " },
+    { SECOND_ROW, FOURTEEN, TWO,     SCREEN_BIG,        Format_Seconds,     NULL },
+    { FIRST_ROW,  CERO,     TEN,     SCREEN_PAGE_TIME,  NULL,               "TIME   UTC" },
+    { FIRST_ROW,  TEN,      SIX,     SCREEN_PAGE_TIME,  Format_UtcOffset,   NULL },
+    { SECOND_ROW, CERO,     FOUR,    SCREEN_PAGE_TIME,  NULL,               "    " },
+    { SECOND_ROW, FOUR,     EIGHT,   SCREEN_PAGE_TIME,  Format_Time,        NULL },
+    { SECOND_ROW, TWELVE,   FOUR,    SCREEN_PAGE_TIME,  NULL,               "    " },
+    { FIRST_ROW,  CERO,     TWELVE,  SCREEN_PAGE_DATE,  NULL,               "DATE    DAY " },
+    { FIRST_ROW,  TWELVE,   THREE,   SCREEN_PAGE_DATE,  Format_YearDay,     NULL },
+    { FIRST_ROW,  FIFTEEN,  ONE,     SCREEN_PAGE_DATE,  NULL,               " " },
+    { SECOND_ROW, CERO,     ONE,     SCREEN_PAGE_DATE,  NULL,               " " },
+    { SECOND_ROW, ONE,      FOUR,    SCREEN_PAGE_DATE,  Format_Year,        NULL },
+    { SECOND_ROW, FIVE,     ONE,     SCREEN_PAGE_DATE,  NULL,               "-" },
+    { SECOND_ROW, SIX,      THREE,   SCREEN_PAGE_DATE,  Format_Month,       NULL },
+    { SECOND_ROW, NINE,     ONE,     SCREEN_PAGE_DATE,  NULL,               "-" },
+    { SECOND_ROW, TEN,      TWO,     SCREEN_PAGE_DATE,  Format_Day,         NULL },
+    { SECOND_ROW, TWELVE,   ONE,     SCREEN_PAGE_DATE,  NULL,               " " },
+    { SECOND_ROW, THIRTEEN, THREE,   SCREEN_PAGE_DATE,  Format_Wday,        NULL },
+    { FIRST_ROW,  CERO,     SIX,     SCREEN_PAGE_ALARMS,NULL,               "ALARM " },
+    { FIRST_ROW,  SIX,      ONE,     SCREEN_PAGE_ALARMS,Format_AlarmSlot,   NULL },
+    { FIRST_ROW,  SEVEN,    SIX,     SCREEN_PAGE_ALARMS,NULL,               "      " },
+    { FIRST_ROW,  THIRTEEN, THREE,   SCREEN_PAGE_ALARMS,Format_AlarmEnable, NULL },
+    { SECOND_ROW, CERO,     FIVE,    SCREEN_PAGE_ALARMS,Format_AlarmTime,   NULL },
+    { SECOND_ROW, FIVE,     ONE,     SCREEN_PAGE_ALARMS,NULL,               " " },
+    { SECOND_ROW, SIX,      SEVEN,   SCREEN_PAGE_ALARMS,Format_AlarmDays,   NULL },
+    { SECOND_ROW, THIRTEEN, THREE,   SCREEN_PAGE_ALARMS,NULL,               "   " },
+    { FIRST_ROW,  CERO,     SIX,     SCREEN_PAGE_TEMP,  NULL,               "TEMP  " },
+    { FIRST_ROW,  SIX,      FIVE,    SCREEN_PAGE_TEMP,  Format_TempTenths,  NULL },
+    { FIRST_ROW,  ELEVEN,   FIVE,    SCREEN_PAGE_TEMP,  NULL,               "C    " },
+    { SECOND_ROW, CERO,     FOUR,    SCREEN_PAGE_TEMP,  NULL,               "MIN " },
+    { SECOND_ROW, FOUR,     TWO,     SCREEN_PAGE_TEMP,  Format_TempMin,     NULL },
+    { SECOND_ROW, SIX,      SEVEN,   SCREEN_PAGE_TEMP,  NULL,               "C  MAX " },
+    { SECOND_ROW, THIRTEEN, TWO,     SCREEN_PAGE_TEMP,  Format_TempMax,     NULL },
+    { SECOND_ROW, FIFTEEN,  ONE,     SCREEN_PAGE_TEMP,  NULL,               "C" },
+    { FIRST_ROW,  CERO,     FOUR,    SCREEN_PAGE_DIAG,  NULL,               "CAN " },
+    { FIRST_ROW,  FOUR,     FOUR,    SCREEN_PAGE_DIAG,  Format_CanState,    NULL },
+    { FIRST_ROW,  EIGHT,    FIVE,    SCREEN_PAGE_DIAG,  NULL,               " TEC " },
+    { FIRST_ROW,  THIRTEEN, THREE,   SCREEN_PAGE_DIAG,  Format_CanTec,      NULL },
+    { SECOND_ROW, CERO,     FOUR,    SCREEN_PAGE_DIAG,  NULL,               "REC " },
+    { SECOND_ROW, FOUR,     THREE,   SCREEN_PAGE_DIAG,  Format_CanRec,      NULL },
+    { SECOND_ROW, SEVEN,    SEVEN,   SCREEN_PAGE_DIAG,  NULL,               " CONTR " },
+    { SECOND_ROW, FOURTEEN, TWO,     SCREEN_PAGE_DIAG,  Format_Contrast,    NULL },
+};
+
+/**
+ * @brief  Screen of each page of the menu, the home page is the clock
+ */
+static const uint16_t PageScreens[MENU_PAGES] =
+{
+    SCREEN_CLOCK, SCREEN_PAGE_TIME, SCREEN_PAGE_DATE, SCREEN_PAGE_ALARMS, SCREEN_PAGE_TEMP, SCREEN_PAGE_DIAG
+};
+
+/**
+ * @brief  Names of the CAN node states, 4 characters each
  */
-static TIM_HandleTypeDef TimHandle2; 
+static const char CanStates[CAN_HEALTH_RECOVERING + ONE][FOUR] =
+{
+    { 'A', 'C', 'T', 'V' }, { 'W', 'A', 'R', 'N' }, { 'P', 'A', 'S', 'V' }, { 'B', 'O', 'F', 'F' }, { 'R', 'C', 'V', 'R' }
+};
 
-static void month(char *mon,char pos);
-static void week(char *week,char pos);
-static void Display_StMachine(uint8_t LCD_State);
+/**
+ * @brief  Patterns of the custom characters of the big digits, 5 pixels per row
+ */
+static const uint8_t BigGlyphs[HEL_LCD_GLYPHS][HEL_LCD_GLYPH_ROWS] =
+{
+    { 0x07u, 0x0Fu, 0x1Fu, 0x1Fu, 0x1Fu, 0x1Fu, 0x1Fu, 0x1Fu },  /*GLYPH_LT*/
+    { 0x1Fu, 0x1Fu, 0x1Fu, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u },  /*GLYPH_UB*/
+    { 0x1Cu, 0x1Eu, 0x1Fu, 0x1Fu, 0x1Fu, 0x1Fu, 0x1Fu, 0x1Fu },  /*GLYPH_RT*/
+    { 0x1Fu, 0x1Fu, 0x1Fu, 0x1Fu, 0x1Fu, 0x1Fu, 0x0Fu, 0x07u },  /*GLYPH_LL*/
+    { 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x1Fu, 0x1Fu, 0x1Fu },  /*GLYPH_LB*/
+    { 0x1Fu, 0x1Fu, 0x1Fu, 0x1Fu, 0x1Fu, 0x1Fu, 0x1Eu, 0x1Cu },  /*GLYPH_LR*/
+    { 0x1Fu, 0x1Fu, 0x1Fu, 0x00u, 0x00u, 0x00u, 0x1Fu, 0x1Fu },  /*GLYPH_UMB*/
+    { 0x1Fu, 0x00u, 0x00u, 0x00u, 0x00u, 0x1Fu, 0x1Fu, 0x1Fu },  /*GLYPH_LMB*/
+};
+
+/**
+ * @brief  Characters of each big digit, top row and bottom row
+ */
+static const char BigDigits[TEN][TWO][BIG_DIGIT_COLS] =
+{
+    { { HEL_LCD_GLYPH(GLYPH_LT),  HEL_LCD_GLYPH(GLYPH_UB),  HEL_LCD_GLYPH(GLYPH_RT)  }, { HEL_LCD_GLYPH(GLYPH_LL),  HEL_LCD_GLYPH(GLYPH_LB),  HEL_LCD_GLYPH(GLYPH_LR)  } },
+    { { HEL_LCD_GLYPH(GLYPH_UB),  HEL_LCD_GLYPH(GLYPH_RT),  ' '                      }, { HEL_LCD_GLYPH(GLYPH_LB),  (char)BIG_FULL,           HEL_LCD_GLYPH(GLYPH_LB)  } },
+    { { HEL_LCD_GLYPH(GLYPH_UMB), HEL_LCD_GLYPH(GLYPH_UMB), HEL_LCD_GLYPH(GLYPH_RT)  }, { HEL_LCD_GLYPH(GLYPH_LL),  HEL_LCD_GLYPH(GLYPH_LMB), HEL_LCD_GLYPH(GLYPH_LMB) } },
+    { { HEL_LCD_GLYPH(GLYPH_UMB), HEL_LCD_GLYPH(GLYPH_UMB), HEL_LCD_GLYPH(GLYPH_RT)  }, { HEL_LCD_GLYPH(GLYPH_LMB), HEL_LCD_GLYPH(GLYPH_LMB), HEL_LCD_GLYPH(GLYPH_LR)  } },
+    { { HEL_LCD_GLYPH(GLYPH_LL),  HEL_LCD_GLYPH(GLYPH_LB),  (char)BIG_FULL           }, { ' ',                      ' ',                      (char)BIG_FULL           } },
+    { { HEL_LCD_GLYPH(GLYPH_LL),  HEL_LCD_GLYPH(GLYPH_UMB), HEL_LCD_GLYPH(GLYPH_UMB) }, { HEL_LCD_GLYPH(GLYPH_LMB), HEL_LCD_GLYPH(GLYPH_LMB), HEL_LCD_GLYPH(GLYPH_LR)  } },
+    { { HEL_LCD_GLYPH(GLYPH_LT),  HEL_LCD_GLYPH(GLYPH_UMB), HEL_LCD_GLYPH(GLYPH_UMB) }, { HEL_LCD_GLYPH(GLYPH_LL),  HEL_LCD_GLYPH(GLYPH_LMB), HEL_LCD_GLYPH(GLYPH_LR)  } },
+    { { HEL_LCD_GLYPH(GLYPH_UB),  HEL_LCD_GLYPH(GLYPH_UB),  HEL_LCD_GLYPH(GLYPH_RT)  }, { ' ',                      ' ',                      (char)BIG_FULL           } },
+    { { HEL_LCD_GLYPH(GLYPH_LT),  HEL_LCD_GLYPH(GLYPH_UMB), HEL_LCD_GLYPH(GLYPH_RT)  }, { HEL_LCD_GLYPH(GLYPH_LL),  HEL_LCD_GLYPH(GLYPH_LMB), HEL_LCD_GLYPH(GLYPH_LR)  } },
+    { { HEL_LCD_GLYPH(GLYPH_LT),  HEL_LCD_GLYPH(GLYPH_UMB), HEL_LCD_GLYPH(GLYPH_RT)  }, { ' ',                      ' ',                      (char)BIG_FULL           } },
+};
 
 /**
- * @brief  Variable for the pwm timer
+ * @brief  TRUE to show the time with big digits instead of the date and the small time
  */
-static TIM_HandleTypeDef TimHandle;    
+static uint8_t big_digits;
       
 /**
  * @brief   **This function intiates the LCD and the SPI **
  *
  *  The Function sets the pins for the SPI and LCD  needed and initialize by 
  *  calling the HEL_LCD_MspInit and configuring  and initializing the SPI
- *  then calls the function HEL_LCD_Init wich is a routine for the LCD.
- *  this function also eneables the pin 7 of the gpio B wich is a button
- *  and eneables the interrupt of the button on falling and rising.
+ *  and the TIM7 that waits the execution time of the lcd commands,
+ *  then calls the function HEL_LCD_Init wich queues the routine for the LCD.
+ *  this function also starts the button with the deferred work of the scheduler
+ *  that takes its events and drives the menu.
  *  it also eneables a pwm that is conected to a buzzer 
  *  the calculations for the pwm are:
  *  PWM frequency = (timer clock / (Prescaler * Period + 1))
@@ -133,20 +361,24 @@ static TIM_HandleTypeDef TimHandle;
 void Display_Init( void )
 {
     static SPI_HandleTypeDef SpiHandle;
-    TIM_OC_InitTypeDef sConfig;
-    GPIO_InitTypeDef GPIO_InitStruct;
+    static TIM_HandleTypeDef TimLcd;
+    uint32_t TimerClock = HAL_RCC_GetPCLK1Freq();
 
-    __HAL_RCC_GPIOB_CLK_ENABLE();
+    if( (RCC->CFGR & RCC_CFGR_PPRE) != RCC_HCLK_DIV1 )
+    {
+        TimerClock *= 2u;
+    }
 
-    GPIO_InitStruct.Pin = GPIO_PIN_7;               /*pin to set as output*/
-    GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING_FALLING;     /*input on mode faling edge interrupt*/
-    GPIO_InitStruct.Pull = GPIO_NOPULL;             /*no pull-up niether pull-down*/
-    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;    /*pin speed*/
-    
-    HAL_GPIO_Init( GPIOB, &GPIO_InitStruct );
-    
-    HAL_NVIC_SetPriority( EXTI4_15_IRQn, 2, 0 );
-    HAL_NVIC_EnableIRQ( EXTI4_15_IRQn );
+    Menu_Init();
+    button_work = HIL_SCHEDULER_RegisterWork( &sched, Display_ButtonWork );
+    assert_error( button_work != FALSE, SCHEDULER_ERROR );    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+    Button_Init( button_work );
+    analog_work = HIL_SCHEDULER_RegisterWork( &sched, Display_AnalogWork );
+    assert_error( analog_work != FALSE, SCHEDULER_ERROR );    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+    analog_subscription = Analogs_Subscribe( ANALOGS_INPUT_INTENSITY | ANALOGS_INPUT_CONTRAST, analog_work );
+    assert_error( analog_subscription != FALSE, SCHEDULER_ERROR );    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+    /*the first event of the pots sends the contrast, configured or not*/
+    display_config_contrast = Config_Get()->contrast;
     
     LCDHandle.SpiHandler  =   &SpiHandle;
     /*Reset pin configuration*/
@@ -164,7 +396,8 @@ void Display_Init( void )
 
     LCDHandle.SpiHandler->Instance            = SPI1;
     LCDHandle.SpiHandler->Init.Mode           = SPI_MODE_MASTER;
-    LCDHandle.SpiHandler->Init.BaudRatePrescaler = SPI_BAUDRATEPRESCALER_16;
+    /*32MHz / 128 = 250kHz, one byte every 32us, the lcd needs 26.3us to execute each one*/
+    LCDHandle.SpiHandler->Init.BaudRatePrescaler = SPI_BAUDRATEPRESCALER_128;
     LCDHandle.SpiHandler->Init.Direction      = SPI_DIRECTION_2LINES;
     LCDHandle.SpiHandler->Init.CLKPhase       = SPI_PHASE_2EDGE;
     LCDHandle.SpiHandler->Init.CLKPolarity    = SPI_POLARITY_HIGH;
@@ -175,406 +408,715 @@ void Display_Init( void )
     LCDHandle.SpiHandler->Init.TIMode         = SPI_TIMODE_DISABLED;
     Status = HAL_SPI_Init( LCDHandle.SpiHandler );
     assert_error( Status == HAL_OK, SPI_INIT_ERROR );       /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+
+    /*TIM7 waits the execution time of the lcd commands, 10us per tick*/
+    __HAL_RCC_TIM7_CLK_ENABLE();
+    LCDHandle.TimHandler                    = &TimLcd;
+    LCDHandle.TimHandler->Instance          = TIM7;
+    LCDHandle.TimHandler->Init.Prescaler    = (TimerClock / HEL_LCD_TICK_HZ) - 1u;
+    LCDHandle.TimHandler->Init.Period       = 0xFFFFu;
+    LCDHandle.TimHandler->Init.CounterMode  = TIM_COUNTERMODE_UP;
+    Status = HAL_TIM_OnePulse_Init( LCDHandle.TimHandler, TIM_OPMODE_SINGLE );
+    assert_error( Status == HAL_OK, SPI_INIT_ERROR );       /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+    __HAL_TIM_URS_ENABLE( LCDHandle.TimHandler );
+    __HAL_TIM_ENABLE_IT( LCDHandle.TimHandler, TIM_IT_UPDATE );
+    HAL_NVIC_SetPriority( TIM7_LPTIM2_IRQn, 2, 0 );
+    HAL_NVIC_EnableIRQ( TIM7_LPTIM2_IRQn );
+
     Status = HEL_LCD_Init(&LCDHandle );
     assert_error( Status == HAL_OK, SPI_COMMAND_ERROR );        /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
 
-     /* Configuramos el timer TIM1 para generar un periodo de 1ms */
-    TimHandle.Instance = TIM14;
-    TimHandle.Init.Prescaler     = PREESCALER_1KHZ;
-    TimHandle.Init.Period        = PERIOD_1KHZ;
-    TimHandle.Init.CounterMode   = TIM_COUNTERMODE_UP;
-    HAL_TIM_PWM_Init(&TimHandle);
-
-    /* Configuramos canal para generar una señal PWM con polaridad en alto */
-    sConfig.OCMode     = TIM_OCMODE_PWM1;
-    sConfig.OCPolarity = TIM_OCPOLARITY_HIGH;
-    sConfig.OCFastMode = TIM_OCFAST_DISABLE;
-    sConfig.Pulse = CERO;
-    HAL_TIM_PWM_ConfigChannel( &TimHandle, &sConfig, TIM_CHANNEL_1 );
-    HAL_TIM_PWM_Start( &TimHandle, TIM_CHANNEL_1 );
+    Buzzer_Init();
 
     __TIM4_CLK_ENABLE(); 
 
-    TimHandle2.Instance = TIM3;
-    TimHandle2.Init.Prescaler     = PREESCALER;
-    TimHandle2.Init.Period        = PERIOD;
-    TimHandle2.Init.CounterMode   = TIM_COUNTERMODE_UP;
-    HAL_TIM_PWM_Init(&TimHandle2);
-    
-    sConfig.OCMode     = TIM_OCMODE_PWM1;
-    sConfig.OCPolarity = TIM_OCPOLARITY_HIGH;
-    sConfig.OCFastMode = TIM_OCFAST_DISABLE;
-
-    HAL_TIM_PWM_ConfigChannel( &TimHandle2, &sConfig, TIM_CHANNEL_1 );
-    HAL_TIM_PWM_Start( &TimHandle2, TIM_CHANNEL_1 );
+    Backlight_Init();
 }
 
 
 /**
-* @brief   **This function executes the display state machine**
+* @brief   **This function refreshes the display**
 *
-* This functions executes the state machine of the display task
-* every 100ms, we do this because a circular buffer has been implemented on the serial and clock
-* task, this means that we do need to execute every time the task since now the 
-* information is being stored, the function waits for the circular buffer to geet data
-* and then reads the msg and checks if its DISPLAY_MESSAGE and calls the function  Display_StMachine.   
+* This functions executes the display task every 100ms, the clock task sends a
+* DISPLAY_MESSAGE each time the time changes, the function reads all the messages on
+* the circular buffer and renders the screen once for each one, the whole screen is
+* evaluated on one call. Then the menu checks the times of its presses. The render only
+* writes on the framebuffer of the lcd, at the end the characters that changed are sent.
 *
-*/void Display_Task( void )
+*/
+void Display_Task( void )
 {
     while( HIL_QUEUE_IsEmptyISR(&CLOCK_queue,SPI1_IRQn) == NOT_EMPTY )
     {
         /*Read the first message*/
         (void)HIL_QUEUE_ReadISR(&CLOCK_queue,&clock_display,SPI1_IRQn);
-        Display_StMachine(clock_display.msg);
+        if( clock_display.msg == DISPLAY_MESSAGE )
+        {
+            /*the alarm counts the seconds, so it only runs with the messages of the clock*/
+            if( clock_display.S_alarm == ALARM_ACTIVE )
+            {
+                Display_Ringing();
+            }
+            Display_Refresh();
+        }
     }
+
+    Display_ButtonWork();
 }
 
 /**
-* @brief   **Display a message recived by clock_display on the LCD **
+* @brief   **This function runs the events of the button and sends the changes of the lcd**
 *
-*   this function starts by displaying the date on the first row of the lcd
-*   the data show by the lcd is read through the circular buffer on the display task function
-*   alse when data is going to be display we add 48 to get the correct ascii character,
-*   once the first row is displayed we check if the alarm is not actived, if its not active
-*   then we need to check if the button its not pressed, we checked if an alarm has been set, 
-*   if it has been set we print an A on the lcd if not then we print nothing, then we print the time
-*   like we did with the date, if the button was pressed then instead of printing the time on the second row
-*   we print if an alarm has been set or the time of the alarm that has been set.
-*   And if the alarm is actived we print alarm!!! and set the pwm to 800 wich is 50% of the pwm to make a sound
-*   and since this function is called every second we add a counter to see how long the alarm is going to run
-*   and on even numbers we turned off the pwm and odd numbers we turn on the pwm.
-*   the alarm part of the function will run till the counter gets to 60 seconds or the flag value is changed
-*   to true that can be done with the button or by sending a message in CAN, and when the alarm is turned off
-*   we change the value of the alarm state to OFF, reset the counter value and the alarm flag.
-* @retval  None 
-*/
-void Display_StMachine(uint8_t LCD_State)
-{
-    static char fila_2[] = "00:00:00     ";  /* cppcheck-suppress misra-c2012-7.4 ; string need to be modify*/
-    static char fila_1[] =" XXX,XX XXXX XX ";   /* cppcheck-suppress misra-c2012-7.4 ; string need to be modify*/
-    static uint8_t alarm_counter = FALSE;
-    static uint8_t Alarm_Flag;
-    static uint8_t temperature;
-    Alarm_Flag = clock_display.F_alarm;
-    
-    switch(LCD_State)
-    {
-        case IDLE:
-        break;
+*   It is the deferred work posted with each event of the button, so an event is used
+*   right after its interrupt on the scheduler loop and not on the next period of the
+*   task, the display task also calls it for the timeout of the menu. The screen is
+*   rendered again only if the page or its data changed, all the writes of the lcd are
+*   done at task level so they never interleave.
+*/
+static void Display_ButtonWork( void )
+{
+    BUTTON_EventTypeDef event;
+    uint8_t redraw = Menu_Task();
 
-        case PRINTH_MONTH:
-            month(&fila_1[ONE],clock_display.tm.tm_mon);
-            clock_display.msg=PRINTH_DAY;
-            (void)HIL_QUEUE_WriteISR( &CLOCK_queue, &clock_display,SPI1_IRQn);
-        break;
+    while( Button_GetEvent( &event ) == TRUE )
+    {
+        Backlight_Activity();
+        redraw |= Display_Button( &event );
+    }
 
-        case PRINTH_DAY:
-            fila_1[FIVE] = ((clock_display.tm.tm_mday / TEN) + ASCII);
-            fila_1[SIX] = ((clock_display.tm.tm_mday % TEN) + ASCII);
-            clock_display.msg =  PRINTH_YEAR;
-            (void)HIL_QUEUE_WriteISR( &CLOCK_queue, &clock_display,SPI1_IRQn);
-        break;
+    if( redraw == TRUE )
+    {
+        Display_Refresh();
+    }
 
-        case PRINTH_YEAR:
-            fila_1[EIGHT]   = ( (clock_display.tm.tm_year_msb / TEN) + ASCII);
-            fila_1[NINE]   = ( (clock_display.tm.tm_year_msb % TEN) + ASCII);
-            fila_1[TEN]  = ( (clock_display.tm.tm_year_lsb / TEN) + ASCII);
-            fila_1[ELEVEN]  = ( (clock_display.tm.tm_year_lsb % TEN) + ASCII);
-            clock_display.msg = PRINTH_WDAY;
-            (void)HIL_QUEUE_WriteISR( &CLOCK_queue, &clock_display,SPI1_IRQn);
-        break;
+    Status = HEL_LCD_Flush(&LCDHandle);
+    assert_error( Status == HAL_OK, SPI_STRING_ERROR ); /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+}
 
-        case PRINTH_WDAY:
-            Status = HEL_LCD_SetCursor(&LCDHandle,FIRST_ROW,CERO);
-            assert_error( Status == HAL_OK, SPI_SET_CURSOR_ERROR ); /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-            week(&fila_1[THIRTEEN],clock_display.tm.tm_wday);
-            Status = HEL_LCD_String(&LCDHandle, fila_1);
-            assert_error( Status == HAL_OK, SPI_STRING_ERROR ); /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-            clock_display.msg = CHECK_ALARM;
-            (void)HIL_QUEUE_WriteISR( &CLOCK_queue, &clock_display,SPI1_IRQn);
-        break;
+/**
+* @brief   **This function gives an event of the button to its owner**
+*
+*   A press while the alarm rings stops it, while the stopwatch is active the press
+*   goes to the stopwatch with its age so the count takes the time of the first edge,
+*   and the rest of the time it goes to the menu. The release and the gestures that
+*   follow go to the owner of the press.
+*
+* @param   event[in]  event of the button
+*
+* @retval  TRUE if the menu changed and the lcd has to be redrawn, otherwise FALSE
+*/
+static uint8_t Display_Button( const BUTTON_EventTypeDef *event )
+{
+    uint8_t redraw = FALSE;
 
-        case CHECK_ALARM:
-            if(clock_display.S_alarm != ALARM_ACTIVE)
+    switch( event->event )
+    {
+        case BUTTON_EVENT_PRESS:
+            if( clock_display.S_alarm == ALARM_ACTIVE )
+            {
+                button_flag  = TRUE;
+                button_owner = BUTTON_ALARM;
+            }
+            else if( Stopwatch_IsActive() == TRUE )
             {
-                clock_display.msg = CHECK_BUTTON;
-                (void)HIL_QUEUE_WriteISR( &CLOCK_queue, &clock_display,SPI1_IRQn);
+                Stopwatch_Button( TRUE, HAL_GetTick() - event->tick );
+                button_owner = BUTTON_STOPWATCH;
             }
             else
             {
-                clock_display.msg = PRINT_ALARM;
-                (void)HIL_QUEUE_WriteISR( &CLOCK_queue, &clock_display,SPI1_IRQn);
+                button_owner = BUTTON_MENU;
             }
         break;
 
-        case CHECK_BUTTON:
-            if (button == FALSE) 
+        case BUTTON_EVENT_RELEASE:
+            if( button_owner == BUTTON_STOPWATCH )
             {
-                clock_display.msg = PRINT_A;
-                (void)HIL_QUEUE_WriteISR( &CLOCK_queue, &clock_display,SPI1_IRQn);
-            }
-            else
-            {
-                clock_display.msg = PRINT_ALARM_STATUS;
-                (void)HIL_QUEUE_WriteISR( &CLOCK_queue, &clock_display,SPI1_IRQn);
+                Stopwatch_Button( FALSE, HAL_GetTick() - event->tick );
             }
         break;
 
-        case PRINT_A:
-            if(clock_display.S_alarm == ALARM_ON)  
+        default:
+            if( button_owner == BUTTON_MENU )
             {
-                Status = HEL_LCD_SetCursor(&LCDHandle,SECOND_ROW,CERO );
-                assert_error( Status == HAL_OK, SPI_SET_CURSOR_ERROR ); /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-                Status = HEL_LCD_Data( &LCDHandle, 'A' );
-                assert_error( Status == HAL_OK, SPI_STRING_ERROR );     /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-            } 
-            fila_2[FIVE] =':';
-            clock_display.msg = PRINTH_HOUR;
-            (void)HIL_QUEUE_WriteISR( &CLOCK_queue, &clock_display,SPI1_IRQn);
+                redraw = Menu_Gesture( event->event );
+            }
         break;
+    }
 
-        case PRINTH_HOUR:
-            Status = HEL_LCD_SetCursor(&LCDHandle,SECOND_ROW,THREE);
-            assert_error( Status == HAL_OK, SPI_SET_CURSOR_ERROR ); /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-            fila_2[CERO] = ((clock_display.tm.tm_hour / TEN) + ASCII);
-            fila_2[ONE] = ((clock_display.tm.tm_hour % TEN) + ASCII);
-            clock_display.msg = PRINTH_MINUTES;
-            (void)HIL_QUEUE_WriteISR( &CLOCK_queue, &clock_display,SPI1_IRQn);
-        break;
+    return redraw;
+}
 
-        case PRINTH_MINUTES:
-            fila_2[THREE] = ((clock_display.tm.tm_min / TEN) + ASCII);
-            fila_2[FOUR] = ((clock_display.tm.tm_min % TEN) + ASCII);
-            clock_display.msg = PRINTH_SECONDS;
-            (void)HIL_QUEUE_WriteISR( &CLOCK_queue, &clock_display,SPI1_IRQn);
-        break;
-        
-        case PRINTH_SECONDS:
-            fila_2[SIX] = ((clock_display.tm.tm_sec / TEN) + ASCII);
-            fila_2[SEVEN] = ((clock_display.tm.tm_sec % TEN) + ASCII);
-            temperature = Analogs_GetTemperature();
-            fila_2[NINE] = ((temperature / TEN) + ASCII);
-            fila_2[TEN] = ((temperature / TEN) + ASCII);
-            fila_2[ELEVEN] = 'C';
-            Status = HEL_LCD_String(&LCDHandle, fila_2);
-            assert_error( Status == HAL_OK, SPI_STRING_ERROR ); /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-            clock_display.msg = IDLE;
-            (void)HIL_QUEUE_WriteISR( &CLOCK_queue, &clock_display,SPI1_IRQn);
+/**
+* @brief   **Display a message recived by clock_display on the LCD **
+*
+*   The calendar of the last second is taken in BCD from the clock and the temperature
+*   is read, then the screen to show is chosen, the data of a page of the menu is only
+*   read when that page is shown, and all the fields of the screen are rendered.
+*/
+static void Display_Refresh( void )
+{
+    HIL_TIME_EpochTypeDef now;
+    uint16_t screen;
+
+    (void)Clock_GetCalendar( &display_bcd );
+    display_tenths = Analogs_GetTemperature();
+    display_temperature = (display_tenths < 0) ? 0u : (uint8_t)(((uint16_t)display_tenths + FIVE) / TEN);
+    display_temp_min = (display_temperature < display_temp_min) ? display_temperature : display_temp_min;
+    display_temp_max = (display_temperature > display_temp_max) ? display_temperature : display_temp_max;
+
+    screen = Display_Screen();
+    switch( screen )
+    {
+        case SCREEN_BIG:
+            /*the glyph cache of the driver only uploads them when another set is loaded*/
+            Status = HEL_LCD_LoadGlyphs( &LCDHandle, CERO, BigGlyphs, HEL_LCD_GLYPHS );
+            assert_error( Status != HAL_ERROR, SPI_COMMAND_ERROR ); /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
         break;
-        
-        case PRINT_ALARM_STATUS:
-            if (clock_display.S_alarm == ALARM_OFF)
-            {
-                clock_display.msg = PRINT_ALARM_OFF;
-                (void)HIL_QUEUE_WriteISR( &CLOCK_queue, &clock_display,SPI1_IRQn);
-            }
-            else
-            {
-                clock_display.msg = PRINT_ALARM_ON;
-                (void)HIL_QUEUE_WriteISR( &CLOCK_queue, &clock_display,SPI1_IRQn);
-            }
+
+        case SCREEN_PAGE_DATE:
+            (void)Clock_GetTime( &now );
+            HIL_TIME_FromEpoch( now, &display_tm );
         break;
 
-        case PRINT_ALARM_OFF:
-            Status = HEL_LCD_SetCursor(&LCDHandle,SECOND_ROW,CERO );
-            assert_error( Status == HAL_OK, SPI_SET_CURSOR_ERROR ); /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-            /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-            Status = HEL_LCD_String(&LCDHandle, "ALARM NO CONFIG");  /* cppcheck-suppress misra-c2012-7.4 ; no need for a constant value */
-            assert_error( Status == HAL_OK, SPI_STRING_ERROR ); /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-            clock_display.msg = IDLE;
-            (void)HIL_QUEUE_WriteISR( &CLOCK_queue, &clock_display,SPI1_IRQn);
+        case SCREEN_PAGE_ALARMS:
+            (void)Alarms_Get( Menu_GetSlot(), &display_alarm );
         break;
 
-        case PRINT_ALARM_ON:
-            fila_2[CERO] = ((clock_display.tm.tm_hour_alarm / TEN) + ASCII);
-            fila_2[ONE] = ((clock_display.tm.tm_hour_alarm % TEN) + ASCII);
-            fila_2[THREE] = ((clock_display.tm.tm_min_alarm / TEN) + ASCII);
-            fila_2[FOUR] = ((clock_display.tm.tm_min_alarm % TEN) + ASCII);
-            fila_2[FIVE] =' ';
-            fila_2[SIX] =' ';
-            Status = HEL_LCD_SetCursor(&LCDHandle,SECOND_ROW,CERO );
-            assert_error( Status == HAL_OK, SPI_SET_CURSOR_ERROR ); /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-            /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-            Status = HEL_LCD_String(&LCDHandle, "   ALARM=");       /* cppcheck-suppress misra-c2012-7.4 ; no need for a constant value */
-            assert_error( Status == HAL_OK, SPI_STRING_ERROR ); /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-            Status = HEL_LCD_String(&LCDHandle, fila_2);
-            assert_error( Status == HAL_OK, SPI_STRING_ERROR ); /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-            clock_display.msg = IDLE;
-            (void)HIL_QUEUE_WriteISR( &CLOCK_queue, &clock_display,SPI1_IRQn);
+        case SCREEN_PAGE_DIAG:
+            CanHealth_GetStats( &display_can );
         break;
 
-        case PRINT_ALARM:
-            alarm_counter++;
-            Status = HEL_LCD_SetCursor(&LCDHandle,SECOND_ROW,CERO );
-            /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-            assert_error( Status == HAL_OK, SPI_SET_CURSOR_ERROR ); 
-            /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-            Status = HEL_LCD_String(&LCDHandle, "    ALARM!!!     ");    /* cppcheck-suppress misra-c2012-7.4 ; no need for a constant value */
-            assert_error( Status == HAL_OK, SPI_STRING_ERROR ); /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-            HEL_LCD_Backlight(&LCDHandle, TOGGLE);
-            clock_display.msg = BUZZER_STATE;
-            (void)HIL_QUEUE_WriteISR( &CLOCK_queue, &clock_display,SPI1_IRQn);
+        default:
         break;
+    }
+    Display_Render( screen );
+}
+
+/**
+* @brief   **This function resets the min and max of the temperature**
+*
+*   Both take the temperature of the next refresh.
+*/
+void Display_ResetTemperature( void )
+{
+    display_temp_min = UINT8_MAX;
+    display_temp_max = CERO;
+}
+
+/**
+* @brief   **This function turns the big digits mode on or off**
+*
+*   The mode is shown on the next refresh, the alarm, the stopwatch and the
+*   pages of the menu still take the lcd like on the normal mode.
+*
+* @param   enable[in]  TRUE to show the time with big digits
+*/
+void Display_SetBigDigits( uint8_t enable )
+{
+    big_digits = enable;
+}
+
+/**
+* @brief   **This function chooses the screen to show**
+*
+*   An alarm ringing goes first, then the stopwatch owns the second row while it is
+*   active, then the page of the menu if it is not the home page and the clock the
+*   rest of the time, with big digits if that mode is on.
+*
+* @retval  Screen to show, one of @ref Screens
+*/
+static uint16_t Display_Screen( void )
+{
+    uint16_t screen;
+
+    if( clock_display.S_alarm == ALARM_ACTIVE )
+    {
+        screen = SCREEN_RINGING;
+    }
+    else if( Stopwatch_IsActive() == TRUE )
+    {
+        screen = SCREEN_STOPWATCH;
+    }
+    else if( Menu_GetPage() != MENU_PAGE_HOME )
+    {
+        screen = PageScreens[Menu_GetPage()];
+    }
+    else if( big_digits == TRUE )
+    {
+        screen = SCREEN_BIG;
+    }
+    else
+    {
+        screen = SCREEN_CLOCK;
+    }
+
+    return screen;
+}
+
+/**
+* @brief   **This function runs the alarm while it is ringing**
+*
+*   Since this function is called every second we add a counter to see how long the
+*   alarm is going to run, on the first second the backlight starts to blink and the melody
+*   of the alarm starts on the buzzer, it plays by itself and here it only gets louder every
+*   6 seconds. The alarm runs till the counter gets
+*   to 60 seconds or it is stopped with the button or by a message in CAN, then the alarm
+*   state is changed to OFF and the clock is told if it can snooze it.
+*/
+static void Display_Ringing( void )
+{
+    static uint8_t alarm_counter = FALSE;
+
+    alarm_counter++;
+    Stopwatch_ShowRow(FALSE);
+
+    if( alarm_counter == 1u )
+    {
+        Backlight_Blink( TRUE );
+        Buzzer_Play( clock_display.alarm_slot, BUZZER_VOLUME_MIN );
+    }
+    else if( (alarm_counter % CRESCENDO_SECONDS) == 0u )
+    {
+        Buzzer_Volume( BUZZER_VOLUME_MIN + (alarm_counter / CRESCENDO_SECONDS) );
+    }
+    else
+    {
+    }
+
+    if((clock_display.F_alarm == TRUE) ||(button_flag == TRUE))
+    {
+        alarm_counter = ONE_MINUTE;
+    }
+
+    if(alarm_counter >= ONE_MINUTE)
+    {
+        Backlight_Blink( FALSE );
+        alarm_counter = FALSE;
+        clock_display.S_alarm = ALARM_OFF;
+        HEL_LCD_Write(&LCDHandle, SECOND_ROW, CERO, "                "); /* cppcheck-suppress misra-c2012-7.4 ; no need for a constant value */
+        Buzzer_Stop();
+        Stopwatch_ShowRow(TRUE);
+        /*if the alarm was stopped with the button the clock will snooze it*/
+        clock_display.msg = (button_flag == TRUE) ? CLOCK_MSG_SNOOZE : CLOCK_MSG_FLAG_OFF;
+        button_flag = FALSE;
+        (void)HIL_QUEUE_Write( &SERIAL_queue, &clock_display);
+    }
+}
+
+/**
+* @brief   **This function renders the fields of a screen on the framebuffer**
+*
+*   All the fields of the layout shown on the screen are formatted in one pass, a field
+*   is only written on the framebuffer when its text is different from what it has, so
+*   the fields that did not change cost only the format and the compare.
+*
+* @param   screen[in]  screen to show, one of @ref Screens
+*/
+static void Display_Render( uint16_t screen )
+{
+    char text[HEL_LCD_COLS + ONE];
+    const Display_FieldTypeDef *field;
+    uint8_t line;
 
-        case BUZZER_STATE:
-            if ((alarm_counter % EVEN_SECONDS) == FALSE)
+    for( uint8_t i = CERO; i < (sizeof(Layout) / sizeof(Layout[CERO])); i++ )
+    {
+        field = &Layout[i];
+        if( (field->screens & screen) != CERO )
+        {
+            if( field->format != NULL )
             {
-                __HAL_TIM_SET_COMPARE( &TimHandle, TIM_CHANNEL_1, PWM_50 );
+                field->format( text );
             }
             else
             {
-                __HAL_TIM_SET_COMPARE( &TimHandle, TIM_CHANNEL_1, PWM_0 );
+                (void)memcpy( text, field->text, field->width );
             }
-            clock_display.msg = FLAG_STATE;
-            (void)HIL_QUEUE_WriteISR( &CLOCK_queue, &clock_display,SPI1_IRQn);
-        break;
+            text[field->width] = '\0';
 
-        case FLAG_STATE:
-            if((Alarm_Flag == TRUE) ||(button_flag == TRUE))
+            line = (field->row == (uint8_t)SECOND_ROW) ? ONE : CERO;
+            if( memcmp( &LCDHandle.Frame[line][field->col], text, field->width ) != 0 )
             {
-                Alarm_Flag = FALSE;
-                alarm_counter = ONE_MINUTE;
+                HEL_LCD_Write( &LCDHandle, field->row, field->col, text );
             }
-            clock_display.msg = COUNTER_STATE;
-            (void)HIL_QUEUE_WriteISR( &CLOCK_queue, &clock_display,SPI1_IRQn);
-        break;
+        }
+    }
+}
 
-        case COUNTER_STATE:
-            if(alarm_counter == ONE_MINUTE)
-            {
-                HEL_LCD_Backlight(&LCDHandle, ON);
-                alarm_counter = FALSE;
-                button_flag = FALSE;
-                clock_display.S_alarm = ALARM_OFF;
-                Status = HEL_LCD_SetCursor(&LCDHandle,SECOND_ROW,CERO );
-                assert_error( Status == HAL_OK, SPI_SET_CURSOR_ERROR ); /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-                /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-                Status = HEL_LCD_String(&LCDHandle, "                "); /* cppcheck-suppress misra-c2012-7.4 ; no need for a constant value */
-                assert_error( Status == HAL_OK, SPI_STRING_ERROR ); /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-                __HAL_TIM_SET_COMPARE( &TimHandle, TIM_CHANNEL_1, PWM_0 );
-                clock_display.msg = NINE;
-                (void)HIL_QUEUE_Write( &SERIAL_queue, &clock_display);
-            } 
-            clock_display.msg = IDLE;
-            (void)HIL_QUEUE_WriteISR( &CLOCK_queue, &clock_display,SPI1_IRQn);
-        break;
-        
-        default:
-        break;
+/**
+* @brief   **This function writes a binary number of two digits as ascii**
+*
+*   The number is changed to BCD with the table of the time library so no division is needed.
+*
+* @param   text[out]  two characters
+* @param   value[in]  number from 0 to 99
+*/
+static void Display_TwoDigits( char *text, uint8_t value )
+{
+    HIL_TIME_BcdToAscii( HIL_TIME_BinToBcd( value ), text );
+}
+
+/**
+* @brief   **This function writes a binary number of three digits as ascii**
+*
+*   The hundreds are taken by subtraction and the rest as two digits, so no division is needed.
+*
+* @param   text[out]  three characters
+* @param   value[in]  number from 0 to 999
+*/
+static void Display_ThreeDigits( char *text, uint16_t value )
+{
+    uint16_t rest = value;
+
+    text[CERO] = '0';
+    while( rest >= 100u )
+    {
+        rest -= 100u;
+        text[CERO]++;
     }
+    Display_TwoDigits( &text[ONE], (uint8_t)rest );
 }
 
 /**
- * @brief   **This function gets a 3 letter abreviation of a month **
- *
- *  The Function recived the pointer *mon where its going to modify the string
- *  and the char pos that is the month abreviation that we want, then we substract
- *  1 to the pos since in the array 0 is JAN then we multiply by 4 to get the
- *  position of were we want the abrevation and we asigned the values with a for loop 
- *
- * @param   mon[in] Indicates the string that we want to modify
- * @param   pos[in] Indicates wich month abreviation we want
- *       
- */
-void month(char *mon,char pos)
+* @brief   **Formatter of the month, "JAN" **
+*/
+static void Format_Month( char *text )
+{
+    (void)memcpy( text, HIL_TIME_MonthName( HIL_TIME_BcdToBin( display_bcd.mon ) ), HIL_TIME_NAME_SIZE );
+}
+
+/**
+* @brief   **Formatter of the day of the month, "01" **
+*/
+static void Format_Day( char *text )
 {
-   char position = (pos-ONE)*FOUR;
-   char *mes = "JAN,FEB,MAR,APR,MAY,JUN,JUL,AUG,SEP,OCT,NOV,DEC," ; /* cppcheck-suppress misra-c2012-7.4 ; string need to be modify*/
-   for(uint8_t i=CERO;i<FOUR;i++)
-   {
-        *(mon+i)=*(mes+i+position);         /* cppcheck-suppress misra-c2012-18.4 ; operators to pointer is needed*/
-   }
+    HIL_TIME_BcdToAscii( display_bcd.mday, text );
 }
 
+/**
+* @brief   **Formatter of the year, "2024" **
+*/
+static void Format_Year( char *text )
+{
+    /*the RTC only counts the years of the century of the epoch*/
+    text[CERO] = '2';
+    text[ONE]  = '0';
+    HIL_TIME_BcdToAscii( display_bcd.year, &text[TWO] );
+}
 
 /**
- * @brief   **This function gets a 2 letter abreviation of the week **
- *
- *  The Function recived the pointer *mon where its going to modify the string
- *  and the char pos that is the week abreviation that we want, then we substract
- *  1 to the pos since in the array 0 is MO (monday) then we multiply by 3 to get the
- *  position of were we want the abrevation and we asigned the values with a for loop 
- *
- * @param   mon[in] Indicates the string that we want to modify
- * @param   pos[in] Indicates wich month abreviation we want
- *        
- */
-void week(char *week,char pos)
+* @brief   **Formatter of the day of the week, "MO " **
+*/
+static void Format_Wday( char *text )
+{
+    (void)memcpy( text, HIL_TIME_WeekDayName( display_bcd.wday ), HIL_TIME_NAME_SIZE );
+}
+
+/**
+* @brief   **Formatter of the mark of an alarm programmed, "A" or blank **
+*/
+static void Format_AlarmMark( char *text )
 {
-  char position = (pos-ONE)*THREE;
-   char *sem = "MO TU WE TH FR SA SU" ;     /* cppcheck-suppress misra-c2012-7.4 ; string need to be modify*/
-   for(uint8_t i=CERO;i<THREE;i++)
-   {
-        *(week+i)=*(sem+i+position);        /* cppcheck-suppress misra-c2012-18.4 ; operators to pointer is needed*/
-   }
+    text[CERO] = (clock_display.S_alarm == ALARM_ON) ? 'A' : ' ';
 }
 
+/**
+* @brief   **Formatter of the time, "12:30:45" **
+*/
+static void Format_Time( char *text )
+{
+    HIL_TIME_BcdToAscii( display_bcd.hour, text );
+    text[TWO] = ':';
+    HIL_TIME_BcdToAscii( display_bcd.min, &text[THREE] );
+    text[FIVE] = ':';
+    HIL_TIME_BcdToAscii( display_bcd.sec, &text[SIX] );
+}
 
 /**
- * @brief   **Interruption for falling gpio pin 7 **
- *
- *  This function will be called as an interruption when a falling event 
- *  happens on the gpio pin 7 B.
- *  if the alarm is active this function will tell the alarm flag to stop the alarm
- *  also puts the button value on true to display the alarm status on the second row. 
- *         
- */
- /* cppcheck-suppress misra-c2012-2.7 ; function cannot be modify is a library function */
-void HAL_GPIO_EXTI_Falling_Callback( uint16_t GPIO_Pin )    /* cppcheck-suppress misra-c2012-8.4 ; no need for a declaration since is a library function*/    
+* @brief   **Formatter of the temperature, "25" **
+*/
+static void Format_Temperature( char *text )
+{
+    Display_TwoDigits( text, (display_temperature > 99u) ? 99u : display_temperature );
+}
+
+/**
+* @brief   **Formatter of the temperature in tenths, " 25.3" or "-05.1" **
+*/
+static void Format_TempTenths( char *text )
+{
+    uint16_t tenths = (display_tenths < 0) ? (uint16_t)-display_tenths : (uint16_t)display_tenths;
+
+    tenths = (tenths > 999u) ? 999u : tenths;
+    text[CERO] = (display_tenths < 0) ? '-' : ' ';
+    Display_TwoDigits( &text[ONE], (uint8_t)(tenths / TEN) );
+    text[THREE] = '.';
+    text[FOUR]  = (char)('0' + (tenths % TEN));
+}
+
+/**
+* @brief   **Formatter of the top half of the big digits, "HH.MM" **
+*/
+static void Format_BigTop( char *text )
+{
+    Display_BigRow( text, CERO );
+}
+
+/**
+* @brief   **Formatter of the bottom half of the big digits, "HH.MM" **
+*/
+static void Format_BigBottom( char *text )
+{
+    Display_BigRow( text, ONE );
+}
+
+/**
+* @brief   **Formatter of the seconds, "45" **
+*/
+static void Format_Seconds( char *text )
 {
-    if(clock_display.S_alarm == ALARM_ACTIVE)
+    HIL_TIME_BcdToAscii( display_bcd.sec, text );
+}
+
+/**
+* @brief   **This function writes one half of the hours and minutes with big digits**
+*
+*   Each BCD nibble is the index of the digit on the BigDigits table.
+*
+* @param   text[out]  13 characters, 4 digits and the separator
+* @param   half[in]   0 for the top row, 1 for the bottom row
+*/
+static void Display_BigRow( char *text, uint8_t half )
+{
+    const uint8_t digits[FOUR] = { (uint8_t)(display_bcd.hour >> FOUR), (uint8_t)(display_bcd.hour & 0x0Fu),
+                                   (uint8_t)(display_bcd.min >> FOUR),  (uint8_t)(display_bcd.min & 0x0Fu) };
+    uint8_t col = CERO;
+
+    for( uint8_t i = CERO; i < FOUR; i++ )
     {
-        button_flag = TRUE;
+        if( i == TWO )
+        {
+            text[col] = (char)BIG_COLON;
+            col++;
+        }
+        (void)memcpy( &text[col], BigDigits[(digits[i] > NINE) ? CERO : digits[i]][half], BIG_DIGIT_COLS );
+        col += BIG_DIGIT_COLS;
     }
-    button = TRUE;
 }
 
 /**
-* @brief   **Interruption for falling gpio pin 7 **
+* @brief   **Formatter of the offset from UTC, "+01:00" **
+*/
+static void Format_UtcOffset( char *text )
+{
+    int16_t offset = Clock_GetUtcOffset();
+    uint16_t minutes = (offset < 0) ? (uint16_t)(-offset) : (uint16_t)offset;
+
+    text[CERO] = (offset < 0) ? '-' : '+';
+    Display_TwoDigits( &text[ONE], (uint8_t)(minutes / MINUTES_PER_HOUR) );
+    text[THREE] = ':';
+    Display_TwoDigits( &text[FOUR], (uint8_t)(minutes % MINUTES_PER_HOUR) );
+}
+
+/**
+* @brief   **Formatter of the day of the year, "031" **
+*/
+static void Format_YearDay( char *text )
+{
+    Display_ThreeDigits( text, (uint16_t)(display_tm.yday + ONE) );
+}
+
+/**
+* @brief   **Formatter of the number of the alarm shown, "1" **
+*/
+static void Format_AlarmSlot( char *text )
+{
+    text[CERO] = (char)('1' + Menu_GetSlot());
+}
+
+/**
+* @brief   **Formatter of the state of the alarm shown, "ON " or "OFF" **
+*/
+static void Format_AlarmEnable( char *text )
+{
+    (void)memcpy( text, (display_alarm.enable == TRUE) ? "ON " : "OFF", THREE );
+}
+
+/**
+* @brief   **Formatter of the time of the alarm shown, "07:00" **
+*/
+static void Format_AlarmTime( char *text )
+{
+    Display_TwoDigits( text, display_alarm.hour );
+    text[TWO] = ':';
+    Display_TwoDigits( &text[THREE], display_alarm.minute );
+}
+
+/**
+* @brief   **Formatter of the days of the alarm shown, "MTWTF--" **
+*/
+static void Format_AlarmDays( char *text )
+{
+    static const char days[SEVEN] = { 'M', 'T', 'W', 'T', 'F', 'S', 'S' };
+
+    for( uint8_t i = CERO; i < SEVEN; i++ )
+    {
+        text[i] = ((display_alarm.weekdays & (1u << i)) != CERO) ? days[i] : '-';
+    }
+}
+
+/**
+* @brief   **Formatter of the min temperature, "20" **
+*/
+static void Format_TempMin( char *text )
+{
+    Display_TwoDigits( text, (display_temp_min > 99u) ? 99u : display_temp_min );
+}
+
+/**
+* @brief   **Formatter of the max temperature, "27" **
+*/
+static void Format_TempMax( char *text )
+{
+    Display_TwoDigits( text, (display_temp_max > 99u) ? 99u : display_temp_max );
+}
+
+/**
+* @brief   **Formatter of the state of the CAN node, "ACTV" **
+*/
+static void Format_CanState( char *text )
+{
+    (void)memcpy( text, CanStates[(display_can.state > CAN_HEALTH_RECOVERING) ? CAN_HEALTH_ACTIVE : display_can.state], FOUR );
+}
+
+/**
+* @brief   **Formatter of the transmit error counter, "000" **
+*/
+static void Format_CanTec( char *text )
+{
+    Display_ThreeDigits( text, display_can.tec );
+}
+
+/**
+* @brief   **Formatter of the receive error counter, "000" **
+*/
+static void Format_CanRec( char *text )
+{
+    Display_ThreeDigits( text, display_can.rec );
+}
+
+/**
+* @brief   **Formatter of the contrast, "07" or "PT" when it is taken from the pot **
+*/
+static void Format_Contrast( char *text )
+{
+    uint8_t contrast = Config_Get()->contrast;
+
+    if( contrast == CONFIG_NO_CONTRAST )
+    {
+        text[CERO] = 'P';
+        text[ONE]  = 'T';
+    }
+    else
+    {
+        Display_TwoDigits( text, contrast );
+    }
+}
+
+/**
+* @brief   **Interruption for the end of a transfer of the spi **
 *
-*  This function will be called as an interruption when a rising event 
-*  happens on the gpio pin 7 B.
-*  this function will ereased the second row of the lcd, this is because
-*  no mather when this button is pressed ereasing the second row is necesary
-*  also puts the button on false wich will tell other functions that the button is not pressed        
+*  The only transfers with DMA are the ones of the lcd queue and flush, the lcd
+*  driver starts the next one.
 */
  /* cppcheck-suppress misra-c2012-2.7 ; function cannot be modify is a library function */
-void HAL_GPIO_EXTI_Rising_Callback( uint16_t GPIO_Pin ) /* cppcheck-suppress misra-c2012-8.4 ; no need for a declaration since is a library function*/
+void HAL_SPI_TxCpltCallback( SPI_HandleTypeDef *hspi )  /* cppcheck-suppress misra-c2012-8.4 ; no need for a declaration since is a library function*/
 {
-    Status = HEL_LCD_SetCursor(&LCDHandle,SECOND_ROW,0 );
-    assert_error( Status == HAL_OK, SPI_SET_CURSOR_ERROR ); /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-    Status = HEL_LCD_String(&LCDHandle, "               ");     /* cppcheck-suppress misra-c2012-7.4 ; no need for a constant value */
-    assert_error( Status == HAL_OK, SPI_STRING_ERROR ); /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-    button = FALSE; 
+    HEL_LCD_TxCpltCallback(&LCDHandle);
 }
 
 /**
-* @brief   **This function applied the of intensity and contrast to the lcd**
+* @brief   **Interruption for the update event of a timer **
 *
-*  the function first checks if the value read by the pot is different to the one
-*  that was previously applied, in both cases if its different then it applies the value
-*  in the case of the intensity level this is applied by changing the pwm period of the 
-*  lcd backlight.
-*  in the case of the contrast the value changes by calling the function HEL_LCD_Contrast
-*  wich sends a command to the lcd to change the contrast, the second parameter is the contrast value
-*  we use the previous fucntion to get this values.
-*  
+*  The timer of the lcd ends the wait of the execution time of a command and the lcd
+*  driver starts the next transfer, the timer of the button ends its debounce or the
+*  time of a gesture.
+*/
+void HAL_TIM_PeriodElapsedCallback( TIM_HandleTypeDef *htim )  /* cppcheck-suppress misra-c2012-8.4 ; no need for a declaration since is a library function*/
+{
+    if( htim == LCDHandle.TimHandler )
+    {
+        HEL_LCD_TimerCallback(&LCDHandle);
+    }
+    else if( htim == &ButtonHandler )
+    {
+        Button_TimerCallback();
+    }
+    else
+    {
+        /*no other timer has the update interrupt*/
+    }
+}
+
+/**
+* @brief   **This function checks the contrast configured and the time of the backlight**
+*
+*  The pots are not read here, they post Display_AnalogWork when they move. Only the
+*  contrast configured by CAN or the menu is compared with the one it had when the contrast
+*  was sent, a byte on memory, so the lcd is only touched when something changed, a contrast
+*  the lcd queue had no room for is sent again. Then the backlight checks the time without
+*  presses to dim.
 */
 void Display_LcdTask( void )
 {
-    static uint8_t intensity_level   = FALSE;
-    static uint8_t contrast_level    = FALSE;
-    
-    if(intensity_level !=Analogs_GetIntensity())
+    if( (Config_Get()->contrast != display_config_contrast) || (display_contrast_pending == TRUE) )
     {
-        intensity_level =Analogs_GetIntensity();
-        __HAL_TIM_SET_COMPARE( &TimHandle2, TIM_CHANNEL_1, intensity_level );
+        Display_Contrast();
     }
-    if(contrast_level !=Analogs_GetContrast())
+    Backlight_Task();
+}
+
+/**
+* @brief   **Deferred work of the pots, it is posted when a pot moves more than its deadband**
+*
+*  The intensity goes to the backlight that fades to it, and the contrast is sent to the lcd.
+*/
+static void Display_AnalogWork( void )
+{
+    uint8_t changes = Analogs_GetChanges( analog_subscription );
+
+    if( (changes & ANALOGS_INPUT_INTENSITY) != CERO )
+    {
+        Backlight_SetLevel( Analogs_GetIntensity() );
+    }
+    if( (changes & ANALOGS_INPUT_CONTRAST) != CERO )
+    {
+        Display_Contrast();
+    }
+}
+
+/**
+* @brief   **This function sends the contrast to the lcd when it changed**
+*
+*  The contrast is the one configured or the one of the pot, the command of the contrast
+*  is only sent when it is different from the last one sent. When the lcd queue is full the
+*  command is dropped, so it stays pending and Display_LcdTask tries again on its next period.
+*/
+static void Display_Contrast( void )
+{
+    uint8_t contrast = Analogs_GetContrast();
+
+    display_config_contrast  = Config_Get()->contrast;
+    display_contrast_pending = FALSE;
+    if( contrast != display_contrast )
     {
-        contrast_level =Analogs_GetContrast();
-        (void)HEL_LCD_Contrast( &LCDHandle, contrast_level );
+        if( HEL_LCD_Contrast( &LCDHandle, contrast ) == HAL_OK )
+        {
+            display_contrast = contrast;
+        }
+        else
+        {
+            display_contrast_pending = TRUE;
+        }
     }
 }
     
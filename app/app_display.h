@@ -16,5 +16,7 @@
     void Display_Init( void );
     void Display_Task( void );
     void Display_LcdTask( void );
+    void Display_SetBigDigits( uint8_t enable );
+    void Display_ResetTemperature( void );
 
 #endif
\ No newline at end of file
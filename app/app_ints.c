@@ -2,6 +2,9 @@
  * Archivo con la funciones de interrupcion del micrcontroladores, revisar archivo startup_stm32g0b1.S
 -------------------------------------------------------------------------------------------------*/
 #include "app_bsp.h"
+#include "app_config.h"
+#include "app_log.h"
+#include "hel_lcd.h"
 
 
 /**------------------------------------------------------------------------------------------------
@@ -53,13 +56,6 @@ void TIM16_FDCAN_IT0_IRQHandler( void )  /* cppcheck-suppress misra-c2012-8.4 ;
     HAL_FDCAN_IRQHandler( &CANHandler );
 }
 
-/* cppcheck-suppress misra-c2012-2.7 ; this is a library function */
-void HAL_FDCAN_ErrorCallback(FDCAN_HandleTypeDef *hfdcan)   /* cppcheck-suppress misra-c2012-8.4 ; this function can`t be modify */
-{
-    Status = HAL_ERROR;
-    assert_error( Status == HAL_OK, FDCAN_CALLBACK_ERROR ); /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-}
-
 /* cppcheck-suppress misra-c2012-2.7 ; this is a library function */
 void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi) /* cppcheck-suppress misra-c2012-8.4 ; this function can`t be modify */
 {
@@ -76,6 +72,8 @@ void HAL_WWDG_EarlyWakeupCallback( WWDG_HandleTypeDef *hwwdg )  /* cppcheck-supp
 
 void FLASH_IRQHandler(void)     /* cppcheck-suppress misra-c2012-8.4 ; this function can`t be modify */
 {
+    /*end of the erase of the configuration store or the event log*/
+    HAL_FLASH_IRQHandler();
     
     if (__HAL_FLASH_GET_FLAG(FLASH_FLAG_ECCC) != RESET)
     {
@@ -89,9 +87,33 @@ void FLASH_IRQHandler(void)     /* cppcheck-suppress misra-c2012-8.4 ; this func
     }
 }
 
+/* cppcheck-suppress misra-c2012-2.7 ; this is a library function */
+void HAL_FLASH_EndOfOperationCallback( uint32_t ReturnValue )  /* cppcheck-suppress misra-c2012-8.4 ; this function can`t be modify */
+{
+    /*only one erase runs at a time, each user ignores the erase that is not its own*/
+    Config_EraseCallback();
+    Log_EraseCallback();
+}
+
+/* cppcheck-suppress misra-c2012-2.7 ; this is a library function */
+void HAL_FLASH_OperationErrorCallback( uint32_t ReturnValue )  /* cppcheck-suppress misra-c2012-8.4 ; this function can`t be modify */
+{
+    /*local status since it runs on the flash interrupt*/
+    HAL_StatusTypeDef FlashStatus = HAL_ERROR;
+
+    /*the erase is over, its state is cleared before the safe state so the log can still be written*/
+    Config_EraseCallback();
+    Log_EraseCallback();
+    /*the HAL releases the flash after this callback, the safe state does not return so it is done here*/
+    FLASH->CR &= ~(FLASH_CR_EOPIE | FLASH_CR_ERRIE);
+    __HAL_UNLOCK( &pFlash );
+    assert_error( FlashStatus == HAL_OK, FLASH_OPERATION_ERROR );   /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+}
+
 void RTC_TAMP_IRQHandler( void )             /* cppcheck-suppress misra-c2012-8.4 ; function does no need extern linkage */
 {
     HAL_RTC_AlarmIRQHandler( &hrtc );
+    HAL_RTCEx_WakeUpTimerIRQHandler( &hrtc );
 }
 
 void EXTI4_15_IRQHandler( void )            /* cppcheck-suppress misra-c2012-8.4 ; function does no need extern linkage */
@@ -106,6 +128,29 @@ void DMA1_Channel1_IRQHandler(void)         /* cppcheck-suppress misra-c2012-8.4
     HAL_DMA_IRQHandler( &DmaHandler );
 }
 
+void DMA1_Channel2_3_IRQHandler( void )     /* cppcheck-suppress misra-c2012-8.4 ; function does no need extern linkage */
+{
+    /*end of a transfer of the lcd*/
+    HAL_DMA_IRQHandler( LCDHandle.SpiHandler->hdmatx );
+}
+
+void SPI1_IRQHandler( void )                /* cppcheck-suppress misra-c2012-8.4 ; function does no need extern linkage */
+{
+    HAL_SPI_IRQHandler( LCDHandle.SpiHandler );
+}
+
+void TIM7_LPTIM2_IRQHandler( void )         /* cppcheck-suppress misra-c2012-8.4 ; function does no need extern linkage */
+{
+    /*end of the wait of a lcd command*/
+    HAL_TIM_IRQHandler( LCDHandle.TimHandler );
+}
+
+void TIM15_IRQHandler( void )               /* cppcheck-suppress misra-c2012-8.4 ; function does no need extern linkage */
+{
+    /*end of the debounce or of the time of a gesture of the button*/
+    HAL_TIM_IRQHandler( &ButtonHandler );
+}
+
 /* cppcheck-suppress misra-c2012-2.7 ; this is a library function */
 void ADC1_COMP_IRQHandler( void )           /* cppcheck-suppress misra-c2012-8.4 ; function does no need extern linkage */
 {
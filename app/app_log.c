@@ -0,0 +1,582 @@
+/**
+* @file    app_log.c
+* @brief   **Event log on a flash ring**
+*
+*   The events of the clock are kept with their time on the last pages of the flash so the
+*   history survives a reset. An entry is one double word, the pages are used as a ring and
+*   each one starts with a header with its sequence, the page with the highest sequence is
+*   where the entries are written. The events are queued on RAM from any context and the task
+*   programs them in batches of one flash row, so the flash is not touched for every event
+*   and a page is only erased once every LOG_PAGE_ENTRIES entries. The log is read through
+*   CAN, the entries are sent from the newest to the oldest one as raw frames.
+*/
+#include "app_log.h"
+#include "app_clock.h"
+#include "app_serial.h"
+#include "hil_queue.h"
+#include "hil_store.h"
+#include <string.h>
+
+/**
+  * @defgroup Log_flash flash used by the log, the last 4 pages of bank 2 before the configuration
+  @{ */
+#define LOG_FLASH_ADDRESS       0x0807D000u     /*!< Address of the first page of the log*/
+#define LOG_FLASH_BANK          FLASH_BANK_2    /*!< Bank of the pages*/
+#define LOG_FLASH_PAGE          122u            /*!< Number of the first page inside the bank*/
+#define LOG_PAGES               4u              /*!< Pages of the ring*/
+#define LOG_ENTRY_SIZE          8u              /*!< Bytes of one entry, one double word*/
+#define LOG_PAGE_ENTRIES        ((FLASH_PAGE_SIZE / LOG_ENTRY_SIZE) - 1u)  /*!< Entries per page, the first double word is the header*/
+#define LOG_NONE                0xFFFFFFFFu     /*!< Value of an erased word*/
+#define LOG_NO_PAGE             0xFFu           /*!< No page selected*/
+#define LOG_WORD_SHIFT          32u             /*!< Shift of the high word of a double word*/
+/**
+  @} */
+
+/**
+  * @defgroup Log_batch values of the RAM queue and the batches, the task runs every 10 ms
+  @{ */
+#define LOG_STAGE_SIZE          64u     /*!< Entries kept on RAM*/
+#define LOG_BATCH               32u     /*!< Entries of one flash row, they start a flush*/
+#define LOG_FLUSH_PERIODS       6000u   /*!< A lone entry is written after 60 s*/
+#define LOG_WRITES_PER_TASK     8u      /*!< Double words programmed on one task call, around 700 us*/
+#define LOG_FRAMES_PER_TASK     2u      /*!< Frames sent on one task call while reading*/
+#define LOG_FATAL_TRIES         (LOG_STAGE_SIZE + (2u * LOG_PAGES))    /*!< Max flush calls on the safe state*/
+#define LOG_BYTE_SHIFT          8u      /*!< Shift of one byte*/
+#define LOG_BYTE_MASK           0xFFu   /*!< Mask of one byte*/
+/**
+  @} */
+
+/**
+* @brief  RAM queue with the entries not yet written, shared with the interrupts
+*/
+static QUEUE_HandleTypeDef LogQueue;
+static LOG_EntryTypeDef LogStage[LOG_STAGE_SIZE];
+static volatile uint32_t Staged;
+static volatile uint8_t Lost;
+static volatile uint8_t Ready;
+
+/**
+* @brief  Page where the entries are written, its sequence and the address of the next entry
+*/
+static uint8_t Active;
+static uint32_t Sequence;
+static uint32_t Next;
+
+/**
+* @brief  Page erased or being erased that will get the next header
+*/
+static uint8_t Erased;
+static volatile uint8_t Erasing;
+
+/**
+* @brief  Entry taken from the queue that could not be programmed yet
+*/
+static LOG_EntryTypeDef Pending;
+static uint8_t PendingValid;
+
+/**
+* @brief  Task periods since the first entry was queued and flag of a flush running
+*/
+static uint32_t StageAge;
+static uint8_t Flushing;
+
+/**
+* @brief  Read request, entries to skip from the newest one and entries left to send
+*/
+static uint8_t Reading;
+static uint8_t ReadFlushed;
+static uint32_t ReadSkip;
+static uint32_t ReadCount;
+
+static void Log_Scan( void );
+static void Log_Start( void );
+static uint32_t Log_PageAddress( uint8_t page );
+static uint8_t Log_PageValid( uint8_t page, uint32_t *sequence );
+static uint8_t Log_IsFull( void );
+static void Log_NewPage( uint8_t wait );
+static void Log_Flush( uint32_t writes, uint8_t wait );
+static uint32_t Log_Address( uint32_t back );
+static void Log_Stream( void );
+
+/**
+* @brief   **Init function for the event log**
+*
+*   The pages are scanned to find where the entries continue, then the boot is logged with
+*   the reset flags of the RCC, they are cleared so the next boot only shows its own cause.
+*/
+void Log_Init( void )
+{
+    Log_Start();
+
+    Log_Event( LOG_EVENT_BOOT, (uint8_t)(RCC->CSR >> 24u), 0u, 0u );
+    __HAL_RCC_CLEAR_RESET_FLAGS();
+}
+
+/**
+* @brief   **Task function for the event log**
+*
+*   A flush starts when a batch of one row is queued, when the oldest entry waited
+*   LOG_FLUSH_PERIODS or before a read, and it goes on a few double words per call until the
+*   queue is empty. While a read is sent no flush is started so the entries do not move.
+*/
+void Log_Task( void )
+{
+    uint32_t primask;
+    uint8_t lost;
+
+    if( Lost != 0u )
+    {
+        primask = __get_PRIMASK();
+        __disable_irq();
+        lost = Lost;
+        Lost = 0u;
+        __set_PRIMASK( primask );
+        Log_Event( LOG_EVENT_LOST, lost, 0u, 0u );
+    }
+
+    StageAge = (Staged == 0u) ? 0u : (StageAge + 1u);
+
+    if( (Reading == FALSE) || (ReadFlushed == FALSE) )
+    {
+        if( (Staged >= LOG_BATCH) || (StageAge >= LOG_FLUSH_PERIODS) || (Reading == TRUE) )
+        {
+            Flushing = TRUE;
+        }
+    }
+
+    if( Flushing == TRUE )
+    {
+        Log_Flush( LOG_WRITES_PER_TASK, FALSE );
+        if( (Staged == 0u) && (PendingValid == FALSE) )
+        {
+            Flushing    = FALSE;
+            StageAge    = 0u;
+            ReadFlushed = Reading;
+        }
+    }
+    else if( Reading == TRUE )
+    {
+        Log_Stream();
+    }
+    else
+    {
+    }
+}
+
+/**
+* @brief   **Logs an event**
+*
+*   The entry gets the time of the clock and it is queued, it can be called from any task or
+*   interrupt. If the queue is full the entry is counted and a LOG_EVENT_LOST is logged later.
+*
+* @param   id[in]      event, a value of @ref Log_events
+* @param   data0[in]   first byte of data
+* @param   data1[in]   second byte of data
+* @param   data2[in]   third byte of data
+*/
+void Log_Event( uint8_t id, uint8_t data0, uint8_t data1, uint8_t data2 )
+{
+    LOG_EntryTypeDef entry;
+    uint32_t primask;
+
+    if( Ready == TRUE )
+    {
+        (void)Clock_GetTime( &entry.time );
+        entry.id      = id;
+        entry.data[0] = data0;
+        entry.data[1] = data1;
+        entry.data[2] = data2;
+
+        primask = __get_PRIMASK();
+        __disable_irq();
+        if( HIL_QUEUE_Write( &LogQueue, &entry ) == QUEUE_OK )
+        {
+            Staged++;
+        }
+        else if( Lost < LOG_BYTE_MASK )
+        {
+            Lost++;
+        }
+        else
+        {
+        }
+        __set_PRIMASK( primask );
+    }
+}
+
+/**
+* @brief   **Starts a read of the log through CAN**
+*
+*   The queued entries are written first, then the entries are sent from the newest one
+*   skipping the first ones, a frame with all bytes 0xFF is sent if the log ends before count.
+*
+* @param   skip[in]    entries to skip from the newest one
+* @param   count[in]   entries to send, LOG_ALL to send the whole log
+*/
+void Log_Read( uint16_t skip, uint8_t count )
+{
+    ReadSkip    = skip;
+    ReadCount   = (count == LOG_ALL) ? (LOG_PAGES * LOG_PAGE_ENTRIES) : count;
+    ReadFlushed = FALSE;
+    Reading     = TRUE;
+}
+
+/**
+* @brief   **Logs the safe state and writes all the queued entries**
+*
+*   It is called with the interrupts disabled so an erase started before is finished polling
+*   the flash and calling its interrupt handler, then the queue is written blocking, with a
+*   limit of tries so a flash that fails cannot stop the safe state.
+*
+* @param   error[in]   error that called the safe state
+* @param   line[in]    line where the error was found
+*/
+void Log_Fatal( uint8_t error, uint32_t line )
+{
+    static uint8_t fatal = FALSE;
+
+    /*an error inside this function calls the safe state again*/
+    if( fatal == FALSE )
+    {
+        fatal = TRUE;
+        if( Ready == FALSE )
+        {
+            Log_Start();
+        }
+        Log_Event( LOG_EVENT_SAFE_STATE, error, (uint8_t)(line >> LOG_BYTE_SHIFT), (uint8_t)(line & LOG_BYTE_MASK) );
+
+        if( HIL_STORE_FlashBusy() == TRUE )
+        {
+            while( (__HAL_FLASH_GET_FLAG( FLASH_FLAG_BSY1 ) != 0u) || (__HAL_FLASH_GET_FLAG( FLASH_FLAG_BSY2 ) != 0u) )
+            {
+            }
+            HAL_FLASH_IRQHandler();
+        }
+
+        for( uint32_t i = 0u; (i < LOG_FATAL_TRIES) && ((Staged != 0u) || (PendingValid == TRUE)); i++ )
+        {
+            Log_Flush( LOG_STAGE_SIZE, TRUE );
+        }
+    }
+}
+
+/**
+* @brief   **This function has to be called when the flash finished the erase**
+*
+*   Call it from HAL_FLASH_EndOfOperationCallback and HAL_FLASH_OperationErrorCallback,
+*   a failed erase is reported by the error callback after the state is cleared.
+*/
+void Log_EraseCallback( void )
+{
+    if( Erasing == TRUE )
+    {
+        Erasing = FALSE;
+        (void)HAL_FLASH_Lock();
+    }
+}
+
+/**
+* @brief   **Configures the queue and finds the active page**
+*/
+static void Log_Start( void )
+{
+    LogQueue.Buffer   = LogStage;
+    LogQueue.Elements = LOG_STAGE_SIZE;
+    LogQueue.size     = sizeof(LOG_EntryTypeDef);
+    HIL_QUEUE_Init( &LogQueue );
+
+    Staged       = 0u;
+    Lost         = 0u;
+    Erased       = LOG_NO_PAGE;
+    Erasing      = FALSE;
+    PendingValid = FALSE;
+    StageAge     = 0u;
+    Flushing     = FALSE;
+    Reading      = FALSE;
+
+    Log_Scan();
+    Ready = TRUE;
+}
+
+/**
+* @brief   **Finds the page with the highest sequence and its first erased entry**
+*
+*   The sequence is compared with a subtraction so it keeps working when it wraps. If there
+*   is no valid page the last one is taken as active and full, so the first write goes to page 0.
+*/
+static void Log_Scan( void )
+{
+    uint32_t sequence;
+    uint32_t end;
+
+    Active   = LOG_NO_PAGE;
+    Sequence = 0u;
+    for( uint8_t page = 0u; page < LOG_PAGES; page++ )
+    {
+        if( (Log_PageValid( page, &sequence ) == TRUE) &&
+            ((Active == LOG_NO_PAGE) || ((int32_t)(sequence - Sequence) > 0)) )
+        {
+            Active   = page;
+            Sequence = sequence;
+        }
+    }
+
+    if( Active == LOG_NO_PAGE )
+    {
+        Active = LOG_PAGES - 1u;
+        Next   = LOG_NONE;
+    }
+    else
+    {
+        Next = Log_PageAddress( Active ) + LOG_ENTRY_SIZE;
+        end  = Log_PageAddress( Active ) + FLASH_PAGE_SIZE;
+        while( (Next < end) && (*(const volatile uint32_t *)Next != LOG_NONE) )  /* cppcheck-suppress misra-c2012-11.4 ; the entry is on a flash address */
+        {
+            Next += LOG_ENTRY_SIZE;
+        }
+    }
+}
+
+/**
+* @brief   **Gets the address of one of the pages**
+*
+* @param   page[in]   0 to LOG_PAGES - 1
+*
+* @retval  address of the first byte of the page
+*/
+static uint32_t Log_PageAddress( uint8_t page )
+{
+    return LOG_FLASH_ADDRESS + ((uint32_t)page * FLASH_PAGE_SIZE);
+}
+
+/**
+* @brief   **Reads the header of a page**
+*
+*   The header is the sequence on the low word and its complement on the high word,
+*   an erased page or a header cut by a reset is not valid.
+*
+* @param   page[in]       0 to LOG_PAGES - 1
+* @param   sequence[out]  sequence of the page
+*
+* @retval  TRUE if the header is valid, otherwise FALSE
+*/
+static uint8_t Log_PageValid( uint8_t page, uint32_t *sequence )
+{
+    uint32_t address = Log_PageAddress( page );
+
+    *sequence = *(const volatile uint32_t *)address;    /* cppcheck-suppress misra-c2012-11.4 ; the header is on a flash address */
+
+    return (*(const volatile uint32_t *)(address + sizeof(uint32_t)) == ~(*sequence)) ? TRUE : FALSE;  /* cppcheck-suppress misra-c2012-11.4 ; the header is on a flash address */
+}
+
+/**
+* @brief   **Tells if the active page has no room**
+*
+* @retval  TRUE if a new page is needed, otherwise FALSE
+*/
+static uint8_t Log_IsFull( void )
+{
+    return ((Next == LOG_NONE) || (Next >= (Log_PageAddress( Active ) + FLASH_PAGE_SIZE))) ? TRUE : FALSE;
+}
+
+/**
+* @brief   **Prepares the page after the active one**
+*
+*   The first call starts the erase, with interrupts or blocking on the safe state, the
+*   flash stays unlocked until Log_EraseCallback. The next call writes the header with the
+*   next sequence and the page becomes the active one, if the header fails the page is
+*   erased again. The oldest entries are lost with the erase.
+*
+* @param   wait[in]   TRUE to erase without interrupts
+*/
+static void Log_NewPage( uint8_t wait )
+{
+    FLASH_EraseInitTypeDef EraseInit;
+    uint32_t PageError;
+    uint64_t header;
+    HAL_StatusTypeDef result;
+
+    if( Erased == LOG_NO_PAGE )
+    {
+        Erased = (uint8_t)((Active + 1u) % LOG_PAGES);
+
+        EraseInit.TypeErase = FLASH_TYPEERASE_PAGES;
+        EraseInit.Banks     = LOG_FLASH_BANK;
+        EraseInit.Page      = LOG_FLASH_PAGE + Erased;
+        EraseInit.NbPages   = 1u;
+
+        Status = HAL_FLASH_Unlock();
+        assert_error( Status == HAL_OK, FLASH_UNLOCK_ERROR );   /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+        if( wait == TRUE )
+        {
+            (void)HAL_FLASHEx_Erase( &EraseInit, &PageError );
+            (void)HAL_FLASH_Lock();
+        }
+        else
+        {
+            Erasing = TRUE;
+            Status = HAL_FLASHEx_Erase_IT( &EraseInit );
+            assert_error( Status == HAL_OK, FLASH_ERASE_ERROR );    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+        }
+    }
+    else
+    {
+        header = ((uint64_t)(~(Sequence + 1u)) << LOG_WORD_SHIFT) | (Sequence + 1u);
+
+        Status = HAL_FLASH_Unlock();
+        assert_error( Status == HAL_OK, FLASH_UNLOCK_ERROR );   /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+        result = HAL_FLASH_Program( FLASH_TYPEPROGRAM_DOUBLEWORD, Log_PageAddress( Erased ), header );
+        Status = HAL_FLASH_Lock();
+        assert_error( Status == HAL_OK, FLASH_LOCK_ERROR );     /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+
+        if( result == HAL_OK )
+        {
+            Active = Erased;
+            Sequence++;
+            Next = Log_PageAddress( Active ) + LOG_ENTRY_SIZE;
+        }
+        Erased = LOG_NO_PAGE;
+    }
+}
+
+/**
+* @brief   **Writes queued entries on the active page**
+*
+*   Nothing is done while the flash is busy with an erase of the log or of other user. When
+*   the page is full the call prepares the next page instead. An entry that fails is kept and
+*   the page is taken as full, so it is written on the next page.
+*
+* @param   writes[in]  max double words to program
+* @param   wait[in]    TRUE to erase without interrupts
+*/
+static void Log_Flush( uint32_t writes, uint8_t wait )
+{
+    uint64_t double_word;
+    uint32_t primask;
+    HAL_StatusTypeDef result;
+
+    if( (Erasing == FALSE) && (HIL_STORE_FlashBusy() == FALSE) )
+    {
+        if( Log_IsFull() == TRUE )
+        {
+            Log_NewPage( wait );
+        }
+        else
+        {
+            Status = HAL_FLASH_Unlock();
+            assert_error( Status == HAL_OK, FLASH_UNLOCK_ERROR );   /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+
+            for( uint32_t i = 0u; (i < writes) && (Log_IsFull() == FALSE) && ((Staged != 0u) || (PendingValid == TRUE)); i++ )
+            {
+                if( PendingValid == FALSE )
+                {
+                    primask = __get_PRIMASK();
+                    __disable_irq();
+                    (void)HIL_QUEUE_Read( &LogQueue, &Pending );
+                    Staged--;
+                    __set_PRIMASK( primask );
+                    PendingValid = TRUE;
+                }
+
+                (void)memcpy( &double_word, &Pending, sizeof(double_word) );
+                result = HAL_FLASH_Program( FLASH_TYPEPROGRAM_DOUBLEWORD, Next, double_word );
+                if( result == HAL_OK )
+                {
+                    Next += LOG_ENTRY_SIZE;
+                    PendingValid = FALSE;
+                }
+                else
+                {
+                    Next = Log_PageAddress( Active ) + FLASH_PAGE_SIZE;
+                }
+            }
+
+            Status = HAL_FLASH_Lock();
+            assert_error( Status == HAL_OK, FLASH_LOCK_ERROR );     /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+        }
+    }
+}
+
+/**
+* @brief   **Gets the address of an entry counting from the newest one**
+*
+*   The pages are walked back from the active one, each older page has to have the
+*   previous sequence, otherwise it was erased or never written and the log ends there.
+*
+* @param   back[in]   entries back from the newest one, 0 is the newest
+*
+* @retval  address of the entry or LOG_NONE if the log has less entries
+*/
+static uint32_t Log_Address( uint32_t back )
+{
+    uint32_t address = LOG_NONE;
+    uint32_t remain = back;
+    uint32_t sequence = Sequence;
+    uint32_t found;
+    uint32_t used;
+    uint8_t page = Active;
+
+    if( Next != LOG_NONE )
+    {
+        used = ((Next - Log_PageAddress( page )) / LOG_ENTRY_SIZE) - 1u;
+        for( uint8_t i = 0u; (i < LOG_PAGES) && (address == LOG_NONE); i++ )
+        {
+            if( remain < used )
+            {
+                address = Log_PageAddress( page ) + ((used - remain) * LOG_ENTRY_SIZE);
+            }
+            else
+            {
+                remain  -= used;
+                page     = (uint8_t)((page + LOG_PAGES - 1u) % LOG_PAGES);
+                sequence--;
+                used     = LOG_PAGE_ENTRIES;
+                if( (Log_PageValid( page, &found ) == FALSE) || (found != sequence) )
+                {
+                    break;
+                }
+            }
+        }
+    }
+
+    return address;
+}
+
+/**
+* @brief   **Sends the next entries of a read**
+*
+*   Each entry is sent as it is on flash, the frames are only sent when the CAN can take
+*   them, otherwise they are sent on the next call.
+*/
+static void Log_Stream( void )
+{
+    uint8_t frame[LOG_ENTRY_SIZE];
+    uint32_t address;
+
+    for( uint8_t i = 0u; (i < LOG_FRAMES_PER_TASK) && (Reading == TRUE) && (Erasing == FALSE); i++ )
+    {
+        address = Log_Address( ReadSkip );
+        if( address == LOG_NONE )
+        {
+            (void)memset( frame, (int)LOG_BYTE_MASK, sizeof(frame) );
+        }
+        else
+        {
+            (void)memcpy( frame, (const void *)address, sizeof(frame) );   /* cppcheck-suppress misra-c2012-11.6 ; the entry is on a flash address */
+        }
+
+        if( Serial_LogFrameTx( frame ) == TRUE )
+        {
+            ReadSkip++;
+            ReadCount--;
+            if( (address == LOG_NONE) || (ReadCount == 0u) )
+            {
+                Reading = FALSE;
+            }
+        }
+        else
+        {
+            break;
+        }
+    }
+}
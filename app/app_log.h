@@ -0,0 +1,57 @@
+/**
+* @file    <app_log.h>
+* @brief   **Header file for app_log.c**
+*
+*   This file contains the declaration for the functions on the .c file,
+*   the format of an entry of the log and the events that are logged.
+*   To use this aplication you need to first call the Log_Init function after
+*   Clock_Init and then you can call the Log_Task function, Log_Event can be
+*   called from any task or interrupt, the events before Log_Init are ignored.
+* @note    The entries are kept on RAM until a batch is ready, an entry logged right
+*          before a reset can be lost, except the safe state that is written right away
+*/
+#ifndef APP_LOG_H__
+#define APP_LOG_H__
+
+#include "app_bsp.h"
+
+/**
+  * @defgroup Log_events events of the log and their data
+  @{ */
+#define LOG_EVENT_BOOT          1u   /*!< Start of the program, data 0 is the reset flags of RCC_CSR bits 24 to 31*/
+#define LOG_EVENT_SAFE_STATE    2u   /*!< Safe state, data 0 is the error and data 1 and 2 the line*/
+#define LOG_EVENT_ALARM         3u   /*!< Alarm ringing, data 0 is the slot of the alarm table*/
+#define LOG_EVENT_SET_TIME      4u   /*!< Time set by CAN, data is the change in seconds as signed 24 bits*/
+#define LOG_EVENT_SET_DATE      5u   /*!< Date set by CAN, data 0 day, data 1 month and data 2 year*/
+#define LOG_EVENT_CAN_STATE     6u   /*!< CAN node state changed, data 0 state, data 1 TEC and data 2 REC*/
+#define LOG_EVENT_LOST          7u   /*!< Entries lost because the RAM buffer was full, data 0 number of entries*/
+/**
+  @} */
+
+/**
+  * @defgroup Log_values log values
+  @{ */
+#define LOG_DATA_SIZE           3u   /*!< Bytes of data of one entry*/
+#define LOG_ALL                 0u   /*!< Number of entries to read all the log*/
+#define LOG_DELTA_MAX           0x7FFFFF  /*!< Max change of time that fits on the signed 24 bits of LOG_EVENT_SET_TIME*/
+/**
+  @} */
+
+/**
+* @brief   Entry of the log, one flash double word
+*/
+typedef struct _LOG_EntryTypeDef
+{
+  uint32_t time;                  /*!< Seconds since 2000-01-01 00:00:00, 0xFFFFFFFF is an erased entry */
+  uint8_t  id;                    /*!< Event, a value of @ref Log_events */
+  uint8_t  data[LOG_DATA_SIZE];   /*!< Data of the event */
+} LOG_EntryTypeDef;
+
+void Log_Init( void );
+void Log_Task( void );
+void Log_Event( uint8_t id, uint8_t data0, uint8_t data1, uint8_t data2 );
+void Log_Read( uint16_t skip, uint8_t count );
+void Log_Fatal( uint8_t error, uint32_t line );
+void Log_EraseCallback( void );
+
+#endif
@@ -0,0 +1,192 @@
+/**
+* @file    app_menu.c
+* @brief   **Menu of pages driven by the button**
+*
+*   The display gives the gestures of the button to Menu_Gesture, that changes the page or
+*   runs its action, and calls Menu_Task to go back to the clock. Both tell the display when
+*   something changed so the lcd is only redrawn then or when the clock sends a new second,
+*   the pages are never polled.
+*   Without presses the menu goes back to the clock after 30 seconds.
+*/
+#include "app_menu.h"
+#include "app_display.h"
+#include "app_config.h"
+#include "app_alarms.h"
+#include "app_button.h"
+#include "hil_queue.h"
+
+/**
+  * @defgroup Menu_times times of the menu in ms
+  @{ */
+#define MENU_TIMEOUT_MS         30000u   /*!< Time without presses to go back to the clock*/
+/**
+  @} */
+
+/**
+ * @brief  Page shown and alarm of the table shown on the alarms page
+ */
+static uint8_t Page;
+static uint8_t Slot;
+
+/**
+ * @brief  Time of the last gesture, to go back to the clock
+ */
+static uint32_t Gesture_Tick;
+
+static void Menu_Action( void );
+
+/**
+* @brief   **This function initializes the menu**
+*
+*   The menu starts on the clock page.
+*/
+void Menu_Init( void )
+{
+    Page         = MENU_PAGE_HOME;
+    Slot         = 0u;
+    Gesture_Tick = HAL_GetTick();
+}
+
+/**
+* @brief   **This function checks the time of the menu, it is called by the display task**
+*
+* @retval  TRUE if the menu went back to the clock and the lcd has to be redrawn, otherwise FALSE
+*/
+uint8_t Menu_Task( void )
+{
+    uint8_t redraw = FALSE;
+
+    if( (Page != MENU_PAGE_HOME) && ((HAL_GetTick() - Gesture_Tick) >= MENU_TIMEOUT_MS) )
+    {
+        Page   = MENU_PAGE_HOME;
+        redraw = TRUE;
+    }
+
+    return redraw;
+}
+
+/**
+* @brief   **This function runs a gesture of the button on the menu**
+*
+*   A short press goes to the next page, a double press goes to the next alarm on the
+*   alarms page or back to the clock on the rest and a long press runs the action of the page.
+*
+* @param   gesture[in]  BUTTON_EVENT_SHORT, BUTTON_EVENT_LONG or BUTTON_EVENT_DOUBLE
+*
+* @retval  TRUE if something changed, otherwise FALSE
+*/
+uint8_t Menu_Gesture( uint8_t gesture )
+{
+    uint8_t changed = TRUE;
+
+    switch( gesture )
+    {
+        case BUTTON_EVENT_SHORT:
+            Page = (Page >= (MENU_PAGES - 1u)) ? MENU_PAGE_HOME : (Page + 1u);
+        break;
+
+        case BUTTON_EVENT_DOUBLE:
+            if( Page == MENU_PAGE_ALARMS )
+            {
+                Slot = (Slot >= (ALARMS_NUMBER - 1u)) ? 0u : (Slot + 1u);
+            }
+            else
+            {
+                Page = MENU_PAGE_HOME;
+            }
+        break;
+
+        case BUTTON_EVENT_LONG:
+            Menu_Action();
+        break;
+
+        default:
+            changed = FALSE;
+        break;
+    }
+
+    if( changed == TRUE )
+    {
+        Gesture_Tick = HAL_GetTick();
+    }
+
+    return changed;
+}
+
+/**
+* @brief   **This function gets the page shown**
+*
+* @retval  page, one of @ref Menu_pages
+*/
+uint8_t Menu_GetPage( void )
+{
+    return Page;
+}
+
+/**
+* @brief   **This function gets the alarm shown on the alarms page**
+*
+* @retval  slot of the alarm table
+*/
+uint8_t Menu_GetSlot( void )
+{
+    return Slot;
+}
+
+/**
+* @brief   **This function runs the action of the page with a long press**
+*
+*   The clock changes the big digits mode, the alarms page enables or disables the alarm
+*   shown through the clock task so it is programmed again and saved, the temperature page
+*   resets the min and max and the diagnostics page steps the contrast from the pot to 0..15
+*   and back to the pot, the contrast is saved on the configuration.
+*/
+static void Menu_Action( void )
+{
+    static uint8_t big_digits = FALSE;
+    APP_MsgTypeDef ClockMsg = {0};
+    APP_AlarmTypeDef alarm;
+    uint8_t contrast;
+
+    switch( Page )
+    {
+        case MENU_PAGE_HOME:
+            big_digits = (big_digits == TRUE) ? FALSE : TRUE;
+            Display_SetBigDigits( big_digits );
+        break;
+
+        case MENU_PAGE_ALARMS:
+            if( Alarms_Get( Slot, &alarm ) == TRUE )
+            {
+                ClockMsg.msg          = CLOCK_MSG_ENABLE_ALARM;
+                ClockMsg.alarm_slot   = Slot;
+                ClockMsg.alarm_enable = (alarm.enable == TRUE) ? FALSE : TRUE;
+                (void)HIL_QUEUE_Write( &SERIAL_queue, &ClockMsg );
+            }
+        break;
+
+        case MENU_PAGE_TEMPERATURE:
+            Display_ResetTemperature();
+        break;
+
+        case MENU_PAGE_DIAGNOSTICS:
+            contrast = Config_Get()->contrast;
+            if( contrast == CONFIG_NO_CONTRAST )
+            {
+                contrast = 0u;
+            }
+            else if( contrast >= CONFIG_MAX_CONTRAST )
+            {
+                contrast = CONFIG_NO_CONTRAST;
+            }
+            else
+            {
+                contrast++;
+            }
+            Config_SetNode( Config_Get()->node_id, contrast );
+        break;
+
+        default:
+        break;
+    }
+}
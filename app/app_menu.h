@@ -0,0 +1,38 @@
+/**
+* @file    <app_menu.h>
+* @brief   **Header file for app_menu.c**
+*
+*   This file contains the declaration for the functions on the .c file
+*   and the pages of the menu of the button.
+*   To use this aplication you need to first call the Menu_Init function and then
+*   the display calls Menu_Task periodically and Menu_Gesture with the gestures of
+*   the button.
+* @note    A short press goes to the next page, a double press goes to the next alarm
+*          on the alarms page or back to the clock on the rest, a long press runs the
+*          action of the page
+*/
+#ifndef APP_MENU_H__
+#define APP_MENU_H__
+
+#include "app_bsp.h"
+
+/**
+  * @defgroup Menu_pages pages of the menu
+  @{ */
+#define MENU_PAGE_HOME          0u   /*!< Clock, long press changes the big digits mode*/
+#define MENU_PAGE_TIME          1u   /*!< Time and time zone*/
+#define MENU_PAGE_DATE          2u   /*!< Date and day of the year*/
+#define MENU_PAGE_ALARMS        3u   /*!< One alarm of the table, long press enables or disables it*/
+#define MENU_PAGE_TEMPERATURE   4u   /*!< Temperature with its min and max, long press resets them*/
+#define MENU_PAGE_DIAGNOSTICS   5u   /*!< CAN state and contrast, long press changes the contrast*/
+#define MENU_PAGES              6u   /*!< Number of pages*/
+/**
+  @} */
+
+void Menu_Init( void );
+uint8_t Menu_Task( void );
+uint8_t Menu_Gesture( uint8_t gesture );
+uint8_t Menu_GetPage( void );
+uint8_t Menu_GetSlot( void );
+
+#endif
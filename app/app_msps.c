@@ -86,24 +86,28 @@ void HAL_RTC_MspInit( RTC_HandleTypeDef* hrtc )     /* cppcheck-suppress misra-c
     HAL_PWR_EnableBkUpAccess();
     __HAL_RCC_LSEDRIVE_CONFIG( RCC_LSEDRIVE_LOW );
 
-    /*reset previous RTC source clock*/
-    PeriphClkInitStruct.PeriphClockSelection = RCC_PERIPHCLK_RTC;
-    PeriphClkInitStruct.RTCClockSelection = RCC_RTCCLKSOURCE_NONE;
-    Status = HAL_RCCEx_PeriphCLKConfig( &PeriphClkInitStruct );
-    assert_error( Status == HAL_OK, RCCEX_PRIPH_CLK_CONF_ERROR );   /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-
-    /* Configure LSE/LSI as RTC clock source */
-    RCC_OscInitStruct.OscillatorType =  RCC_OSCILLATORTYPE_LSI | RCC_OSCILLATORTYPE_LSE;
-    RCC_OscInitStruct.PLL.PLLState = RCC_PLL_NONE;
-    RCC_OscInitStruct.LSEState = RCC_LSE_ON;
-    RCC_OscInitStruct.LSIState = RCC_LSI_OFF;
-    Status = HAL_RCC_OscConfig( &RCC_OscInitStruct );
-    assert_error( Status == HAL_OK, RCC_OSC_CONF_ERROR );   /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-
-    /*Set LSE as source clock*/
-    PeriphClkInitStruct.RTCClockSelection = RCC_RTCCLKSOURCE_LSE;
-    Status = HAL_RCCEx_PeriphCLKConfig( &PeriphClkInitStruct );
-    assert_error( Status == HAL_OK, RCCEX_PRIPH_CLK_CONF_ERROR );   /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+    /*changing the RTC source clock resets the backup domain, it is only done if the RTC is not running from the LSE*/
+    if( (__HAL_RCC_GET_RTC_SOURCE() != RCC_RTCCLKSOURCE_LSE) || (__HAL_RCC_GET_FLAG( RCC_FLAG_LSERDY ) == 0u) )
+    {
+        /*reset previous RTC source clock*/
+        PeriphClkInitStruct.PeriphClockSelection = RCC_PERIPHCLK_RTC;
+        PeriphClkInitStruct.RTCClockSelection = RCC_RTCCLKSOURCE_NONE;
+        Status = HAL_RCCEx_PeriphCLKConfig( &PeriphClkInitStruct );
+        assert_error( Status == HAL_OK, RCCEX_PRIPH_CLK_CONF_ERROR );   /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+
+        /* Configure LSE/LSI as RTC clock source */
+        RCC_OscInitStruct.OscillatorType =  RCC_OSCILLATORTYPE_LSI | RCC_OSCILLATORTYPE_LSE;
+        RCC_OscInitStruct.PLL.PLLState = RCC_PLL_NONE;
+        RCC_OscInitStruct.LSEState = RCC_LSE_ON;
+        RCC_OscInitStruct.LSIState = RCC_LSI_OFF;
+        Status = HAL_RCC_OscConfig( &RCC_OscInitStruct );
+        assert_error( Status == HAL_OK, RCC_OSC_CONF_ERROR );   /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+
+        /*Set LSE as source clock*/
+        PeriphClkInitStruct.RTCClockSelection = RCC_RTCCLKSOURCE_LSE;
+        Status = HAL_RCCEx_PeriphCLKConfig( &PeriphClkInitStruct );
+        assert_error( Status == HAL_OK, RCCEX_PRIPH_CLK_CONF_ERROR );   /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+    }
       
     /* Peripheral clock enable */
     __HAL_RCC_RTC_ENABLE();
@@ -125,6 +129,24 @@ void HAL_SPI_MspInit( SPI_HandleTypeDef *hspi )     /* cppcheck-suppress misra-c
     GPIO_InitStruct.Alternate = GPIO_AF1_SPI1;
     HAL_GPIO_Init(GPIOD, &GPIO_InitStruct);
 
+    /*DMA1 channel 2 sends the characters of the lcd*/
+    static DMA_HandleTypeDef DmaSpiHandler;
+    __HAL_RCC_DMA1_CLK_ENABLE();
+    DmaSpiHandler.Instance                  = DMA1_Channel2;
+    DmaSpiHandler.Init.Request              = DMA_REQUEST_SPI1_TX;     /*request from the spi transmition*/
+    DmaSpiHandler.Init.Direction            = DMA_MEMORY_TO_PERIPH;    /*transfer data from memory to the spi*/
+    DmaSpiHandler.Init.PeriphInc            = DMA_PINC_DISABLE;        /*do not increment peripheral address*/
+    DmaSpiHandler.Init.MemInc               = DMA_MINC_ENABLE;         /*increment memory address*/
+    DmaSpiHandler.Init.PeriphDataAlignment  = DMA_PDATAALIGN_BYTE;     /*1 byte transactions*/
+    DmaSpiHandler.Init.MemDataAlignment     = DMA_MDATAALIGN_BYTE;     /*1 byte transactions*/
+    DmaSpiHandler.Init.Mode                 = DMA_NORMAL;              /*one transfer each time*/
+    DmaSpiHandler.Init.Priority             = DMA_PRIORITY_LOW;        /*the adc keeps the high priority*/
+    Status = HAL_DMA_Init( &DmaSpiHandler );
+    assert_error( Status == HAL_OK, SPI_INIT_ERROR );       /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+    __HAL_LINKDMA( hspi, hdmatx, DmaSpiHandler );
+
+    HAL_NVIC_SetPriority(DMA1_Channel2_3_IRQn, 2, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Channel2_3_IRQn);
     HAL_NVIC_SetPriority(SPI1_IRQn, 2, 0);
     HAL_NVIC_EnableIRQ(SPI1_IRQn);
 }
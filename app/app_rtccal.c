@@ -0,0 +1,242 @@
+/**
+* @file    app_rtccal.c
+* @brief   **Temperature compensation of the RTC**
+*
+*   The LSE crystal changes its frequency with the temperature following a parabola, around
+*   -0.034 ppm/C^2 away from 25 C, so at 0 C the clock is 21 ppm slow, almost one minute per month.
+*   This file averages the die temperature measured by app_analog, gets the frequency error
+*   from the crystal curve and programs the RTC smooth calibration to cancel it. The offset of
+*   the curve is learned from the error measured each time the time is set through CAN.
+*/
+#include "app_rtccal.h"
+#include "app_analog.h"
+#include "app_config.h"
+
+/**
+  * @defgroup RtcCal_conf compensation configuration
+  @{ */
+#define RTCCAL_SAMPLES_SHIFT    5u          /*!< 32 temperature samples are averaged, one every task period*/
+#define RTCCAL_SAMPLES          (1u << RTCCAL_SAMPLES_SHIFT)    /*!< Number of samples, one smooth calibration window of 32 s*/
+#define RTCCAL_TENTHS           10          /*!< The samples are in tenths of C*/
+/**
+  @} */
+
+/**
+  * @defgroup RtcCal_smooth values of the smooth calibration, one pulse every 2^20 RTCCLK cycles is 0.9537 ppm
+  @{ */
+#define RTCCAL_MAX_PPB          480000      /*!< Max correction in ppb that the smooth calibration can apply*/
+#define RTCCAL_PULSE_MAGIC      4398u       /*!< (2^20 / 10^9) * 2^22, ppb to pulses with a multiplication*/
+#define RTCCAL_PULSE_SHIFT      22u         /*!< Shift for RTCCAL_PULSE_MAGIC*/
+#define RTCCAL_PLUS_PULSES      512u        /*!< Pulses added when CALP is set*/
+#define RTCCAL_MAX_MINUS        511u        /*!< Max value of CALM*/
+/**
+  @} */
+
+/**
+  * @defgroup RtcCal_learn limits to learn the offset from a sync
+  @{ */
+#define RTCCAL_LEARN_MIN_TIME   86400u      /*!< At least one day between syncs, with 1 s of resolution that is 11 ppm*/
+#define RTCCAL_LEARN_MAX_TIME   7776000u    /*!< No more than 90 days between syncs*/
+#define RTCCAL_LEARN_MAX_PPB    50000       /*!< Errors bigger than 50 ppm are a time change not a sync*/
+#define RTCCAL_LEARN_GAIN       2           /*!< Part of the error applied to the offset, half on each sync*/
+#define RTCCAL_HALF_DAY         43200       /*!< Seconds of half a day, the sync only has the time of the day*/
+#define RTCCAL_PPB              1000000000  /*!< Parts per billion*/
+/**
+  @} */
+
+/**
+* @brief  Crystal curve used to calculate the correction
+*/
+static RtcCal_CurveTypeDef Curve;
+
+/**
+* @brief  Sum of the temperature samples and number of samples
+*/
+static int32_t TempSum;
+static uint8_t TempSamples;
+
+/**
+* @brief  Correction applied in ppb and value programmed on the smooth calibration
+*/
+static int32_t Correction;
+static uint32_t PlusPulses;
+static uint32_t MinusPulses;
+
+/**
+* @brief  Time of the last sync and flag to know if there was one
+*/
+static HIL_TIME_EpochTypeDef LastSync;
+static uint8_t SyncValid;
+
+static void RtcCal_Apply( int32_t temperature );
+
+/**
+* @brief   **Init function for the RTC compensation**
+*
+*   The curve is the one stored on flash, by default the typical 32.768 kHz crystal with the
+*   turnover at 25 C, and the offset learned before the reset is taken from the backup registers
+*   if the RTC kept running. The RTC starts with no calibration until the first average is ready.
+*/
+void RtcCal_Init( void )
+{
+    int32_t offset;
+
+    Curve = Config_Get()->curve;
+    if( Config_GetCalOffset( &offset ) == TRUE )
+    {
+        Curve.offset = offset;
+    }
+
+    TempSum     = 0;
+    TempSamples = 0u;
+    Correction  = 0;
+    PlusPulses  = RTC_SMOOTHCALIB_PLUSPULSES_RESET;
+    MinusPulses = 0u;
+    SyncValid   = FALSE;
+
+    Status = HAL_RTCEx_SetSmoothCalib( &hrtc, RTC_SMOOTHCALIB_PERIOD_32SEC, PlusPulses, MinusPulses );
+    assert_error( Status == HAL_OK, RTC_SMOOTHCALIB_ERROR );   /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+}
+
+/**
+* @brief   **Task function for the RTC compensation**
+*
+*   Every call one temperature sample in tenths of C is added, once RTCCAL_SAMPLES are taken
+*   the sum of 32 samples divided by 10 is the average in 1/32 C, and the correction is applied.
+*   with a period of one second the calibration is updated once every smooth calibration window.
+*/
+void RtcCal_Task( void )
+{
+    TempSum += Analogs_GetTemperature();
+    TempSamples++;
+
+    if( TempSamples >= RTCCAL_SAMPLES )
+    {
+        RtcCal_Apply( TempSum / RTCCAL_TENTHS );
+        TempSum     = 0;
+        TempSamples = 0u;
+    }
+}
+
+/**
+* @brief   **Changes the crystal curve**
+*
+*   The new curve is used from the next average and it is stored on flash.
+*
+* @param   curve[in]   crystal curve, the turnover has to be between RTCCAL_MIN_TURNOVER and RTCCAL_MAX_TURNOVER
+*/
+void RtcCal_SetCurve( const RtcCal_CurveTypeDef *curve )
+{
+    Curve = *curve;
+    Config_SetCurve( curve );
+    Config_SetCalOffset( curve->offset );
+}
+
+/**
+* @brief   **Learns the offset of the curve from a time sync**
+*
+*   The time sent by CAN is compared with the time of the RTC, the error divided by the time
+*   since the last sync is the error of the curve, half of it is added to the offset so one
+*   bad sync does not ruin the calibration. Syncs too close, too far or with an error too big
+*   to be drift are only used as reference for the next one.
+*
+* @param   rtc_time[in]    time of the RTC before the sync
+* @param   real_time[in]   time recived
+*/
+void RtcCal_Sync( HIL_TIME_EpochTypeDef rtc_time, HIL_TIME_EpochTypeDef real_time )
+{
+    uint32_t elapsed = rtc_time - LastSync;
+    int32_t error = (int32_t)(real_time - rtc_time);
+    int32_t residual;
+
+    if( (SyncValid == TRUE) && (Curve.learn == TRUE) &&
+        (elapsed >= RTCCAL_LEARN_MIN_TIME) && (elapsed <= RTCCAL_LEARN_MAX_TIME) )
+    {
+        /*the sync only has the time of the day, an error bigger than half a day is on the other day*/
+        if( error > RTCCAL_HALF_DAY )
+        {
+            error -= (int32_t)HIL_TIME_SEC_PER_DAY;
+        }
+        else if( error < -RTCCAL_HALF_DAY )
+        {
+            error += (int32_t)HIL_TIME_SEC_PER_DAY;
+        }
+        else
+        {
+        }
+
+        residual = (int32_t)(((int64_t)error * RTCCAL_PPB) / (int64_t)elapsed);
+        if( (residual <= RTCCAL_LEARN_MAX_PPB) && (residual >= -RTCCAL_LEARN_MAX_PPB) )
+        {
+            /*the RTC was behind so the crystal is slower than the curve says*/
+            Curve.offset -= residual / RTCCAL_LEARN_GAIN;
+            Config_SetCalOffset( Curve.offset );
+        }
+    }
+
+    LastSync  = real_time;
+    SyncValid = TRUE;
+}
+
+/**
+* @brief   **Gets the correction applied to the RTC**
+*
+* @retval  correction in ppb, positive if the RTC is being speeded up
+*/
+int32_t RtcCal_GetCorrection( void )
+{
+    return Correction;
+}
+
+/**
+* @brief   **Calculates and programs the smooth calibration**
+*
+*   The frequency error is offset - k * dT^2 with dT in 1/32 C so the square is shifted 10 bits,
+*   the correction is the opposite of the error. One pulse is 2^20 / 10^9 ppb, to speed up
+*   the RTC 512 pulses are added with CALP and the extra ones are masked with CALM. The RTC
+*   is only written when the value changes since it has to wait for the previous calibration.
+*
+* @param   temperature[in]   average temperature in 1/32 C
+*/
+static void RtcCal_Apply( int32_t temperature )
+{
+    int32_t delta = temperature - ((int32_t)Curve.turnover << RTCCAL_SAMPLES_SHIFT);
+    int32_t drift = Curve.offset - (int32_t)(((uint32_t)Curve.k * (uint32_t)(delta * delta)) >> (2u * RTCCAL_SAMPLES_SHIFT));
+    uint32_t pulses;
+    uint32_t plus;
+    uint32_t minus;
+
+    Correction = -drift;
+    if( Correction > RTCCAL_MAX_PPB )
+    {
+        Correction = RTCCAL_MAX_PPB;
+    }
+    else if( Correction < -RTCCAL_MAX_PPB )
+    {
+        Correction = -RTCCAL_MAX_PPB;
+    }
+    else
+    {
+    }
+
+    if( Correction > 0 )
+    {
+        pulses = (((uint32_t)Correction * RTCCAL_PULSE_MAGIC) + (1u << (RTCCAL_PULSE_SHIFT - 1u))) >> RTCCAL_PULSE_SHIFT;
+        plus   = RTC_SMOOTHCALIB_PLUSPULSES_SET;
+        minus  = RTCCAL_PLUS_PULSES - pulses;
+    }
+    else
+    {
+        pulses = (((uint32_t)(-Correction) * RTCCAL_PULSE_MAGIC) + (1u << (RTCCAL_PULSE_SHIFT - 1u))) >> RTCCAL_PULSE_SHIFT;
+        plus   = RTC_SMOOTHCALIB_PLUSPULSES_RESET;
+        minus  = (pulses > RTCCAL_MAX_MINUS) ? RTCCAL_MAX_MINUS : pulses;
+    }
+
+    if( (plus != PlusPulses) || (minus != MinusPulses) )
+    {
+        Status = HAL_RTCEx_SetSmoothCalib( &hrtc, RTC_SMOOTHCALIB_PERIOD_32SEC, plus, minus );
+        assert_error( Status == HAL_OK, RTC_SMOOTHCALIB_ERROR );   /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+        PlusPulses  = plus;
+        MinusPulses = minus;
+    }
+}
@@ -0,0 +1,48 @@
+/**
+* @file    <app_rtccal.h>
+* @brief   **Header file for app_rtccal.c**
+*
+*   This file contains the declaration for the functions on the .c file
+*   and the structure with the crystal curve used to compensate the RTC.
+*   To use this aplication you need to first call the Clock_Init and Analogs_Init
+*   functions, then RtcCal_Init and then you can call the RtcCal_Task function.
+* @note    The correction is applied with the smooth calibration of the RTC,
+*          the range is -487 ppm to +488 ppm
+*/
+#ifndef APP_RTCCAL_H__
+#define APP_RTCCAL_H__
+
+#include "app_bsp.h"
+#include "hil_time.h"
+
+/**
+  * @defgroup RtcCal_limits values of the crystal curve
+  @{ */
+#define RTCCAL_MIN_TURNOVER     (-40)   /*!< Min turnover temperature of the crystal in C*/
+#define RTCCAL_MAX_TURNOVER     85      /*!< Max turnover temperature of the crystal in C*/
+#define RTCCAL_DEFAULT_K        34u     /*!< Default parabolic coefficient in ppb/C^2*/
+#define RTCCAL_DEFAULT_TURNOVER 25      /*!< Default turnover temperature in C*/
+/**
+  @} */
+
+/**
+* @brief   Structure with the frequency curve of the crystal
+*
+*   The frequency error of a 32.768 kHz tuning fork crystal is a parabola
+*   error = offset - k * (T - turnover)^2
+*/
+typedef struct _RtcCal_CurveTypeDef
+{
+  uint8_t k;            /*!< Parabolic coefficient in ppb/C^2, typical 34 */
+  int8_t  turnover;     /*!< Temperature in C where the crystal is fastest, typical 25 */
+  int32_t offset;       /*!< Frequency error at the turnover temperature in ppb, it is learned on sync events */
+  uint8_t learn;        /*!< TRUE to correct the offset with the error measured on each time sync */
+} RtcCal_CurveTypeDef;
+
+void RtcCal_Init( void );
+void RtcCal_Task( void );
+void RtcCal_SetCurve( const RtcCal_CurveTypeDef *curve );
+void RtcCal_Sync( HIL_TIME_EpochTypeDef rtc_time, HIL_TIME_EpochTypeDef real_time );
+int32_t RtcCal_GetCorrection( void );
+
+#endif
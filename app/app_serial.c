@@ -1,5 +1,14 @@
 #include "app_serial.h"
 #include "hil_queue.h"
+#include "app_canhealth.h"
+#include "app_alarms.h"
+#include "hil_time.h"
+#include "hil_tz.h"
+#include "app_rtccal.h"
+#include "app_config.h"
+#include "app_stopwatch.h"
+#include "app_log.h"
+#include <string.h>
 /** 
   * @defgroup CAN_conf values to use CAN.
   @{ */
@@ -13,6 +22,9 @@
   @{ */
 #define OK_CANID        0x55    /*!<correct information*/    
 #define FAILED_CANID    0xAA    /*!<incorrect information*/
+#define TX_ID_OFFSET    0x11u   /*!<the answer is sent with the ID of the node plus this value*/
+#define LOG_ID_OFFSET   0x12u   /*!<the entries of the log are sent with the ID of the node plus this value*/
+#define LOG_TX_FREE     2u      /*!<free places of the tx fifo needed to send a log entry, one is left for the answers*/
 /**
   @} */
 
@@ -22,24 +34,19 @@
 #define TIME_DATA_SIZE  4U      /*!<Data size needed for time state*/
 #define DATE_DATA_SIZE  5U      /*!<Data size needed for date state*/
 #define ALARM_DATA_SIZE 3U      /*!<Data size needed for alarm state*/
+#define ALARM_SLOT_DATA_SIZE 7U /*!<Data size needed for alarm slot state*/
+#define TZ_DATA_SIZE    3U      /*!<Data size needed for time zone state*/
+#define RTC_CAL_DATA_SIZE 6U    /*!<Data size needed for RTC compensation state*/
+#define CONFIG_DATA_SIZE  4U    /*!<Data size needed for configuration state*/
+#define STOPWATCH_DATA_SIZE 5U  /*!<Data size needed for stopwatch state*/
+#define LOG_READ_DATA_SIZE 4U   /*!<Data size needed for log state*/
 /**
   @} */
 
 /** 
-  * @defgroup months months values 
+  * @defgroup Date limits for the date message
   @{ */
-#define JAN 0x01u     /*!<JANUARY*/
-#define FEB 0x02u     /*!<FEBRUARY*/
-#define MAR 0x03u     /*!<MARCH*/
-#define APR 0x04u     /*!<APRIL*/
-#define MAY 0x05u     /*!<MAY*/
-#define JUN 0x06u     /*!<JUNE*/
-#define JUL 0x07u     /*!<JULY*/
-#define AUG 0x08u     /*!<AUGUST*/
-#define SEP 0x09u     /*!<SEPTEMBER*/
-#define OCT 0x10u    /*!<OCTOBER*/
-#define NOV 0x11u    /*!<NOVEMBER*/
-#define DEC 0x12u    /*!<DECEMBER*/
+#define CENTURY     20u     /*!<two most significant figures of the year, the RTC only counts 2000 to 2099*/
 /**
   @} */
 
@@ -52,6 +59,31 @@
 #define array_pos_3 3     /*!<array position 3*/
 #define array_pos_4 4     /*!<array position 4*/
 #define array_pos_5 5     /*!<array position 5*/
+#define array_pos_6 6     /*!<array position 6*/
+#define array_pos_7 7     /*!<array position 7*/
+/**
+  @} */
+
+/** 
+  * @defgroup Snooze limits for the alarm slot message
+  @{ */
+#define MAX_SNOOZE_TIME     60u     /*!<snooze time has to be less than 60 minutes*/
+#define MAX_SNOOZE_COUNT    0x09u   /*!<max number of snoozes for one alarm*/
+/**
+  @} */
+
+/** 
+  * @defgroup Time zone values for the time zone message
+  @{ */
+#define TZ_QUARTER_MINUTES  15      /*!<the offset is sent in quarters of hour*/
+/**
+  @} */
+
+/** 
+  * @defgroup RTC compensation values for the RTC compensation message
+  @{ */
+#define RTC_CAL_OFFSET_UNITS    10      /*!<the offset is sent in units of 10 ppb*/
+#define BYTE_SHIFT              8u      /*!<shift of the most significant byte of a 16 bit value*/
 /**
   @} */
 
@@ -63,9 +95,11 @@
 typedef enum
 /* cppcheck-suppress misra-c2012-2.4 ; enum is used on state machine */
 {
-    SERIAL_MSG_TIME = 1u,
+    SERIAL_MSG_NONE = 0u,
+    SERIAL_MSG_TIME,
     SERIAL_MSG_DATE,
     SERIAL_MSG_ALARM,
+    SERIAL_MSG_TZ = CLOCK_MSG_CHANGE_TZ,
 }APP_Messages;
 
 /**
@@ -82,6 +116,12 @@ typedef enum
     STATE_ALARM,
     STATE_FAILED,
     STATE_OK,
+    STATE_ALARM_SLOT,
+    STATE_TZ,
+    STATE_RTC_CAL,
+    STATE_CONFIG,
+    STATE_STOPWATCH,
+    STATE_LOG,
 }States;
 
 /**
@@ -104,11 +144,12 @@ static QUEUE_HandleTypeDef CAN_queue;
 */
 QUEUE_HandleTypeDef SERIAL_queue;
 
-static uint8_t valid_date(uint8_t day, uint8_t month, uint8_t yearM, uint8_t yearL);
-static uint8_t dayofweek(uint32_t yearM, uint32_t yearL, uint32_t month, uint32_t day);
-static uint8_t valid_time(uint8_t hour,uint8_t minutes,uint8_t seconds);
 static uint8_t valid_alarm(uint8_t hour,uint8_t minutes);
-static uint8_t bcdToDecimal(uint8_t bcdValue); 
+static uint8_t valid_alarm_slot(uint8_t slot,uint8_t days,uint8_t snooze,uint8_t snooze_max);
+static uint8_t valid_tz(int8_t offset,uint8_t rule);
+static uint8_t valid_rtc_cal(int8_t turnover,uint8_t learn);
+static uint8_t valid_config(uint16_t node_id,uint8_t contrast);
+static uint8_t valid_stopwatch(uint8_t command,uint8_t hours,uint8_t minutes,uint8_t seconds);
 static void Serial_StMachine(uint8_t cases );
 /**
 * @brief   **Init function fot serial task(CAN init)**
@@ -123,8 +164,8 @@ static void Serial_StMachine(uint8_t cases );
 *   The sample point is:
 *   Sp = ( CANHandler.Init.NominalTimeSeg1 +  1 / Ntq ) * 100
 *   Sp = ( ( 11 + 1 ) / 16 ) * 100 = 75%
-*   The filter is configurate so that it only accept messages with ID 0x111
-*   The transmition is configurate with ID 0x122
+*   The filter is configurate so that it only accept messages with the ID of the node stored
+*   on the configuration, 0x111 by default, the transmition is configurate with that ID plus 0x11
 *   since the CAN transmition speed is 100kbps the buffer array will be of 10 position considering 
 *   the following calculations:
 *   Number of can messages per second = speed of can transmition / can lenght
@@ -136,7 +177,6 @@ static void Serial_StMachine(uint8_t cases );
 void Serial_Init( void )
 {
     FDCAN_FilterTypeDef CANFilter;
-    CAN_td_message.tm.tm_year_msb = 20;
 
     CANHandler.Instance                 = FDCAN1;
     CANHandler.Init.Mode                = FDCAN_MODE_NORMAL;
@@ -155,12 +195,12 @@ void Serial_Init( void )
     
     Status = HAL_FDCAN_Init( &CANHandler );
     assert_error( Status == HAL_OK, FDCAN_CONFIG_ERROR );   /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-    /* Configure reception filter to Rx FIFO 0, this filter will only show messages of ID 0x111 */
+    /* Configure reception filter to Rx FIFO 0, this filter will only show messages of the node ID */
     CANFilter.IdType = FDCAN_STANDARD_ID;
     CANFilter.FilterIndex = 0;
     CANFilter.FilterType = FDCAN_FILTER_MASK;
     CANFilter.FilterConfig = FDCAN_FILTER_TO_RXFIFO0;
-    CANFilter.FilterID1 = 0x111;
+    CANFilter.FilterID1 = Config_Get()->node_id;
 
     Status = HAL_FDCAN_ConfigFilter( &CANHandler, &CANFilter );
     assert_error( Status == HAL_OK, FDCAN_CONFIG_FILTER_ERROR );    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
@@ -211,7 +251,7 @@ static void CanTp_SingleFrameTx( uint8_t *data, uint8_t *size )
     CANTxHeader.IdType      = FDCAN_STANDARD_ID;
     CANTxHeader.FDFormat    = FDCAN_CLASSIC_CAN;
     CANTxHeader.TxFrameType = FDCAN_DATA_FRAME;
-    CANTxHeader.Identifier  = 0x122;
+    CANTxHeader.Identifier  = (uint32_t)Config_Get()->node_id + TX_ID_OFFSET;
     CANTxHeader.DataLength  = FDCAN_DLC_BYTES_8;
     uint8_t CAN_msg[CAN_DATA_LENGHT]; 
     if(*size <= 8u )
@@ -221,9 +261,52 @@ static void CanTp_SingleFrameTx( uint8_t *data, uint8_t *size )
         {
             CAN_msg[i] = *(data+i-1u);      /* cppcheck-suppress misra-c2012-18.4 ; operators to pointers needed */
         }
+        /*while the node is bus off or the fifo is full the answer is dropped instead of going to the safe state*/
+        if( (CanHealth_IsBusOn() == TRUE) && (HAL_FDCAN_GetTxFifoFreeLevel( &CANHandler ) > 0u) )
+        {
+            Status = HAL_FDCAN_AddMessageToTxFifoQ( &CANHandler, &CANTxHeader, CAN_msg );
+            assert_error( Status == HAL_OK, FDCAN_ADDMESSAGE_ERROR );   /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+            CanHealth_FrameTx();
+        }
+        else
+        {
+            CanHealth_FrameDropped();
+        }
+    }
+}
+
+/**
+* @brief   **Transmit an entry of the log to the CAN**
+*
+*    The 8 bytes are sent as they are, without the single frame byte, with the ID of the node
+*    plus LOG_ID_OFFSET. The frame is only sent if the node is bus on and one place of the tx
+*    fifo stays free for the answers of the state machine.
+*
+* @param   *data[in] Pointer to the 8 bytes of the entry
+* @retval  TRUE if the frame was sent, FALSE if it has to be sent again later
+*/
+uint8_t Serial_LogFrameTx( const uint8_t *data )
+{
+    FDCAN_TxHeaderTypeDef CANTxHeader;
+    uint8_t CAN_msg[CAN_DATA_LENGHT];
+    uint8_t sent = FALSE;
+
+    CANTxHeader.IdType      = FDCAN_STANDARD_ID;
+    CANTxHeader.FDFormat    = FDCAN_CLASSIC_CAN;
+    CANTxHeader.TxFrameType = FDCAN_DATA_FRAME;
+    CANTxHeader.Identifier  = (uint32_t)Config_Get()->node_id + LOG_ID_OFFSET;
+    CANTxHeader.DataLength  = FDCAN_DLC_BYTES_8;
+
+    if( (CanHealth_IsBusOn() == TRUE) && (HAL_FDCAN_GetTxFifoFreeLevel( &CANHandler ) >= LOG_TX_FREE) )
+    {
+        (void)memcpy( CAN_msg, data, CAN_DATA_LENGHT );
         Status = HAL_FDCAN_AddMessageToTxFifoQ( &CANHandler, &CANTxHeader, CAN_msg );
         assert_error( Status == HAL_OK, FDCAN_ADDMESSAGE_ERROR );   /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+        CanHealth_FrameTx();
+        sent = TRUE;
     }
+
+    return sent;
 }
 
 /**
@@ -274,164 +357,144 @@ void HAL_FDCAN_RxFifo0Callback( FDCAN_HandleTypeDef *hfdcan, uint32_t RxFifo0ITs
         uint8_t Canmsg[CAN_DATA_LENGHT];
         Status = HAL_FDCAN_GetRxMessage( &CANHandler, FDCAN_RX_FIFO0, &CANRxHeader, Canmsg ); 
         assert_error( Status == HAL_OK, FDCAN_GETMESSAGE_ERROR );   /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+        CanHealth_FrameRx();
         (void)HIL_QUEUE_Write( &CAN_queue, Canmsg );
         
     }
 }
 
 /**
- * @brief   **This function gets the decimal value of a bcd  **
- *
- *  In this function, the input bcdValue is assumed to be an 8-bit value representing a number in BCD format. 
- *  The function extracts the tens digit and ones digit from the BCD value using bitwise operations and masks. 
- *  Then, it calculates the decimal value by multiplying the tens digit by 10 and adding the ones digit.
- *
- * @param   bcdValue[in] Indicates the bcd value that we want on decimal
- *
- * @retval  is a uint8_t can be any value        
- */
-uint8_t bcdToDecimal(uint8_t bcdValue) 
+* @brief   **The fucntion validates the parameters for alarm**
+*
+*  The values are binary, a BCD byte that was not valid is converted to HIL_TIME_INVALID_BCD
+*  so it is rejected here.
+*
+* @param   hour[in]        hour to be validated
+* @param   minutes[in]     minutes to be validated
+*
+* @retval  Time_is_valid[out]    if 0 if data is unvalid and 1 if it is valid
+*/
+uint8_t valid_alarm(uint8_t hour,uint8_t minutes)
 {
-    uint8_t tens = (bcdValue >> 4u) & 0x0Fu;  // Extract the tens digit
-    uint8_t ones = bcdValue & 0x0Fu;         // Extract the ones digit
-    uint8_t decimalValue = (tens * 10u) + ones;  // Compute the decimal value
+    uint8_t Time_is_valid = FALSE;
 
-    return decimalValue;
+    if((hour < 24u) && (minutes < 60u))
+    {
+        Time_is_valid = TRUE;
+    }
+    return Time_is_valid;
 }
 
 /**
-* @brief   **Function that checks if the date is valid**
-*
-* The fucntion checks the parameters so that they are a valid date
+* @brief   **The fucntion validates the extra parameters of an alarm slot**
 *
-* @param   day[in]       day of the month
-* @param   month[in]     month of the year
-* @param   year[in]      year of the date
+* @param   slot[in]        position on the alarm table
+* @param   days[in]        weekday mask, bit 0 monday to bit 6 sunday
+* @param   snooze[in]      snooze time in minutes
+* @param   snooze_max[in]  max number of snoozes
 *
-* @retval  if the day is valid it will return 1 otherwise a 0.
+* @retval  Slot_is_valid[out]    if 0 if data is unvalid and 1 if it is valid
 */
-uint8_t valid_date(uint8_t day, uint8_t month, uint8_t yearM, uint8_t yearL)
+uint8_t valid_alarm_slot(uint8_t slot,uint8_t days,uint8_t snooze,uint8_t snooze_max)
 {
-    uint32_t year = ((uint32_t)(yearM) * 100u) + (uint32_t)yearL;
-    uint32_t flagd = TRUE;
+    uint8_t Slot_is_valid = FALSE;
 
-    if ((day > 0x00u ) && (day <= 0x031u) && (month <= DEC) && (month >= JAN) && (yearM >= 0x19u) && (yearM <= 0x20u)) 
+    if((slot < ALARMS_NUMBER) && (days <= ALARMS_ALL_DAYS) && (snooze < MAX_SNOOZE_TIME) && (snooze_max <= MAX_SNOOZE_COUNT))
     {
+        Slot_is_valid = TRUE;
+    }
+    return Slot_is_valid;
+}
 
-        flagd = TRUE;
-
-        if ((month == JAN) || (month == MAR) || (month == MAY) || (month == JUL) || (month == AUG) || (month == OCT) || (month == DEC)) 
-        {
-            if (day > 0x31u)
-            {
-                flagd = FALSE;
-            }
-        } 
-        else if ((month == APR) || (month == JUN) || (month == SEP) || (month == NOV)) 
-        {
-            if (day > 0x30u) 
-            {
-                flagd = FALSE;
-            }
+/**
+* @brief   **The fucntion validates the parameters for the time zone**
+*
+* @param   offset[in]      offset of the standard time from UTC in quarters of hour
+* @param   rule[in]        daylight saving rule
+*
+* @retval  Tz_is_valid[out]    if 0 if data is unvalid and 1 if it is valid
+*/
+uint8_t valid_tz(int8_t offset,uint8_t rule)
+{
+    uint8_t Tz_is_valid = FALSE;
+    int16_t minutes = (int16_t)offset * TZ_QUARTER_MINUTES;
 
-        } 
-        else if (month == FEB) 
-        {
-            if ((((year % 4u) == 0u) && ((year % 100u) != 0u)) || ((year % 400u) == 0u)) 
-            {
-                if (day > 0x29u) 
-                {
-                    flagd = FALSE;
-                }
-            } 
-            else 
-            {
-                if (day > 0x28u) 
-                {
-                    flagd = FALSE;
-                }
-            }
-        } else{}
-    } 
-    else 
+    if((minutes >= HIL_TZ_MIN_OFFSET) && (minutes <= HIL_TZ_MAX_OFFSET) && (rule < HIL_TZ_RULES))
     {
-        flagd = FALSE;
+        Tz_is_valid = TRUE;
     }
-
-    return flagd;
+    return Tz_is_valid;
 }
 
 /**
-* @brief   **Gets the day of the week**
+* @brief   **The fucntion validates the parameters for the RTC compensation**
 *
-* this function take the date and uses the zeller's congruence formula to get the day of the week.
+* @param   turnover[in]    turnover temperature of the crystal in C
+* @param   learn[in]       TRUE to learn the offset, FALSE to keep it
 *
-* @param   day[in]       day of the month
-* @param   month[in]     month of the year
-* @param   year[in]      year of the date
-*
-* @retval  returns a value of the day of the week defines. 
+* @retval  Cal_is_valid[out]    if 0 if data is unvalid and 1 if it is valid
 */
-uint8_t dayofweek(uint32_t yearM, uint32_t yearL, uint32_t month, uint32_t day)
+uint8_t valid_rtc_cal(int8_t turnover,uint8_t learn)
 {
-    uint32_t year = ((uint32_t)(yearM) * 100u) + (uint32_t)yearL;
-    uint32_t m = month;
-    uint32_t c;
-    uint32_t y;
-    uint32_t d;
-    uint32_t w;
-   if (m < 3u) {
-        m += 12u;
-        year--;
-    }
-    c = year / 100u;
-    y = year - (100u * c);
-    d = day;
-    w = (( ((13u * m) + 3u) / 5u) + d + y + (y / 4u) + (c / 4u) - (2u * c));
-    w %= 7;
-    if (w < 0u)
+    uint8_t Cal_is_valid = FALSE;
+
+    if((turnover >= RTCCAL_MIN_TURNOVER) && (turnover <= RTCCAL_MAX_TURNOVER) && (learn <= TRUE))
     {
-        w += 7u;
+        Cal_is_valid = TRUE;
     }
-    return w;
+    return Cal_is_valid;
 }
 
 /**
-* @brief   **The fucntion validates the parameters for time**
+* @brief   **The fucntion validates the parameters for the configuration**
 *
-* @param   hour[in]        hour to be validated
-* @param   minutes[in]     minutes to be validated
-* @param   seconds[in]     seconds to be validated
+* @param   node_id[in]     CAN ID of the node
+* @param   contrast[in]    contrast of the lcd or CONFIG_NO_CONTRAST
 *
-* @retval  Time_is_valid[out]    if 0 if data is unvalid and 1 if it is valid
+* @retval  Config_is_valid[out]    if 0 if data is unvalid and 1 if it is valid
 */
-uint8_t valid_time(uint8_t hour,uint8_t minutes,uint8_t seconds)
+uint8_t valid_config(uint16_t node_id,uint8_t contrast)
 {
-    uint8_t Time_is_valid = FALSE;
-    if((hour < 0x24u) && (minutes < 0x60u) && (seconds < 0x60u))
+    uint8_t Config_is_valid = FALSE;
+
+    if((node_id != 0u) && (node_id <= CONFIG_MAX_NODE_ID) && ((contrast <= CONFIG_MAX_CONTRAST) || (contrast == CONFIG_NO_CONTRAST)))
     {
-        Time_is_valid = TRUE;
+        Config_is_valid = TRUE;
     }
-    return Time_is_valid;
+    return Config_is_valid;
 }
 
 /**
-* @brief   **The fucntion validates the parameters for alarm**
+* @brief   **The fucntion validates the parameters for the stopwatch**
 *
-* @param   hour[in]        hour to be validated
-* @param   minutes[in]     minutes to be validated
+*  The time is only used by the countdown command, it can not be zero.
 *
-* @retval  Time_is_valid[out]    if 0 if data is unvalid and 1 if it is valid
+* @param   command[in]     stopwatch command
+* @param   hours[in]       hours of the countdown
+* @param   minutes[in]     minutes of the countdown
+* @param   seconds[in]     seconds of the countdown
+*
+* @retval  Stopwatch_is_valid[out]    if 0 if data is unvalid and 1 if it is valid
 */
-uint8_t valid_alarm(uint8_t hour,uint8_t minutes)
+uint8_t valid_stopwatch(uint8_t command,uint8_t hours,uint8_t minutes,uint8_t seconds)
 {
-    uint8_t Time_is_valid = FALSE;
+    uint8_t Stopwatch_is_valid = FALSE;
 
-    if((hour < 0x24u) && (minutes < 0x60u))
+    if(command == STOPWATCH_CMD_COUNTDOWN)
     {
-        Time_is_valid = TRUE;
+        if((hours < 100u) && (minutes < 60u) && (seconds < 60u) && ((hours + minutes + seconds) != 0u))
+        {
+            Stopwatch_is_valid = TRUE;
+        }
     }
-    return Time_is_valid;
+    else if(command <= STOPWATCH_CMD_RESET)
+    {
+        Stopwatch_is_valid = TRUE;
+    }
+    else
+    {
+    }
+    return Stopwatch_is_valid;
 }
 
 static uint8_t Data_msg[CAN_DATA_LENGHT];
@@ -477,13 +540,25 @@ void Serial_Task( void )
 *   SERIAL_MSG_TIME it validates the values and if the values are correct they are store on the CAN_td_message variable
 *   and the variable is send to a queue with HIL_QUEUE_Write and cases value is change to STATE_OK. if they are not then
 *   cases will be STATE_FAILED.
-*   If cases is SERIAL_MSG_DATE it validates the values with the valid_date() function and if the date is valid
-*   it also calls the dayofweek function to get the day of the week if they are valid then they are store on the CAN_td_message variable 
+*   If cases is SERIAL_MSG_DATE it converts the BCD values and validates them with HIL_TIME_IsValid, if the date is valid
+*   it is stored as seconds since the epoch on the CAN_td_message variable, the clock gets the day of the week from it
 *   and the variable is send to a queue with HIL_QUEUE_Write and cases value is change to STATE_OK. if they are not then
 *   cases will be STATE_FAILED.
 *   if the value is SERIAL_MSG_ALARM it validates the data and if they are correct are store on the CAN_td_message variable and 
 *   the variable is send to a queue with HIL_QUEUE_Write and cases value is change to STATE_OK. if they are not then
 *   cases will be STATE_FAILED.
+*   if the value is STATE_ALARM_SLOT it validates the slot, time, weekday mask and snooze policy and sends them
+*   to the clock as a SERIAL_MSG_ALARM so that the alarm of that slot is configured.
+*   if the value is STATE_TZ it validates the UTC offset and the daylight saving rule and sends them
+*   to the clock as a SERIAL_MSG_TZ.
+*   if the value is STATE_RTC_CAL it validates the crystal curve and gives it directly to the RTC compensation,
+*   the clock gets a SERIAL_MSG_NONE so it does nothing.
+*   if the value is STATE_CONFIG it validates the node ID and the contrast and stores them on the configuration,
+*   the node ID is used after the next reset.
+*   if the value is STATE_STOPWATCH it validates the command and the countdown time and gives them
+*   directly to the stopwatch.
+*   if the value is STATE_LOG it starts a read of the event log, skip entries from the newest one
+*   and then count entries are sent by the log task after the answer.
 *   then if cases is STATE_FAILED a message will be send in can with an id that indicates that the message was not compatible
 *   and if cases is STATE_OK a message will be send in can with an id that indicates that the message correct.
 *   when an alarm is active this function will not send any message instead it will trigger the alarm flag
@@ -492,17 +567,27 @@ void Serial_Task( void )
 static void Serial_StMachine(uint8_t cases )
 {
     static uint8_t Event[CAN_DATA_LENGHT];
+    RtcCal_CurveTypeDef Curve;
+    uint16_t NodeId;
+    uint32_t Preset;
+    HIL_TIME_TmTypeDef CAN_tm;
+
     switch(cases)
     {
         case STATE_TIME:
 
             if(CAN_size == TIME_DATA_SIZE)
             {
-                if( valid_time(Data_msg[array_pos_2],Data_msg[array_pos_3],Data_msg[array_pos_4]) == TRUE)
+                /*the time is sent as the time of the first day of the epoch*/
+                CAN_tm.hour = HIL_TIME_BcdToBin(Data_msg[array_pos_2]);
+                CAN_tm.min  = HIL_TIME_BcdToBin(Data_msg[array_pos_3]);
+                CAN_tm.sec  = HIL_TIME_BcdToBin(Data_msg[array_pos_4]);
+                CAN_tm.mday = 1u;
+                CAN_tm.mon  = 1u;
+                CAN_tm.year = 0u;
+                if( HIL_TIME_IsValid(&CAN_tm) == TRUE)
                 {
-                    CAN_td_message.tm.tm_hour=Data_msg[array_pos_2];
-                    CAN_td_message.tm.tm_min=Data_msg[array_pos_3];
-                    CAN_td_message.tm.tm_sec=Data_msg[array_pos_4];
+                    CAN_td_message.time = HIL_TIME_ToEpoch(&CAN_tm);
                     CAN_td_message.msg=SERIAL_MSG_TIME;
                     Event[array_pos_0] = TRUE; 
                     Event[array_pos_1] = STATE_OK; 
@@ -520,13 +605,16 @@ static void Serial_StMachine(uint8_t cases )
         case STATE_DATE:
             if(CAN_size == DATE_DATA_SIZE)
             {
-                if(valid_date(Data_msg[array_pos_2],Data_msg[array_pos_3], Data_msg[array_pos_4],Data_msg[array_pos_5]) == TRUE)
+                /*the date is sent as the midnight of that day*/
+                CAN_tm.mday = HIL_TIME_BcdToBin(Data_msg[array_pos_2]);
+                CAN_tm.mon  = HIL_TIME_BcdToBin(Data_msg[array_pos_3]);
+                CAN_tm.year = HIL_TIME_BcdToBin(Data_msg[array_pos_5]);
+                CAN_tm.hour = 0u;
+                CAN_tm.min  = 0u;
+                CAN_tm.sec  = 0u;
+                if((HIL_TIME_BcdToBin(Data_msg[array_pos_4]) == CENTURY) && (HIL_TIME_IsValid(&CAN_tm) == TRUE))
                 {
-                    CAN_td_message.tm.tm_mday = Data_msg[array_pos_2];
-                    CAN_td_message.tm.tm_mon = Data_msg[array_pos_3];
-                    CAN_td_message.tm.tm_year_msb = bcdToDecimal(Data_msg[array_pos_4]);
-                    CAN_td_message.tm.tm_year_lsb = Data_msg[array_pos_5];
-                    CAN_td_message.tm.tm_wday = dayofweek(CAN_td_message.tm.tm_year_msb,CAN_td_message.tm.tm_year_lsb, CAN_td_message.tm.tm_mon, CAN_td_message.tm.tm_mday);
+                    CAN_td_message.time = HIL_TIME_ToEpoch(&CAN_tm);
                     CAN_td_message.msg = SERIAL_MSG_DATE;
                     Event[array_pos_0] = TRUE; 
                     Event[array_pos_1] = STATE_OK; 
@@ -544,10 +632,41 @@ static void Serial_StMachine(uint8_t cases )
         case STATE_ALARM:
             if(CAN_size == ALARM_DATA_SIZE)
             {
-                if(valid_alarm( Data_msg[array_pos_2],Data_msg[array_pos_3]) == TRUE)
+                if(valid_alarm( HIL_TIME_BcdToBin(Data_msg[array_pos_2]),HIL_TIME_BcdToBin(Data_msg[array_pos_3])) == TRUE)
+                {
+                    /*the single alarm message configures the first alarm of the table every day*/
+                    CAN_td_message.alarm_hour = HIL_TIME_BcdToBin(Data_msg[array_pos_2]);
+                    CAN_td_message.alarm_minute = HIL_TIME_BcdToBin(Data_msg[array_pos_3]);
+                    CAN_td_message.alarm_slot = 0u;
+                    CAN_td_message.alarm_days = ALARMS_ALL_DAYS;
+                    CAN_td_message.alarm_snooze = 0u;
+                    CAN_td_message.alarm_snooze_max = 0u;
+                    CAN_td_message.msg = SERIAL_MSG_ALARM;
+                    Event[array_pos_0] = TRUE; 
+                    Event[array_pos_1] = STATE_OK; 
+                    (void)HIL_QUEUE_WriteISR( &CAN_queue, Event, TIM16_FDCAN_IT0_IRQn  );
+                }
+                else
+                {
+                    Event[array_pos_0] = TRUE; 
+                    Event[array_pos_1] = STATE_FAILED; 
+                    (void)HIL_QUEUE_WriteISR( &CAN_queue, Event, TIM16_FDCAN_IT0_IRQn  );
+                }
+            }
+        break;
+
+        case STATE_ALARM_SLOT:
+            if(CAN_size == ALARM_SLOT_DATA_SIZE)
+            {
+                if((valid_alarm( HIL_TIME_BcdToBin(Data_msg[array_pos_3]),HIL_TIME_BcdToBin(Data_msg[array_pos_4])) == TRUE) &&
+                   (valid_alarm_slot( Data_msg[array_pos_2],Data_msg[array_pos_5],HIL_TIME_BcdToBin(Data_msg[array_pos_6]),Data_msg[array_pos_7]) == TRUE))
                 {
-                    CAN_td_message.tm.tm_hour=Data_msg[array_pos_2];
-                    CAN_td_message.tm.tm_min=Data_msg[array_pos_3];
+                    CAN_td_message.alarm_slot = Data_msg[array_pos_2];
+                    CAN_td_message.alarm_hour = HIL_TIME_BcdToBin(Data_msg[array_pos_3]);
+                    CAN_td_message.alarm_minute = HIL_TIME_BcdToBin(Data_msg[array_pos_4]);
+                    CAN_td_message.alarm_days = Data_msg[array_pos_5];
+                    CAN_td_message.alarm_snooze = HIL_TIME_BcdToBin(Data_msg[array_pos_6]);
+                    CAN_td_message.alarm_snooze_max = Data_msg[array_pos_7];
                     CAN_td_message.msg = SERIAL_MSG_ALARM;
                     Event[array_pos_0] = TRUE; 
                     Event[array_pos_1] = STATE_OK; 
@@ -562,6 +681,107 @@ static void Serial_StMachine(uint8_t cases )
             }
         break;
 
+        case STATE_TZ:
+            if(CAN_size == TZ_DATA_SIZE)
+            {
+                if(valid_tz( (int8_t)Data_msg[array_pos_2],Data_msg[array_pos_3]) == TRUE)
+                {
+                    CAN_td_message.tz_offset = (int8_t)Data_msg[array_pos_2];
+                    CAN_td_message.tz_rule = Data_msg[array_pos_3];
+                    CAN_td_message.msg = SERIAL_MSG_TZ;
+                    Event[array_pos_0] = TRUE; 
+                    Event[array_pos_1] = STATE_OK; 
+                    (void)HIL_QUEUE_WriteISR( &CAN_queue, Event, TIM16_FDCAN_IT0_IRQn  );
+                }
+                else
+                {
+                    Event[array_pos_0] = TRUE; 
+                    Event[array_pos_1] = STATE_FAILED; 
+                    (void)HIL_QUEUE_WriteISR( &CAN_queue, Event, TIM16_FDCAN_IT0_IRQn  );
+                }
+            }
+        break;
+
+        case STATE_RTC_CAL:
+            if(CAN_size == RTC_CAL_DATA_SIZE)
+            {
+                if(valid_rtc_cal( (int8_t)Data_msg[array_pos_3],Data_msg[array_pos_6]) == TRUE)
+                {
+                    Curve.k = Data_msg[array_pos_2];
+                    Curve.turnover = (int8_t)Data_msg[array_pos_3];
+                    Curve.offset = (int32_t)(int16_t)(((uint16_t)Data_msg[array_pos_4] << BYTE_SHIFT) | Data_msg[array_pos_5]) * RTC_CAL_OFFSET_UNITS;
+                    Curve.learn = Data_msg[array_pos_6];
+                    RtcCal_SetCurve( &Curve );
+                    CAN_td_message.msg = SERIAL_MSG_NONE;
+                    Event[array_pos_0] = TRUE; 
+                    Event[array_pos_1] = STATE_OK; 
+                    (void)HIL_QUEUE_WriteISR( &CAN_queue, Event, TIM16_FDCAN_IT0_IRQn  );
+                }
+                else
+                {
+                    Event[array_pos_0] = TRUE; 
+                    Event[array_pos_1] = STATE_FAILED; 
+                    (void)HIL_QUEUE_WriteISR( &CAN_queue, Event, TIM16_FDCAN_IT0_IRQn  );
+                }
+            }
+        break;
+
+        case STATE_CONFIG:
+            if(CAN_size == CONFIG_DATA_SIZE)
+            {
+                NodeId = ((uint16_t)Data_msg[array_pos_2] << BYTE_SHIFT) | Data_msg[array_pos_3];
+                if(valid_config( NodeId,Data_msg[array_pos_4]) == TRUE)
+                {
+                    Config_SetNode( NodeId, Data_msg[array_pos_4] );
+                    CAN_td_message.msg = SERIAL_MSG_NONE;
+                    Event[array_pos_0] = TRUE; 
+                    Event[array_pos_1] = STATE_OK; 
+                    (void)HIL_QUEUE_WriteISR( &CAN_queue, Event, TIM16_FDCAN_IT0_IRQn  );
+                }
+                else
+                {
+                    Event[array_pos_0] = TRUE; 
+                    Event[array_pos_1] = STATE_FAILED; 
+                    (void)HIL_QUEUE_WriteISR( &CAN_queue, Event, TIM16_FDCAN_IT0_IRQn  );
+                }
+            }
+        break;
+
+        case STATE_STOPWATCH:
+            if(CAN_size == STOPWATCH_DATA_SIZE)
+            {
+                CAN_tm.hour = HIL_TIME_BcdToBin(Data_msg[array_pos_3]);
+                CAN_tm.min  = HIL_TIME_BcdToBin(Data_msg[array_pos_4]);
+                CAN_tm.sec  = HIL_TIME_BcdToBin(Data_msg[array_pos_5]);
+                if(valid_stopwatch( Data_msg[array_pos_2],CAN_tm.hour,CAN_tm.min,CAN_tm.sec) == TRUE)
+                {
+                    Preset = ((((uint32_t)CAN_tm.hour * 60u) + CAN_tm.min) * 60u) + CAN_tm.sec;
+                    Stopwatch_Command( Data_msg[array_pos_2], Preset );
+                    CAN_td_message.msg = SERIAL_MSG_NONE;
+                    Event[array_pos_0] = TRUE; 
+                    Event[array_pos_1] = STATE_OK; 
+                    (void)HIL_QUEUE_WriteISR( &CAN_queue, Event, TIM16_FDCAN_IT0_IRQn  );
+                }
+                else
+                {
+                    Event[array_pos_0] = TRUE; 
+                    Event[array_pos_1] = STATE_FAILED; 
+                    (void)HIL_QUEUE_WriteISR( &CAN_queue, Event, TIM16_FDCAN_IT0_IRQn  );
+                }
+            }
+        break;
+
+        case STATE_LOG:
+            if(CAN_size == LOG_READ_DATA_SIZE)
+            {
+                Log_Read( (uint16_t)(((uint16_t)Data_msg[array_pos_2] << BYTE_SHIFT) | Data_msg[array_pos_3]), Data_msg[array_pos_4] );
+                CAN_td_message.msg = SERIAL_MSG_NONE;
+                Event[array_pos_0] = TRUE; 
+                Event[array_pos_1] = STATE_OK; 
+                (void)HIL_QUEUE_WriteISR( &CAN_queue, Event, TIM16_FDCAN_IT0_IRQn  );
+            }
+        break;
+
         case STATE_OK:
             (void)HIL_QUEUE_WriteISR( &SERIAL_queue, &CAN_td_message, TIM16_FDCAN_IT0_IRQn);
             Data_msg[array_pos_0]=OK_CANID;
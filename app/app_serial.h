@@ -16,6 +16,7 @@
 
 void Serial_Init( void );
 void Serial_Task( void );
+uint8_t Serial_LogFrameTx( const uint8_t *data );
 
 
 #endif
\ No newline at end of file
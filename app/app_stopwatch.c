@@ -0,0 +1,424 @@
+/**
+* @file    app_stopwatch.c
+* @brief   **Stopwatch and countdown timer**
+*
+*   The time base is TIM2 counting freely at 10 kHz, every event, a CAN command, a press of
+*   the button or the task itself, takes its time from a capture of the counter generated
+*   by software, so the count does not depend on when the task runs. The button events capture
+*   on channel 2 less their age and the task and the commands on channel 1, the elapsed time
+*   between captures is added to the count. The task runs every 10 ms and only sends to the
+*   lcd the characters of the second row that changed, usually one or two per period.
+*/
+#include "app_stopwatch.h"
+#include "hel_lcd.h"
+#include "hil_time.h"
+#include <string.h>
+
+/**
+  * @defgroup Stopwatch_timer time base values
+  @{ */
+#define STOPWATCH_TICK_HZ           10000u   /*!< Frequency of TIM2, 0.1 ms per tick*/
+#define STOPWATCH_TICKS_PER_CS      100u     /*!< Ticks of one hundredth of second*/
+#define STOPWATCH_TICKS_PER_SEC     10000u   /*!< Ticks of one second*/
+#define STOPWATCH_TICKS_PER_MS      10u      /*!< Ticks of one ms, the time unit of the button events*/
+#define STOPWATCH_LONG_PRESS_TICKS  10000u   /*!< Holding the button one second resets the count*/
+/**
+  @} */
+
+/**
+  * @defgroup Stopwatch_modes modes of the stopwatch
+  @{ */
+#define STOPWATCH_MODE_OFF          0u       /*!< The clock is shown*/
+#define STOPWATCH_MODE_UP           1u       /*!< Stopwatch counting up*/
+#define STOPWATCH_MODE_DOWN         2u       /*!< Countdown timer*/
+/**
+  @} */
+
+/**
+  * @defgroup Stopwatch_row layout of the second row of the lcd
+  @{ */
+#define STOPWATCH_ROW_SIZE          16u      /*!< Characters of one row*/
+#define STOPWATCH_COL_MODE          0u       /*!< Letter of the mode, S stopwatch or T timer*/
+#define STOPWATCH_COL_HOURS         3u       /*!< First digit of the hours, same column of the clock*/
+#define STOPWATCH_COL_MINUTES       6u       /*!< First digit of the minutes*/
+#define STOPWATCH_COL_SECONDS       9u       /*!< First digit of the seconds*/
+#define STOPWATCH_COL_CENTS         12u      /*!< First digit of the hundredths*/
+#define STOPWATCH_COL_END           15u      /*!< Mark of a countdown that reached zero*/
+#define SIXTY                       60u      /*!< Seconds of one minute and minutes of one hour*/
+#define HUNDRED                     100u     /*!< Hundredths of one second*/
+/**
+  @} */
+
+/**
+ * @brief  Variable for the time base timer
+ */
+static TIM_HandleTypeDef TimStopwatch;
+
+/**
+* @brief  Mode, count state and count in ticks, the count is the elapsed time until Start
+*/
+static uint8_t Mode;
+static uint8_t Running;
+static uint8_t Expired;
+static uint32_t Count;
+static uint32_t Start;
+static uint32_t Preset;
+
+/**
+* @brief  Captures of the button events
+*/
+static volatile uint32_t Press_Time;
+static volatile uint32_t Release_Time;
+static volatile uint8_t Press_Pending;
+static volatile uint8_t Release_Pending;
+
+/**
+* @brief  Flag to show the count and second row to show, with its end of string
+*/
+static uint8_t Show;
+static char Row[STOPWATCH_ROW_SIZE + 1u];
+
+static uint32_t Stopwatch_Capture( void );
+static uint32_t Stopwatch_Elapsed( uint32_t from, uint32_t to );
+static void Stopwatch_Toggle( uint32_t time );
+static void Stopwatch_Update( uint32_t now );
+static void Stopwatch_Format( void );
+static void Stopwatch_Draw( void );
+
+/**
+* @brief   **Init function for the stopwatch**
+*
+*   TIM2 is a 32 bit timer, with a prescaler to 10 kHz it goes around every 4.9 days, more than
+*   the 99:59:59 that can be shown. Channels 1 and 2 are configured as input capture from their
+*   pins, that are analog inputs of the ADC so they never see an edge, the captures are
+*   generated only by software. The timer clock is twice the APB clock when the APB is divided.
+*   Prescaler = (timer clock / 10 kHz) - 1
+*/
+void Stopwatch_Init( void )
+{
+    TIM_IC_InitTypeDef sConfig;
+    uint32_t TimerClock = HAL_RCC_GetPCLK1Freq();
+
+    if( (RCC->CFGR & RCC_CFGR_PPRE) != RCC_HCLK_DIV1 )
+    {
+        TimerClock *= 2u;
+    }
+
+    __HAL_RCC_TIM2_CLK_ENABLE();
+
+    TimStopwatch.Instance           = TIM2;
+    TimStopwatch.Init.Prescaler     = (TimerClock / STOPWATCH_TICK_HZ) - 1u;
+    TimStopwatch.Init.Period        = 0xFFFFFFFFu;
+    TimStopwatch.Init.CounterMode   = TIM_COUNTERMODE_UP;
+    Status = HAL_TIM_IC_Init( &TimStopwatch );
+    assert_error( Status == HAL_OK, STOPWATCH_TIM_INIT_ERROR );    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+
+    sConfig.ICPolarity  = TIM_ICPOLARITY_RISING;
+    sConfig.ICSelection = TIM_ICSELECTION_DIRECTTI;
+    sConfig.ICPrescaler = TIM_ICPSC_DIV1;
+    sConfig.ICFilter    = 0u;
+    Status = HAL_TIM_IC_ConfigChannel( &TimStopwatch, &sConfig, TIM_CHANNEL_1 );
+    assert_error( Status == HAL_OK, STOPWATCH_TIM_INIT_ERROR );    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+    Status = HAL_TIM_IC_ConfigChannel( &TimStopwatch, &sConfig, TIM_CHANNEL_2 );
+    assert_error( Status == HAL_OK, STOPWATCH_TIM_INIT_ERROR );    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+    Status = HAL_TIM_IC_Start( &TimStopwatch, TIM_CHANNEL_1 );
+    assert_error( Status == HAL_OK, STOPWATCH_TIM_INIT_ERROR );    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+    Status = HAL_TIM_IC_Start( &TimStopwatch, TIM_CHANNEL_2 );
+    assert_error( Status == HAL_OK, STOPWATCH_TIM_INIT_ERROR );    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+
+    Mode            = STOPWATCH_MODE_OFF;
+    Running         = FALSE;
+    Expired         = FALSE;
+    Count           = 0u;
+    Preset          = 0u;
+    Press_Pending   = FALSE;
+    Release_Pending = FALSE;
+    Show            = TRUE;
+}
+
+/**
+* @brief   **Task function for the stopwatch**
+*
+*   The button events are applied with the time they were captured, then the time since the
+*   last period is added to the count and the row is drawn. A countdown that reaches zero
+*   stops by itself, so does a stopwatch that reaches 99:59:59.99.
+*/
+void Stopwatch_Task( void )
+{
+    uint32_t now;
+
+    if( Mode != STOPWATCH_MODE_OFF )
+    {
+        now = Stopwatch_Capture();
+
+        if( Press_Pending == TRUE )
+        {
+            Press_Pending = FALSE;
+            Stopwatch_Toggle( Press_Time );
+        }
+        if( Release_Pending == TRUE )
+        {
+            Release_Pending = FALSE;
+            if( Stopwatch_Elapsed( Press_Time, Release_Time ) >= STOPWATCH_LONG_PRESS_TICKS )
+            {
+                Stopwatch_Command( STOPWATCH_CMD_RESET, 0u );
+            }
+        }
+
+        Stopwatch_Update( now );
+        if( Show == TRUE )
+        {
+            Stopwatch_Format();
+            Stopwatch_Draw();
+        }
+    }
+}
+
+/**
+* @brief   **Executes a command of the stopwatch**
+*
+*   The commands come from CAN or from the task, the start and stop take the time from a new
+*   capture. Entering a mode resets the count, leaving it clears the second row so the clock
+*   can use it again on the next second.
+*
+* @param   command[in]  a value of @ref Stopwatch_cmd
+* @param   preset[in]   seconds of the countdown, only used with STOPWATCH_CMD_COUNTDOWN
+*/
+void Stopwatch_Command( uint8_t command, uint32_t preset )
+{
+    uint32_t now = Stopwatch_Capture();
+
+    switch( command )
+    {
+        case STOPWATCH_CMD_OFF:
+            if( (Mode != STOPWATCH_MODE_OFF) && (Show == TRUE) )
+            {
+                (void)memset( Row, ' ', STOPWATCH_ROW_SIZE );
+                Stopwatch_Draw();
+            }
+            Mode    = STOPWATCH_MODE_OFF;
+            Running = FALSE;
+        break;
+
+        case STOPWATCH_CMD_STOPWATCH:
+        case STOPWATCH_CMD_COUNTDOWN:
+            Mode    = (command == STOPWATCH_CMD_STOPWATCH) ? STOPWATCH_MODE_UP : STOPWATCH_MODE_DOWN;
+            Preset  = (command == STOPWATCH_CMD_STOPWATCH) ? 0u : (preset * STOPWATCH_TICKS_PER_SEC);
+            Running = FALSE;
+            Expired = FALSE;
+            Count   = 0u;
+        break;
+
+        case STOPWATCH_CMD_START:
+            if( (Mode != STOPWATCH_MODE_OFF) && (Running == FALSE) )
+            {
+                Stopwatch_Toggle( now );
+            }
+        break;
+
+        case STOPWATCH_CMD_STOP:
+            if( Running == TRUE )
+            {
+                Stopwatch_Toggle( now );
+            }
+        break;
+
+        case STOPWATCH_CMD_RESET:
+            Running = FALSE;
+            Expired = FALSE;
+            Count   = 0u;
+        break;
+
+        default:
+        break;
+    }
+}
+
+/**
+* @brief   **Tells if the stopwatch is using the second row**
+*
+* @retval  TRUE if a mode is active, otherwise FALSE
+*/
+uint8_t Stopwatch_IsActive( void )
+{
+    return (Mode != STOPWATCH_MODE_OFF) ? TRUE : FALSE;
+}
+
+/**
+* @brief   **Captures the time of an edge of the button**
+*
+*   It is called with the debounced events of the button, the capture is moved back by the
+*   age of the event so the count takes the time of the first edge and not the end of the
+*   debounce. Only the capture is taken here and the task applies it, a press starts or stops
+*   the count and a release after a long press resets it.
+*
+* @param   pressed[in]  TRUE on the press, FALSE on the release
+* @param   age[in]      ms since the first edge of the press or release
+*/
+void Stopwatch_Button( uint8_t pressed, uint32_t age )
+{
+    uint32_t time;
+
+    TimStopwatch.Instance->EGR = TIM_EGR_CC2G;
+    time = __HAL_TIM_GET_COMPARE( &TimStopwatch, TIM_CHANNEL_2 ) - (age * STOPWATCH_TICKS_PER_MS);
+
+    if( pressed == TRUE )
+    {
+        Press_Time    = time;
+        Press_Pending = TRUE;
+    }
+    else
+    {
+        Release_Time    = time;
+        Release_Pending = TRUE;
+    }
+}
+
+/**
+* @brief   **Gives or takes the second row of the lcd**
+*
+*   The display takes the row while an alarm rings, the count goes on and once the row
+*   is given back the characters that differ from the framebuffer are drawn again.
+*
+* @param   show[in]  TRUE to draw the count, FALSE to leave the row to the display
+*/
+void Stopwatch_ShowRow( uint8_t show )
+{
+    Show = show;
+}
+
+/**
+* @brief   **Captures the counter of the time base**
+*
+*   The register is written directly instead of with HAL_TIM_GenerateEvent so the handle is
+*   not locked and the button events can capture on the other channel at any time.
+*
+* @retval  ticks of the timer
+*/
+static uint32_t Stopwatch_Capture( void )
+{
+    TimStopwatch.Instance->EGR = TIM_EGR_CC1G;
+    return __HAL_TIM_GET_COMPARE( &TimStopwatch, TIM_CHANNEL_1 );
+}
+
+/**
+* @brief   **Ticks between two captures**
+*
+*   A button capture can be older than the last capture of the task, in that case the
+*   difference is negative and no time is counted.
+*
+* @param   from[in]  first capture
+* @param   to[in]    second capture
+*
+* @retval  ticks from the first to the second capture, 0 if the second one is older
+*/
+static uint32_t Stopwatch_Elapsed( uint32_t from, uint32_t to )
+{
+    int32_t elapsed = (int32_t)(to - from);
+
+    return (elapsed > 0) ? (uint32_t)elapsed : 0u;
+}
+
+/**
+* @brief   **Starts or stops the count at the time of a capture**
+*
+*   A countdown that reached zero can not start again until it is reset.
+*
+* @param   time[in]  capture of the event
+*/
+static void Stopwatch_Toggle( uint32_t time )
+{
+    if( Running == TRUE )
+    {
+        Count  += Stopwatch_Elapsed( Start, time );
+        Running = FALSE;
+    }
+    else if( Expired == FALSE )
+    {
+        Start   = time;
+        Running = TRUE;
+    }
+    else
+    {
+    }
+}
+
+/**
+* @brief   **Adds the time since the last period to the count**
+*
+*   The count is limited to the preset of the countdown or to the max time of the stopwatch.
+*
+* @param   now[in]  capture of this period
+*/
+static void Stopwatch_Update( uint32_t now )
+{
+    uint32_t limit = (Mode == STOPWATCH_MODE_DOWN) ? Preset : ((STOPWATCH_MAX_SECONDS + 1u) * STOPWATCH_TICKS_PER_SEC) - STOPWATCH_TICKS_PER_CS;
+
+    if( Running == TRUE )
+    {
+        Count += Stopwatch_Elapsed( Start, now );
+        Start  = now;
+    }
+
+    /*a stop captured by the button or a command can also go beyond the limit*/
+    if( Count >= limit )
+    {
+        Count   = limit;
+        Running = FALSE;
+        Expired = (Mode == STOPWATCH_MODE_DOWN) ? TRUE : FALSE;
+    }
+}
+
+/**
+* @brief   **Writes the count on the row as characters**
+*
+*   The countdown is rounded up so it shows zero only when it finished.
+*   Hundredths of second = ticks / 100, then the fields are taken with divisions by 100 and 60,
+*   the digits are taken from the BCD table of the time library without more divisions.
+*/
+static void Stopwatch_Format( void )
+{
+    uint32_t cents;
+    uint32_t seconds;
+    uint32_t minutes;
+    uint32_t hours;
+
+    if( Mode == STOPWATCH_MODE_DOWN )
+    {
+        cents = ((Preset - Count) + (STOPWATCH_TICKS_PER_CS - 1u)) / STOPWATCH_TICKS_PER_CS;
+    }
+    else
+    {
+        cents = Count / STOPWATCH_TICKS_PER_CS;
+    }
+    seconds = cents / HUNDRED;
+    cents  -= seconds * HUNDRED;
+    minutes = seconds / SIXTY;
+    seconds-= minutes * SIXTY;
+    hours   = minutes / SIXTY;
+    minutes-= hours * SIXTY;
+
+    (void)memset( Row, ' ', STOPWATCH_ROW_SIZE );
+    Row[STOPWATCH_COL_MODE]         = (Mode == STOPWATCH_MODE_DOWN) ? 'T' : 'S';
+    HIL_TIME_BcdToAscii( HIL_TIME_BinToBcd( (uint8_t)hours ), &Row[STOPWATCH_COL_HOURS] );
+    Row[STOPWATCH_COL_HOURS + 2u]   = ':';
+    HIL_TIME_BcdToAscii( HIL_TIME_BinToBcd( (uint8_t)minutes ), &Row[STOPWATCH_COL_MINUTES] );
+    Row[STOPWATCH_COL_MINUTES + 2u] = ':';
+    HIL_TIME_BcdToAscii( HIL_TIME_BinToBcd( (uint8_t)seconds ), &Row[STOPWATCH_COL_SECONDS] );
+    Row[STOPWATCH_COL_SECONDS + 2u] = '.';
+    HIL_TIME_BcdToAscii( HIL_TIME_BinToBcd( (uint8_t)cents ), &Row[STOPWATCH_COL_CENTS] );
+    Row[STOPWATCH_COL_END]          = (Expired == TRUE) ? '!' : ' ';
+}
+
+/**
+* @brief   **Sends to the lcd the characters that changed**
+*
+*   The row is written on the framebuffer of the lcd and only the characters that are
+*   different from the ones on the lcd are sent, normally the hundredths.
+*/
+static void Stopwatch_Draw( void )
+{
+    HEL_LCD_Write( &LCDHandle, SECOND_ROW, 0u, Row );
+    Status = HEL_LCD_Flush( &LCDHandle );
+    assert_error( Status == HAL_OK, SPI_STRING_ERROR );     /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+}
@@ -0,0 +1,43 @@
+/**
+* @file    <app_stopwatch.h>
+* @brief   **Header file for app_stopwatch.c**
+*
+*   This file contains the declaration for the functions on the .c file
+*   and the commands accepted by the stopwatch and countdown modes.
+*   To use this aplication you need to first call the Display_Init function,
+*   then Stopwatch_Init and then you can call the Stopwatch_Task function.
+* @note    While a mode is active the stopwatch owns the second row of the lcd,
+*          the display only takes it back to show a ringing alarm
+*/
+#ifndef APP_STOPWATCH_H__
+#define APP_STOPWATCH_H__
+
+#include "app_bsp.h"
+
+/**
+  * @defgroup Stopwatch_cmd commands of the stopwatch, the same values are sent by CAN
+  @{ */
+#define STOPWATCH_CMD_OFF           0u   /*!< Leave the stopwatch mode and show the clock again*/
+#define STOPWATCH_CMD_STOPWATCH     1u   /*!< Enter the stopwatch mode, counting up from zero*/
+#define STOPWATCH_CMD_COUNTDOWN     2u   /*!< Enter the countdown mode, counting down from the preset*/
+#define STOPWATCH_CMD_START         3u   /*!< Start or resume the count*/
+#define STOPWATCH_CMD_STOP          4u   /*!< Stop the count*/
+#define STOPWATCH_CMD_RESET         5u   /*!< Stop the count and go back to zero or to the preset*/
+/**
+  @} */
+
+/**
+  * @defgroup Stopwatch_limits limits of the count
+  @{ */
+#define STOPWATCH_MAX_SECONDS       359999u  /*!< 99:59:59, the max count that fits on the lcd*/
+/**
+  @} */
+
+void Stopwatch_Init( void );
+void Stopwatch_Task( void );
+void Stopwatch_Command( uint8_t command, uint32_t preset );
+uint8_t Stopwatch_IsActive( void );
+void Stopwatch_Button( uint8_t pressed, uint32_t age );
+void Stopwatch_ShowRow( uint8_t show );
+
+#endif
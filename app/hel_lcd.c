@@ -25,77 +25,119 @@
 #define     DISPLAT_ON          0x0D    /*!< display on command */
 #define     ENTRY_MODE          0x06    /*!< entry mode command */
 #define     CLEAR_SCREEN        0x01    /*!< clear screen command */
+#define     RETURN_HOME         0x02    /*!< return home command, bit 0 is ignored */
+#define     FUNCTION_SET_IS0    0x38    /*!< function set with the instruction table 0, needed to write the CGRAM */
+#define     CGRAM_ADDRESS       0x40    /*!< set CGRAM address command, the address of a character is its number * 8 */
 /**
 @} */
 
+/** 
+* @defgroup Frame values of the framebuffer .
+@{ */
+#define     BLANK               ' '     /*!< character left by the clear screen command*/
+#define     UNKNOWN             '\0'    /*!< character on the glass copy when it is not known what the lcd shows*/
+/**
+@} */
+
+/** 
+* @defgroup Wait execution time of the commands in ticks of the timer, 10us each.
+@{ */
+#define     NO_WAIT             0u      /*!< the 32us of the next byte cover the 26.3us of the command*/
+#define     RESET_WAIT          100u    /*!< 1ms after the reset pin is released*/
+#define     CLEAR_WAIT          110u    /*!< 1.1ms, the clear screen and return home take 1.08ms*/
+#define     FOLLOWER_WAIT       20000u  /*!< 200ms to let the power of the follower circuit be stable*/
+/**
+@} */
+
+/** 
+* @defgroup Engine states of the transfers with DMA .
+@{ */
+#define     STATE_IDLE          0u      /*!< nothing to send*/
+#define     STATE_COMMAND       1u      /*!< a command of the queue is being sent*/
+#define     STATE_WAIT          2u      /*!< the timer waits the execution time of the last command*/
+#define     STATE_CURSOR        3u      /*!< the cursor of a group of changed characters is being sent*/
+#define     STATE_DATA          4u      /*!< the characters of the group are being sent*/
+#define     BUSY_TIMEOUT        10u     /*!< ms to wait for the queue before a blocking transfer*/
+#define     SPI_TIMEOUT         5000u   /*!< ms of timeout of the blocking transfers*/
+/**
+@} */
+
+static uint16_t Lcd_ExecTime( uint8_t cmd );
+static uint8_t Lcd_Wait( const LCD_HandleTypeDef *hlcd );
+static uint8_t Lcd_Queue( LCD_HandleTypeDef *hlcd, uint8_t cmd, uint16_t wait );
+static uint8_t Lcd_Free( const LCD_HandleTypeDef *hlcd );
+static uint8_t Lcd_Put( LCD_HandleTypeDef *hlcd, uint8_t head, uint8_t cmd, const uint8_t *data, uint8_t size, uint16_t wait );
+static uint8_t Lcd_Start( LCD_HandleTypeDef *hlcd );
+static void Lcd_Delay( const LCD_HandleTypeDef *hlcd, uint16_t wait );
+static uint8_t Lcd_Transfer( LCD_HandleTypeDef *hlcd, GPIO_PinState rs, uint8_t size );
+static uint8_t Lcd_Group( LCD_HandleTypeDef *hlcd );
+static uint8_t Lcd_Next( LCD_HandleTypeDef *hlcd );
+
 /**
 * @brief   **This function initializes the parameters for the LCD and SPI**
 *
 *  This function asignates the pins to a type LCD_HandleTypeDef structure
-*  Also Enables the pins by calling the HEL_LCD_MspInit function, then configure
-*  The SPI and proceeds to do an initialization rutine for the LCD 
+*  Also Enables the pins by calling the HEL_LCD_MspInit function, then resets
+*  the LCD and puts the initialization rutine on the command queue. The function
+*  returns right away, the commands are sent from the interrupts with the waits the
+*  LCD needs, and the framebuffer is sent after the last one.
 *
-* @retval  SPI_state[out]    State of the spi initialization
+* @retval  SPI_state[out]    State of the initialization, HAL_BUSY if the queue is full
+*
+* @note The SPI and the timer of hlcd have to be initialized before, the timer counting
+*       at HEL_LCD_TICK_HZ in one pulse mode with the update interrupt enabled
 */
 uint8_t HEL_LCD_Init( LCD_HandleTypeDef *hlcd )
 {
+    uint8_t Init_status = HAL_OK;
+    static const uint8_t Commands[] = { WAKEUP, WAKEUP, WAKEUP, FUNCTION_SET, INTERNAL_OSC_FREQ,
+                                        POWER_CONTROL, FOLLOWER_CONTROL, CONTRAST_COMMAND,
+                                        DISPLAT_ON, ENTRY_MODE, CLEAR_SCREEN };
+
     HEL_LCD_MspInit(hlcd);
     HAL_GPIO_WritePin( hlcd->CsPort, hlcd->CsPin, SET );
+    hlcd->Head  = 0u;
+    hlcd->Tail  = 0u;
+    hlcd->State = STATE_WAIT;
+    hlcd->Busy  = TRUE;
     
     /*LCD initialization rutine*/
-    HAL_GPIO_WritePin( GPIOD, hlcd->CsPin, SET );       
     HAL_GPIO_WritePin( GPIOD, hlcd->RstPin, RESET );    
-
     HAL_GPIO_WritePin( GPIOD, hlcd->RstPin, SET );
-    HAL_Delay(1);
-        /*SPI STATE WILL LATER BE USED ON FUNCTIONAL SAFETY*/
-    Status =  HEL_LCD_Command(hlcd, WAKEUP ); 
-    assert_error( Status == HAL_OK, SPI_COMMAND_ERROR );    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-
-    Status =  HEL_LCD_Command(hlcd, WAKEUP ); 
-    assert_error( Status == HAL_OK, SPI_COMMAND_ERROR );    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-    Status =  HEL_LCD_Command(hlcd, WAKEUP ); 
-    assert_error( Status == HAL_OK, SPI_COMMAND_ERROR );    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-    Status =  HEL_LCD_Command(hlcd, FUNCTION_SET ); 
-    assert_error( Status == HAL_OK, SPI_COMMAND_ERROR );    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-    Status =  HEL_LCD_Command(hlcd, INTERNAL_OSC_FREQ ); 
-    assert_error( Status == HAL_OK, SPI_COMMAND_ERROR );    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-    Status =  HEL_LCD_Command(hlcd, POWER_CONTROL ); 
-    assert_error( Status == HAL_OK, SPI_COMMAND_ERROR );    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-    Status =  HEL_LCD_Command(hlcd, FOLLOWER_CONTROL ); 
-    assert_error( Status == HAL_OK, SPI_COMMAND_ERROR );    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-     
-    Status =  HEL_LCD_Command(hlcd, CONTRAST_COMMAND ); 
-    assert_error( Status == HAL_OK, SPI_COMMAND_ERROR );    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-    Status =  HEL_LCD_Command(hlcd, DISPLAT_ON ); 
-    assert_error( Status == HAL_OK, SPI_COMMAND_ERROR );    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-    Status =  HEL_LCD_Command(hlcd, ENTRY_MODE ); 
-    assert_error( Status == HAL_OK, SPI_COMMAND_ERROR );    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
-    Status =  HEL_LCD_Command(hlcd, CLEAR_SCREEN ); 
-    
-    HAL_Delay(1);
-    return Status;
+
+    for( uint8_t i = 0u; (i < sizeof(Commands)) && (Init_status == HAL_OK); i++ )
+    {
+        Init_status = Lcd_Queue( hlcd, Commands[i], Lcd_ExecTime( Commands[i] ) );
+    }
+
+    /*after the clear the framebuffer and the lcd have only blanks*/
+    (void)memset( hlcd->Frame, BLANK, sizeof(hlcd->Frame) );
+    (void)memset( hlcd->Glass, BLANK, sizeof(hlcd->Glass) );
+    (void)memset( (void *)hlcd->Glyphs, 0, sizeof(hlcd->Glyphs) );
+
+    /*the first command is sent when the timer ends the wait of the reset*/
+    Lcd_Delay( hlcd, RESET_WAIT );
+    return Init_status;
 }
 
 /**
-* @brief   **This function sends a command to the LCD**
+* @brief   **This function puts a command on the queue of the LCD**
 *
-*  This function first put the RsPin on RESET to tell the LCD that a 
-*  command is going to be recived, then puts the csPin on RESET that it knows
-*  data will be send, then we transmit the message put the Cspin
-*  on high to tell the lcd that no more data will be send
-*  and we return the status of the spi funcion
+*  The command is sent with DMA after the ones already on the queue, if nothing is being
+*  sent the transfer is started right away. The function does not wait for the LCD,
+*  the timer waits the execution time of the clear screen and return home commands
+*  before the next transfer.
 *
-* @retval  SPI_STATUS[out]    State of the spi transmit function
+* @retval  SPI_STATUS[out]    State of the spi transmit function, HAL_BUSY if the queue is full
 */
 uint8_t HEL_LCD_Command( LCD_HandleTypeDef *hlcd, uint8_t cmd )
 {
-    HAL_GPIO_WritePin( hlcd->RsPort, hlcd->RsPin, RESET );
-    HAL_GPIO_WritePin( hlcd->CsPort, hlcd->CsPin, RESET );
+    uint8_t SPI_STATUS = Lcd_Queue( hlcd, cmd, Lcd_ExecTime( cmd ) );
 
-    uint8_t SPI_STATUS = HAL_SPI_Transmit( hlcd->SpiHandler, &cmd, 1, 5000 );
-
-    HAL_GPIO_WritePin( hlcd->CsPort, hlcd->CsPin, SET );
+    if( SPI_STATUS == HAL_OK )
+    {
+        SPI_STATUS = Lcd_Start( hlcd );
+    }
 
     return SPI_STATUS;
 }
@@ -113,13 +155,36 @@ uint8_t HEL_LCD_Command( LCD_HandleTypeDef *hlcd, uint8_t cmd )
 */
 uint8_t HEL_LCD_Data( LCD_HandleTypeDef *hlcd, uint8_t data ) /* cppcheck-suppress misra-c2012-8.7 ; function will later be used*/
 {
-    HAL_GPIO_WritePin( hlcd->RsPort, hlcd->RsPin, SET );
-    HAL_GPIO_WritePin( hlcd->CsPort, hlcd->CsPin, RESET );
-    
-    uint8_t SPI_STATUS = HAL_SPI_Transmit( hlcd->SpiHandler, &data, 1, 5000 );
+    return HEL_LCD_Burst( hlcd, &data, 1u );
+}
 
-    HAL_GPIO_WritePin( hlcd->CsPort, hlcd->CsPin, SET );
-    
+/**
+* @brief   **This function sends several data bytes to the LCD**
+*
+*  The RsPin and the CsPin are changed only once and all the bytes are sent with one
+*  transmission, the SPI clock is slow enough to give the LCD the time to write each
+*  character before the next one arrives. It waits first for the commands of the queue
+*  and the flush with DMA, the data does not go through the framebuffer.
+*
+* @param   data[in]  bytes to send
+* @param   size[in]  number of bytes
+*
+* @retval  SPI_STATUS[out]    State of the spi transmit function, HAL_BUSY if the queue did not end
+*/
+uint8_t HEL_LCD_Burst( LCD_HandleTypeDef *hlcd, const uint8_t *data, uint8_t size )
+{
+    uint8_t SPI_STATUS = HAL_BUSY;
+
+    if( Lcd_Wait( hlcd ) == TRUE )
+    {
+        HAL_GPIO_WritePin( hlcd->RsPort, hlcd->RsPin, SET );
+        HAL_GPIO_WritePin( hlcd->CsPort, hlcd->CsPin, RESET );
+
+        /* cppcheck-suppress misra-c2012-11.8 ; the HAL does not write the data */
+        SPI_STATUS = HAL_SPI_Transmit( hlcd->SpiHandler, (uint8_t *)data, size, SPI_TIMEOUT );
+
+        HAL_GPIO_WritePin( hlcd->CsPort, hlcd->CsPin, SET );
+    }
 
     return SPI_STATUS;
 }
@@ -128,27 +193,15 @@ uint8_t HEL_LCD_Data( LCD_HandleTypeDef *hlcd, uint8_t data ) /* cppcheck-suppre
 * @brief   **This function sends a string to the lcd**
 *
 *  This function use the strlen to see how long is the string 
-*  and then sends each byte of the string with a loop using 
-*  the HAL_LCD_Data function, if this function fails
-*  the loop is finished.
+*  and then sends the whole string with the HEL_LCD_Burst function.
 *
-* @retval  Data_status[out]    State of the HEL_LCD_Data function
+* @retval  Data_status[out]    State of the HEL_LCD_Burst function
 */
 uint8_t HEL_LCD_String( LCD_HandleTypeDef *hlcd, char *str )
 {
     uint8_t str_lenght = strlen(str);
-    uint8_t Data_status = FALSE;
 
-    for(uint8_t i = 0; i < str_lenght;i++)
-    {
-        Data_status=HEL_LCD_Data(hlcd, str[i] ); 
-         
-        if(Data_status == HAL_ERROR)
-        {
-            i = str_lenght+1u;   /* cppcheck-suppress misra-c2012-14.2 ; loop needs to be stoped if condition is met*/
-        }
-    }
-    return Data_status;
+    return HEL_LCD_Burst( hlcd, (const uint8_t *)str, str_lenght );
 }
 
 /**
@@ -219,4 +272,425 @@ uint8_t HEL_LCD_Contrast( LCD_HandleTypeDef *hlcd, uint8_t contrast )
        contrast_state = FALSE;  
     }
     return contrast_state;   
-}
\ No newline at end of file
+}
+
+/**
+* @brief   **This function writes a string on the framebuffer**
+*
+*   Nothing is sent to the lcd, the characters are only changed on the framebuffer,
+*   the characters after the end of the row are not written. Call HEL_LCD_Flush to
+*   send the changes.
+*
+* @param   row[in]  FIRST_ROW or SECOND_ROW
+* @param   col[in]  column of the first character
+* @param   str[in]  string to write
+*
+* @note Use the defines for row positions
+*/
+void HEL_LCD_Write( LCD_HandleTypeDef *hlcd, uint8_t row, uint8_t col, const char *str )
+{
+    uint8_t line = (row == (uint8_t)SECOND_ROW) ? 1u : 0u;
+
+    for( uint8_t i = col; (i < HEL_LCD_COLS) && (str[i - col] != '\0'); i++ )
+    {
+        hlcd->Frame[line][i] = str[i - col];
+    }
+}
+
+/**
+* @brief   **This function starts to send the changed characters of the framebuffer to the lcd**
+*
+*   The framebuffer is compared with the copy of what is on the glass, each group of
+*   consecutive different characters is sent with one cursor command, the lcd moves the
+*   cursor by itself after each character, so when only the seconds changed two or three
+*   bytes are sent instead of the whole row. The transfers are done with DMA after the
+*   commands of the queue, the function only starts the first one and the rest are started
+*   from the interrupts. If the lcd is busy the changes are taken when it gets to them.
+*
+* @retval  Flush_status[out]    State of the spi transmit function
+*/
+uint8_t HEL_LCD_Flush( LCD_HandleTypeDef *hlcd )
+{
+    return Lcd_Start( hlcd );
+}
+
+/**
+* @brief   **This function tells if the lcd is busy with the queue or a flush**
+*
+* @retval  TRUE if a transfer or a wait is running, otherwise FALSE
+*/
+uint8_t HEL_LCD_IsBusy( const LCD_HandleTypeDef *hlcd )
+{
+    return hlcd->Busy;
+}
+
+/**
+* @brief   **This function has to be called when a transfer with DMA finished**
+*
+*   Call it from HAL_SPI_TxCpltCallback, the chip select is released and the timer
+*   waits the execution time of the command sent, or the next transfer is started.
+*/
+void HEL_LCD_TxCpltCallback( LCD_HandleTypeDef *hlcd )
+{
+    HAL_GPIO_WritePin( hlcd->CsPort, hlcd->CsPin, SET );
+
+    if( hlcd->Busy == TRUE )
+    {
+        if( (hlcd->State == STATE_COMMAND) && (hlcd->Delay != NO_WAIT) )
+        {
+            hlcd->State = STATE_WAIT;
+            Lcd_Delay( hlcd, hlcd->Delay );
+        }
+        else
+        {
+            (void)Lcd_Next( hlcd );
+        }
+    }
+}
+
+/**
+* @brief   **This function has to be called when the timer of the lcd ends a wait**
+*
+*   Call it from HAL_TIM_PeriodElapsedCallback, the LCD finished the last command
+*   and the next transfer is started.
+*/
+void HEL_LCD_TimerCallback( LCD_HandleTypeDef *hlcd )
+{
+    if( hlcd->State == STATE_WAIT )
+    {
+        (void)Lcd_Next( hlcd );
+    }
+}
+
+/**
+* @brief   **This function loads custom characters on the CGRAM**
+*
+*   The patterns are compared with the ones already loaded, only when one of them is
+*   different the upload is put on the queue, so it can be called on every refresh and it
+*   costs nothing while the same glyph set is in use. The upload goes to the instruction
+*   table 0, writes the patterns and goes back to the table 1 in one block of the queue,
+*   a flush can not run in the middle. The characters are shown with HEL_LCD_GLYPH(n).
+*
+* @param   first[in]     first custom character to load, 0 to 7
+* @param   patterns[in]  patterns of the characters, they have to stay on memory, a const table
+* @param   count[in]     number of characters
+*
+* @retval  HAL_OK, HAL_BUSY if the queue has no room or HAL_ERROR if the characters do not exist
+*/
+uint8_t HEL_LCD_LoadGlyphs( LCD_HandleTypeDef *hlcd, uint8_t first, const uint8_t (*patterns)[HEL_LCD_GLYPH_ROWS], uint8_t count )
+{
+    uint8_t Glyph_status = HAL_OK;
+    uint8_t loaded = TRUE;
+    uint8_t head;
+
+    if( ((uint16_t)first + count) > HEL_LCD_GLYPHS )
+    {
+        Glyph_status = HAL_ERROR;
+    }
+    else
+    {
+        for( uint8_t i = 0u; i < count; i++ )
+        {
+            if( hlcd->Glyphs[first + i] != patterns[i] )
+            {
+                loaded = FALSE;
+            }
+        }
+
+        if( loaded == FALSE )
+        {
+            if( Lcd_Free( hlcd ) < (count + 3u) )
+            {
+                Glyph_status = HAL_BUSY;
+            }
+            else
+            {
+                head = Lcd_Put( hlcd, hlcd->Head, FUNCTION_SET_IS0, NULL, 0u, NO_WAIT );
+                head = Lcd_Put( hlcd, head, CGRAM_ADDRESS | (first << 3u), NULL, 0u, NO_WAIT );
+                for( uint8_t i = 0u; i < count; i++ )
+                {
+                    head = Lcd_Put( hlcd, head, 0u, patterns[i], HEL_LCD_GLYPH_ROWS, NO_WAIT );
+                    hlcd->Glyphs[first + i] = patterns[i];
+                }
+                head = Lcd_Put( hlcd, head, FUNCTION_SET, NULL, 0u, NO_WAIT );
+                /*the whole block is given to the interrupts at once*/
+                hlcd->Head = head;
+                Glyph_status = Lcd_Start( hlcd );
+            }
+        }
+    }
+
+    return Glyph_status;
+}
+
+/**
+* @brief   **This function waits for the queue and the flush before a blocking transfer**
+*
+*   The wait has a timeout so a transfer that never ends does not stop the program.
+*
+* @retval  TRUE if the lcd is free, FALSE if the timeout ended
+*/
+static uint8_t Lcd_Wait( const LCD_HandleTypeDef *hlcd )
+{
+    uint32_t tickstart = HAL_GetTick();
+
+    while( (hlcd->Busy == TRUE) && ((HAL_GetTick() - tickstart) < BUSY_TIMEOUT) )
+    {
+    }
+
+    return (hlcd->Busy == TRUE) ? FALSE : TRUE;
+}
+
+/**
+* @brief   **This function adds a command to the queue**
+*
+*   Only the tasks write on the queue and only the interrupts take from it,
+*   the head is moved after the command is written so no lock is needed.
+*
+* @param   cmd[in]   command to send
+* @param   wait[in]  ticks of the timer to wait after it
+*
+* @retval  HAL_OK or HAL_BUSY if the queue is full
+*/
+static uint8_t Lcd_Queue( LCD_HandleTypeDef *hlcd, uint8_t cmd, uint16_t wait )
+{
+    uint8_t Queue_status = HAL_BUSY;
+    uint8_t head = hlcd->Head;
+
+    if( Lcd_Free( hlcd ) > 0u )
+    {
+        hlcd->Head = Lcd_Put( hlcd, head, cmd, NULL, 0u, wait );
+        Queue_status = HAL_OK;
+    }
+
+    return Queue_status;
+}
+
+/**
+* @brief   **This function gets the free elements of the queue**
+*
+* @retval  elements that can be written, one is always left empty
+*/
+static uint8_t Lcd_Free( const LCD_HandleTypeDef *hlcd )
+{
+    uint8_t used = (uint8_t)((hlcd->Head + HEL_LCD_QUEUE - hlcd->Tail) % HEL_LCD_QUEUE);
+
+    return (HEL_LCD_QUEUE - 1u) - used;
+}
+
+/**
+* @brief   **This function writes an element of the queue without giving it to the interrupts**
+*
+*   The caller moves the head when all its elements are written.
+*
+* @param   head[in]  element to write
+* @param   cmd[in]   command to send when there is no data
+* @param   data[in]  data to send or NULL for a command
+* @param   size[in]  bytes of data, up to HEL_LCD_COLS
+* @param   wait[in]  ticks of the timer to wait after it
+*
+* @retval  element after the one written
+*/
+static uint8_t Lcd_Put( LCD_HandleTypeDef *hlcd, uint8_t head, uint8_t cmd, const uint8_t *data, uint8_t size, uint16_t wait )
+{
+    hlcd->Queue[head].cmd  = cmd;
+    hlcd->Queue[head].data = data;
+    hlcd->Queue[head].size = size;
+    hlcd->Queue[head].wait = wait;
+
+    return (head + 1u) % HEL_LCD_QUEUE;
+}
+
+/**
+* @brief   **This function starts the transfers if nothing is being sent**
+*
+*   Only the tasks start the transfers and the interrupts only clear the busy flag
+*   after they found nothing to send, so a command or a change written before this
+*   call is always sent.
+*
+* @retval  Start_status[out]    State of the spi transmit function
+*/
+static uint8_t Lcd_Start( LCD_HandleTypeDef *hlcd )
+{
+    uint8_t Start_status = HAL_OK;
+
+    if( hlcd->Busy == FALSE )
+    {
+        hlcd->Busy = TRUE;
+        Start_status = Lcd_Next( hlcd );
+    }
+
+    return Start_status;
+}
+
+/**
+* @brief   **This function starts a wait with the timer of the lcd**
+*
+*   The timer is in one pulse mode, it stops by itself on the update event.
+*
+* @param   wait[in]  ticks of the timer to wait
+*/
+static void Lcd_Delay( const LCD_HandleTypeDef *hlcd, uint16_t wait )
+{
+    __HAL_TIM_SET_AUTORELOAD( hlcd->TimHandler, wait );
+    __HAL_TIM_SET_COUNTER( hlcd->TimHandler, 0u );
+    __HAL_TIM_CLEAR_FLAG( hlcd->TimHandler, TIM_FLAG_UPDATE );
+    __HAL_TIM_ENABLE( hlcd->TimHandler );
+}
+
+/**
+* @brief   **This function starts a transfer of the buffer with DMA**
+*
+* @param   rs[in]    RESET for a command, SET for data
+* @param   size[in]  bytes of the buffer to send
+*
+* @retval  SPI_STATUS[out]    State of the spi transmit function
+*/
+static uint8_t Lcd_Transfer( LCD_HandleTypeDef *hlcd, GPIO_PinState rs, uint8_t size )
+{
+    HAL_GPIO_WritePin( hlcd->RsPort, hlcd->RsPin, rs );
+    HAL_GPIO_WritePin( hlcd->CsPort, hlcd->CsPin, RESET );
+
+    uint8_t SPI_STATUS = HAL_SPI_Transmit_DMA( hlcd->SpiHandler, hlcd->Buffer, size );
+
+    if( SPI_STATUS != HAL_OK )
+    {
+        HAL_GPIO_WritePin( hlcd->CsPort, hlcd->CsPin, SET );
+    }
+
+    return SPI_STATUS;
+}
+
+/**
+* @brief   **This function looks for the next group of changed characters**
+*
+*   The first character of the framebuffer different from the glass and the ones
+*   different right after it on the same row make the group.
+*
+* @retval  TRUE if a group was found, otherwise FALSE
+*/
+static uint8_t Lcd_Group( LCD_HandleTypeDef *hlcd )
+{
+    uint8_t found = FALSE;
+
+    for( uint8_t line = 0u; (line < HEL_LCD_ROWS) && (found == FALSE); line++ )
+    {
+        for( uint8_t col = 0u; (col < HEL_LCD_COLS) && (found == FALSE); col++ )
+        {
+            if( hlcd->Frame[line][col] != hlcd->Glass[line][col] )
+            {
+                hlcd->Line = line;
+                hlcd->Col  = col;
+                found = TRUE;
+            }
+        }
+    }
+
+    if( found == TRUE )
+    {
+        hlcd->Size = 0u;
+        while( ((hlcd->Col + hlcd->Size) < HEL_LCD_COLS) &&
+               (hlcd->Frame[hlcd->Line][hlcd->Col + hlcd->Size] != hlcd->Glass[hlcd->Line][hlcd->Col + hlcd->Size]) )
+        {
+            hlcd->Size++;
+        }
+    }
+
+    return found;
+}
+
+/**
+* @brief   **This function starts the next transfer of the lcd**
+*
+*   The commands and data of the queue go first, then the groups of changed characters, each one
+*   is a cursor command and the characters. The characters are copied to the glass when
+*   they are sent, a task can change the framebuffer meanwhile and the change is taken on
+*   the next group. When there is nothing more to send the lcd is free.
+*
+* @retval  Next_status[out]    State of the spi transmit function
+*/
+static uint8_t Lcd_Next( LCD_HandleTypeDef *hlcd )
+{
+    uint8_t Next_status = HAL_OK;
+    const LCD_CommandTypeDef *entry;
+    GPIO_PinState rs;
+    uint8_t size;
+
+    if( hlcd->State == STATE_CURSOR )
+    {
+        hlcd->State = STATE_DATA;
+        (void)memcpy( hlcd->Buffer, &hlcd->Frame[hlcd->Line][hlcd->Col], hlcd->Size );
+        (void)memcpy( &hlcd->Glass[hlcd->Line][hlcd->Col], hlcd->Buffer, hlcd->Size );
+        Next_status = Lcd_Transfer( hlcd, GPIO_PIN_SET, hlcd->Size );
+    }
+    else if( hlcd->Head != hlcd->Tail )
+    {
+        entry       = &hlcd->Queue[hlcd->Tail];
+        hlcd->State = STATE_COMMAND;
+        hlcd->Delay = entry->wait;
+        if( entry->size == 0u )
+        {
+            hlcd->Buffer[0] = entry->cmd;
+            rs   = GPIO_PIN_RESET;
+            size = 1u;
+        }
+        else
+        {
+            (void)memcpy( hlcd->Buffer, entry->data, entry->size );
+            rs   = GPIO_PIN_SET;
+            size = entry->size;
+        }
+        hlcd->Tail  = (hlcd->Tail + 1u) % HEL_LCD_QUEUE;
+        Next_status = Lcd_Transfer( hlcd, rs, size );
+    }
+    else if( Lcd_Group( hlcd ) == TRUE )
+    {
+        hlcd->State     = STATE_CURSOR;
+        hlcd->Buffer[0] = (CURSOR_POSITION | ((hlcd->Line == 0u) ? FIRST_ROW : SECOND_ROW)) + hlcd->Col;
+        Next_status = Lcd_Transfer( hlcd, GPIO_PIN_RESET, 1u );
+    }
+    else
+    {
+        hlcd->State = STATE_IDLE;
+        hlcd->Busy  = FALSE;
+    }
+
+    if( Next_status != HAL_OK )
+    {
+        /*it is not known what the lcd shows, the next flush sends everything again*/
+        (void)memset( hlcd->Glass, UNKNOWN, sizeof(hlcd->Glass) );
+        (void)memset( (void *)hlcd->Glyphs, 0, sizeof(hlcd->Glyphs) );
+        hlcd->State = STATE_IDLE;
+        hlcd->Busy  = FALSE;
+    }
+
+    return Next_status;
+}
+
+/**
+* @brief   **This function gives the execution time of a command**
+*
+*  Only the clear screen and return home commands take longer than the 32us of the next
+*  byte, and the follower control needs the power to be stable.
+*
+* @retval  Ticks of the timer to wait after the command
+*/
+static uint16_t Lcd_ExecTime( uint8_t cmd )
+{
+    uint16_t wait = NO_WAIT;
+
+    if( (cmd == CLEAR_SCREEN) || (cmd == RETURN_HOME) || (cmd == (RETURN_HOME | 1u)) )
+    {
+        wait = CLEAR_WAIT;
+    }
+    else if( cmd == FOLLOWER_CONTROL )
+    {
+        wait = FOLLOWER_WAIT;
+    }
+    else
+    {
+        wait = NO_WAIT;
+    }
+
+    return wait;
+}
@@ -12,6 +12,25 @@
     /**
        @} */
 
+    /** 
+    * @defgroup Frame_size size of the lcd and of its framebuffer
+    @{ */
+    #define HEL_LCD_ROWS    2u      /*!< rows of the lcd */
+    #define HEL_LCD_COLS    16u     /*!< characters of one row */
+    #define HEL_LCD_QUEUE   16u     /*!< commands of the queue, one is always left empty */
+    #define HEL_LCD_TICK_HZ 100000u /*!< frequency the timer of the lcd has to count, 10us per tick */
+    /**
+        @} */
+
+    /** 
+    * @defgroup Glyphs custom characters of the CGRAM
+    @{ */
+    #define HEL_LCD_GLYPHS      8u      /*!< custom characters of the CGRAM */
+    #define HEL_LCD_GLYPH_ROWS  8u      /*!< rows of 5 pixels of one custom character, bit 4 is the left one */
+    #define HEL_LCD_GLYPH(n)    ((char)(8u + (n)))  /*!< character code of the custom character n, 8 to 15 so it is never the end of a string */
+    /**
+        @} */
+
     /** 
     * @defgroup Screen_state this are defines for the states of the screen
     @{ */
@@ -21,6 +40,17 @@
     /**
         @} */
 
+    /**
+    * @brief   LCD_CommandTypeDef command or data waiting on the queue of the lcd
+    */
+    typedef struct LCD_CommandTypeDef
+    {
+        uint8_t             cmd;         /*!< Command to send */
+        uint8_t             size;        /*!< Bytes of data to send instead of the command, 0 for a command */
+        uint16_t            wait;        /*!< Ticks of the timer to wait after the command */
+        const uint8_t       *data;       /*!< Data to send, it has to stay until it is sent */
+    } LCD_CommandTypeDef;
+
         /**
     * @brief   LCD_HandleTypedef Pins and ports of the lcd
     */
@@ -36,6 +66,20 @@
         GPIO_TypeDef        *BklPort;    /*!< Port where the pin to control the LCD backlight is */
         uint32_t            BklPin;      /*!< Pin to control the LCD backlight pin */
         uint8_t             screen;      /*!< State of the LCD screen */
+        TIM_HandleTypeDef   *TimHandler; /*!< Timer that waits the execution time of the commands */
+        char                Frame[HEL_LCD_ROWS][HEL_LCD_COLS]; /*!< Framebuffer, characters on the lcd after the next flush */
+        char                Glass[HEL_LCD_ROWS][HEL_LCD_COLS]; /*!< Characters sent to the lcd, only written by the interrupts */
+        LCD_CommandTypeDef  Queue[HEL_LCD_QUEUE]; /*!< Commands waiting to be sent */
+        volatile uint8_t    Head;        /*!< Next free element of the queue, only moved by the tasks */
+        volatile uint8_t    Tail;        /*!< Next command to send, only moved by the interrupts */
+        const uint8_t       *Glyphs[HEL_LCD_GLYPHS]; /*!< Patterns loaded on the CGRAM, NULL if unknown */
+        uint8_t             Buffer[HEL_LCD_COLS]; /*!< Bytes of the DMA transfer running, they have to stay until it ends */
+        volatile uint8_t    Busy;        /*!< TRUE while a transfer or a wait is running */
+        volatile uint8_t    State;       /*!< Transfer or wait running */
+        uint16_t            Delay;       /*!< Ticks to wait after the command being sent */
+        uint8_t             Line;        /*!< Row of the group of characters being sent */
+        uint8_t             Col;         /*!< First column of the group of characters being sent */
+        uint8_t             Size;        /*!< Number of characters of the group being sent */
         // Add more elements if needed
     } LCD_HandleTypeDef;  
 
@@ -49,9 +93,16 @@
     uint8_t HEL_LCD_Command( LCD_HandleTypeDef *hlcd, uint8_t cmd );
     uint8_t HEL_LCD_Data( LCD_HandleTypeDef *hlcd, uint8_t data );
     uint8_t HEL_LCD_String( LCD_HandleTypeDef *hlcd, char *str );
+    uint8_t HEL_LCD_Burst( LCD_HandleTypeDef *hlcd, const uint8_t *data, uint8_t size );
     uint8_t HEL_LCD_SetCursor( LCD_HandleTypeDef *hlcd, uint8_t row, uint8_t col );
     void HEL_LCD_Backlight( LCD_HandleTypeDef *hlcd, uint8_t state );
     uint8_t HEL_LCD_Contrast( LCD_HandleTypeDef *hlcd, uint8_t contrast );
+    void HEL_LCD_Write( LCD_HandleTypeDef *hlcd, uint8_t row, uint8_t col, const char *str );
+    uint8_t HEL_LCD_Flush( LCD_HandleTypeDef *hlcd );
+    uint8_t HEL_LCD_IsBusy( const LCD_HandleTypeDef *hlcd );
+    void HEL_LCD_TxCpltCallback( LCD_HandleTypeDef *hlcd );
+    void HEL_LCD_TimerCallback( LCD_HandleTypeDef *hlcd );
+    uint8_t HEL_LCD_LoadGlyphs( LCD_HandleTypeDef *hlcd, uint8_t first, const uint8_t (*patterns)[HEL_LCD_GLYPH_ROWS], uint8_t count );
 
     
     
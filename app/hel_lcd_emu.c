@@ -0,0 +1,496 @@
+/**
+* @file    hel_lcd_emu.c
+* @brief   **Emulator of the ST7032 controller of the lcd for the host**
+*
+*   The emulator takes the place of the HAL functions used by hel_lcd.c, the bytes given to
+*   the SPI are decoded with the state of the RS and chip select pins like the controller does:
+*   DDRAM, CGRAM, address counter, entry mode, instruction table and contrast. The SPI with
+*   DMA and the timer of the lcd are interrupts on the board, here they are run by
+*   HEL_LCD_EMU_Run, which calls the callbacks of the driver until it is free, so a program on
+*   the host can flush, run and read the rows to check what the lcd shows and how many bytes
+*   and transfers it took. The time of the emulation counts 32us per byte, as the driver
+*   expects, and the waits of the timer, a byte that arrives before the controller finished
+*   the last command is counted as a violation.
+* @note    Only built for the host with HEL_LCD_EMULATOR defined, on the board the HAL is used
+*/
+#include "hel_lcd_emu.h"
+
+#ifdef HEL_LCD_EMULATOR
+
+/**
+  * @defgroup Emu_times times of the controller in us
+  @{ */
+#define EMU_BYTE_US         32u     /*!< Time of one byte on the SPI*/
+#define EMU_EXEC_US         27u     /*!< Execution time of the commands and data, 26.3us*/
+#define EMU_CLEAR_US        1080u   /*!< Execution time of the clear screen and return home*/
+#define EMU_TICK_US         10u     /*!< Time of one tick of the timer of the lcd*/
+#define EMU_IDLE_US         1000u   /*!< Time that passes on HAL_GetTick when nothing is running*/
+/**
+  @} */
+
+/**
+  * @defgroup Emu_memory memories of the controller
+  @{ */
+#define EMU_DDRAM_SIZE      0x68u   /*!< DDRAM of two lines, 0x00 to 0x27 and 0x40 to 0x67*/
+#define EMU_LINE_END        0x27u   /*!< Last address of the first line*/
+#define EMU_LINE2           0x40u   /*!< First address of the second line*/
+#define EMU_LINE2_END       0x67u   /*!< Last address of the second line*/
+#define EMU_CGRAM_SIZE      64u     /*!< CGRAM of 8 characters of 8 rows*/
+#define EMU_UNKNOWN         0xFFu   /*!< DDRAM after a reset, before the clear screen*/
+/**
+  @} */
+
+/**
+  * @defgroup Emu_commands bits of the commands of the ST7032
+  @{ */
+#define EMU_CMD_DDRAM       0x80u   /*!< set DDRAM address*/
+#define EMU_CMD_CGRAM       0x40u   /*!< set CGRAM address on the table 0, icon, power and follower on the table 1*/
+#define EMU_CMD_FUNCTION    0x20u   /*!< function set, bit 0 is the instruction table*/
+#define EMU_CMD_SHIFT       0x10u   /*!< cursor or display shift on the table 0, bias and oscillator on the table 1*/
+#define EMU_CMD_DISPLAY     0x08u   /*!< display on off, bit 2 is the display*/
+#define EMU_CMD_ENTRY       0x04u   /*!< entry mode, bit 1 is the increment*/
+#define EMU_CMD_HOME        0x02u   /*!< return home*/
+#define EMU_CMD_CLEAR       0x01u   /*!< clear screen*/
+#define EMU_CMD_POWER       0x50u   /*!< power, icon and the 2 high bits of the contrast*/
+#define EMU_CMD_CONTRAST    0x70u   /*!< the 4 low bits of the contrast*/
+/**
+  @} */
+
+/**
+ * @brief  Lcd attached on HEL_LCD_MspInit and the registers of its timer
+ */
+static LCD_HandleTypeDef *Lcd = NULL;
+static TIM_TypeDef Emu_Tim;
+
+/**
+ * @brief  Memories and registers of the controller
+ */
+static uint8_t Ddram[EMU_DDRAM_SIZE];
+static uint8_t Cgram[EMU_CGRAM_SIZE];
+static uint8_t Address;
+static uint8_t Cgram_Mode;
+static uint8_t Increment;
+static uint8_t Table;
+static uint8_t Contrast;
+
+/**
+ * @brief  State of the pins and of the transfer with DMA
+ */
+static GPIO_PinState Cs;
+static GPIO_PinState Rs;
+static GPIO_PinState Rst;
+static GPIO_PinState Backlight;
+static uint8_t Tx_Pending;
+
+/**
+ * @brief  Time of the emulation and end of the command being executed, in us
+ */
+static uint32_t Time_Us;
+static uint32_t Busy_Until;
+
+/**
+ * @brief  Counters since the last read
+ */
+static HEL_LCD_EMU_StatsTypeDef Stats;
+
+static uint8_t Emu_Step( void );
+static void Emu_Reset( void );
+static void Emu_Bytes( const uint8_t *data, uint16_t size );
+static void Emu_Command( uint8_t cmd );
+static void Emu_Data( uint8_t data );
+static void Emu_Move( uint8_t up );
+
+/**
+* @brief   **This function runs the interrupts of the lcd until it is free**
+*
+*   Each end of a transfer with DMA and each wait of the timer calls the callback of the
+*   driver that the interrupt calls on the board, the driver then starts the next transfer.
+*/
+void HEL_LCD_EMU_Run( void )
+{
+    while( Emu_Step() == TRUE )
+    {
+    }
+}
+
+/**
+* @brief   **This function gets the characters shown on a row**
+*
+*   The characters are read from the DDRAM, a character never written after a reset is 0xFF.
+*
+* @param   line[in]   row, 0 or 1
+* @param   text[out]  HEL_LCD_COLS characters and the end of the string
+*/
+void HEL_LCD_EMU_GetRow( uint8_t line, char *text )
+{
+    uint8_t base = (line == 0u) ? 0u : EMU_LINE2;
+
+    for( uint8_t i = 0u; i < HEL_LCD_COLS; i++ )
+    {
+        text[i] = (char)Ddram[base + i];
+    }
+    text[HEL_LCD_COLS] = '\0';
+}
+
+/**
+* @brief   **This function gets the pattern of a custom character from the CGRAM**
+*
+* @param   glyph[in]  custom character, 0 to 7
+* @param   rows[out]  HEL_LCD_GLYPH_ROWS rows of 5 pixels
+*/
+void HEL_LCD_EMU_GetGlyph( uint8_t glyph, uint8_t *rows )
+{
+    (void)memcpy( rows, &Cgram[(glyph % HEL_LCD_GLYPHS) * HEL_LCD_GLYPH_ROWS], HEL_LCD_GLYPH_ROWS );
+}
+
+/**
+* @brief   **This function gets the address counter of the controller**
+*
+* @retval  DDRAM or CGRAM address of the next character
+*/
+uint8_t HEL_LCD_EMU_GetCursor( void )
+{
+    return Address;
+}
+
+/**
+* @brief   **This function gets the contrast of the controller**
+*
+* @retval  contrast of 6 bits
+*/
+uint8_t HEL_LCD_EMU_GetContrast( void )
+{
+    return Contrast;
+}
+
+/**
+* @brief   **This function gets the state of the backlight pin**
+*
+* @retval  SET or RESET
+*/
+uint8_t HEL_LCD_EMU_GetBacklight( void )
+{
+    return (uint8_t)Backlight;
+}
+
+/**
+* @brief   **This function reads the counters of the SPI traffic and starts them again**
+*
+*   Read them after each flush and run to get the cost of one frame.
+*
+* @param   stats[out]  counters since the last read and the time of the emulation
+*/
+void HEL_LCD_EMU_GetStats( HEL_LCD_EMU_StatsTypeDef *stats )
+{
+    Stats.time_us = Time_Us;
+    *stats = Stats;
+    (void)memset( &Stats, 0, sizeof(Stats) );
+}
+
+/**
+* @brief   **Replacement of the msp of the lcd, it attaches the lcd to the emulator**
+*
+*   The timer of the lcd gets registers on memory, the controller is on reset.
+*/
+void HEL_LCD_MspInit( LCD_HandleTypeDef *hlcd )
+{
+    Lcd = hlcd;
+    (void)memset( &Emu_Tim, 0, sizeof(Emu_Tim) );
+    hlcd->TimHandler->Instance = &Emu_Tim;
+    (void)memset( &Stats, 0, sizeof(Stats) );
+    Cs         = GPIO_PIN_SET;
+    Rs         = GPIO_PIN_RESET;
+    Rst        = GPIO_PIN_SET;
+    Backlight  = GPIO_PIN_SET;
+    Tx_Pending = FALSE;
+    Time_Us    = 0u;
+    Emu_Reset();
+}
+
+/**
+* @brief   **Replacement of the HAL, the pins of the lcd go to the controller**
+*/
+void HAL_GPIO_WritePin( GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState )
+{
+    if( Lcd != NULL )
+    {
+        if( (GPIOx == Lcd->CsPort) && (GPIO_Pin == Lcd->CsPin) )
+        {
+            if( (PinState == GPIO_PIN_RESET) && (Cs == GPIO_PIN_SET) )
+            {
+                Stats.selects++;
+            }
+            Cs = PinState;
+        }
+        else if( (GPIOx == Lcd->RsPort) && (GPIO_Pin == Lcd->RsPin) )
+        {
+            Rs = PinState;
+        }
+        else if( (GPIOx == Lcd->RstPort) && (GPIO_Pin == Lcd->RstPin) )
+        {
+            if( (PinState == GPIO_PIN_SET) && (Rst == GPIO_PIN_RESET) )
+            {
+                Emu_Reset();
+            }
+            Rst = PinState;
+        }
+        else if( (GPIOx == Lcd->BklPort) && (GPIO_Pin == Lcd->BklPin) )
+        {
+            Backlight = PinState;
+        }
+        else
+        {
+        }
+    }
+}
+
+/**
+* @brief   **Replacement of the HAL, the bytes go to the controller at once**
+*/
+HAL_StatusTypeDef HAL_SPI_Transmit( SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout )
+{
+    (void)hspi;
+    (void)Timeout;
+    Emu_Bytes( pData, Size );
+
+    return HAL_OK;
+}
+
+/**
+* @brief   **Replacement of the HAL, the bytes go to the controller and the end of the
+*          transfer is given by HEL_LCD_EMU_Run**
+*/
+HAL_StatusTypeDef HAL_SPI_Transmit_DMA( SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size )
+{
+    (void)hspi;
+    Emu_Bytes( pData, Size );
+    Tx_Pending = TRUE;
+
+    return HAL_OK;
+}
+
+/**
+* @brief   **Replacement of the HAL, the time of the emulation in ms**
+*
+*   The interrupts of the lcd run one by one while the driver waits with this function,
+*   when there is nothing to run 1ms passes.
+*/
+uint32_t HAL_GetTick( void )
+{
+    if( Emu_Step() == FALSE )
+    {
+        Time_Us += EMU_IDLE_US;
+    }
+
+    return Time_Us / 1000u;
+}
+
+/**
+* @brief   **This function runs the next interrupt of the lcd**
+*
+*   The end of the transfer goes first, then the wait of the timer, that is in one pulse
+*   mode and stops by itself.
+*
+* @retval  TRUE if an interrupt was run, FALSE if the lcd has nothing running
+*/
+static uint8_t Emu_Step( void )
+{
+    uint8_t ran = TRUE;
+
+    if( Tx_Pending == TRUE )
+    {
+        Tx_Pending = FALSE;
+        HEL_LCD_TxCpltCallback( Lcd );
+    }
+    else if( (Emu_Tim.CR1 & TIM_CR1_CEN) != 0u )
+    {
+        Emu_Tim.CR1 &= ~TIM_CR1_CEN;
+        Time_Us += (Emu_Tim.ARR + 1u) * EMU_TICK_US;
+        HEL_LCD_TimerCallback( Lcd );
+    }
+    else
+    {
+        ran = FALSE;
+    }
+
+    return ran;
+}
+
+/**
+* @brief   **This function resets the controller**
+*
+*   The DDRAM is unknown until the clear screen, the contrast and the CGRAM start on 0.
+*/
+static void Emu_Reset( void )
+{
+    (void)memset( Ddram, EMU_UNKNOWN, sizeof(Ddram) );
+    (void)memset( Cgram, 0, sizeof(Cgram) );
+    Address    = 0u;
+    Cgram_Mode = FALSE;
+    Increment  = TRUE;
+    Table      = 0u;
+    Contrast   = 0u;
+    Busy_Until = Time_Us;
+}
+
+/**
+* @brief   **This function gives the bytes of the SPI to the controller**
+*
+*   The bytes sent with the chip select high are lost, the rest are commands or data
+*   by the RS pin. Each byte takes its time on the SPI before it is executed.
+*
+* @param   data[in]  bytes sent
+* @param   size[in]  number of bytes
+*/
+static void Emu_Bytes( const uint8_t *data, uint16_t size )
+{
+    for( uint16_t i = 0u; i < size; i++ )
+    {
+        if( Cs == GPIO_PIN_SET )
+        {
+            Stats.lost++;
+        }
+        else
+        {
+            Stats.bytes++;
+            Time_Us += EMU_BYTE_US;
+            if( Time_Us < Busy_Until )
+            {
+                Stats.violations++;
+            }
+
+            if( Rs == GPIO_PIN_RESET )
+            {
+                Stats.commands++;
+                Emu_Command( data[i] );
+            }
+            else
+            {
+                Stats.data++;
+                Emu_Data( data[i] );
+            }
+        }
+    }
+}
+
+/**
+* @brief   **This function executes a command of the controller**
+*
+*   The commands are decoded from the highest bit set, the ones of the instruction
+*   table 1 only change the contrast, bias, power and follower are not emulated.
+*
+* @param   cmd[in]  command
+*/
+static void Emu_Command( uint8_t cmd )
+{
+    uint32_t exec = EMU_EXEC_US;
+
+    if( (cmd & EMU_CMD_DDRAM) != 0u )
+    {
+        Address    = cmd & (uint8_t)~EMU_CMD_DDRAM;
+        Cgram_Mode = FALSE;
+    }
+    else if( (cmd & EMU_CMD_CGRAM) != 0u )
+    {
+        if( Table == 0u )
+        {
+            Address    = cmd & (EMU_CGRAM_SIZE - 1u);
+            Cgram_Mode = TRUE;
+        }
+        else if( (cmd & 0xF0u) == EMU_CMD_POWER )
+        {
+            Contrast = (Contrast & 0x0Fu) | (uint8_t)((cmd & 0x03u) << 4u);
+        }
+        else if( (cmd & 0xF0u) == EMU_CMD_CONTRAST )
+        {
+            Contrast = (Contrast & 0x30u) | (cmd & 0x0Fu);
+        }
+        else
+        {
+        }
+    }
+    else if( (cmd & EMU_CMD_FUNCTION) != 0u )
+    {
+        Table = cmd & 0x01u;
+    }
+    else if( (cmd & EMU_CMD_SHIFT) != 0u )
+    {
+        /*only the cursor shift of the table 0 moves the address*/
+        if( (Table == 0u) && ((cmd & 0x08u) == 0u) )
+        {
+            Emu_Move( ((cmd & 0x04u) != 0u) ? TRUE : FALSE );
+        }
+    }
+    else if( (cmd & EMU_CMD_DISPLAY) != 0u )
+    {
+        /*the display and cursor on off do not change what is shown on the rows*/
+    }
+    else if( (cmd & EMU_CMD_ENTRY) != 0u )
+    {
+        Increment = ((cmd & 0x02u) != 0u) ? TRUE : FALSE;
+    }
+    else if( (cmd & EMU_CMD_HOME) != 0u )
+    {
+        Address    = 0u;
+        Cgram_Mode = FALSE;
+        exec       = EMU_CLEAR_US;
+    }
+    else if( cmd == EMU_CMD_CLEAR )
+    {
+        (void)memset( Ddram, ' ', sizeof(Ddram) );
+        Address    = 0u;
+        Cgram_Mode = FALSE;
+        Increment  = TRUE;
+        exec       = EMU_CLEAR_US;
+    }
+    else
+    {
+    }
+
+    Busy_Until = Time_Us + exec;
+}
+
+/**
+* @brief   **This function writes a data byte on the DDRAM or the CGRAM**
+*
+* @param   data[in]  character or row of 5 pixels
+*/
+static void Emu_Data( uint8_t data )
+{
+    if( Cgram_Mode == TRUE )
+    {
+        Cgram[Address] = data & 0x1Fu;
+        Address = (Address + 1u) & (EMU_CGRAM_SIZE - 1u);
+    }
+    else
+    {
+        if( Address < EMU_DDRAM_SIZE )
+        {
+            Ddram[Address] = data;
+        }
+        Emu_Move( Increment );
+    }
+
+    Busy_Until = Time_Us + EMU_EXEC_US;
+}
+
+/**
+* @brief   **This function moves the DDRAM address**
+*
+*   The end of the first line goes to the start of the second one and back.
+*
+* @param   up[in]  TRUE to increment, FALSE to decrement
+*/
+static void Emu_Move( uint8_t up )
+{
+    if( up == TRUE )
+    {
+        Address = (Address == EMU_LINE_END) ? EMU_LINE2 : ((Address >= EMU_LINE2_END) ? 0u : (Address + 1u));
+    }
+    else
+    {
+        Address = (Address == 0u) ? EMU_LINE2_END : ((Address == EMU_LINE2) ? EMU_LINE_END : (Address - 1u));
+    }
+}
+
+#endif
@@ -0,0 +1,40 @@
+/**
+* @file    <hel_lcd_emu.h>
+* @brief   **Header file for hel_lcd_emu.c**
+*
+*   This file contains the declaration for the functions on the .c file and the
+*   counters of the SPI traffic.
+*   To use this emulator build hel_lcd.c and hel_lcd_emu.c for the host with HEL_LCD_EMULATOR
+*   defined (make host), fill the ports and pins of a LCD_HandleTypeDef and call HEL_LCD_Init,
+*   then after each flush call HEL_LCD_EMU_Run and read the rows and the counters.
+* @note    Only for the host, the emulator replaces HAL_SPI_Transmit, HAL_SPI_Transmit_DMA,
+*          HAL_GPIO_WritePin, HAL_GetTick and HEL_LCD_MspInit
+*/
+#ifndef HEL_LCD_EMU_H__
+#define HEL_LCD_EMU_H__
+
+#include "hel_lcd.h"
+
+/**
+* @brief   Counters of the SPI traffic since the last call to HEL_LCD_EMU_GetStats
+*/
+typedef struct _HEL_LCD_EMU_StatsTypeDef
+{
+    uint32_t bytes;       /*!< Bytes sent with the chip select low */
+    uint32_t commands;    /*!< Bytes sent with RS low */
+    uint32_t data;        /*!< Bytes sent with RS high */
+    uint32_t selects;     /*!< Times the chip select went low, one per transfer */
+    uint32_t violations;  /*!< Bytes that arrived while the controller was executing a command */
+    uint32_t lost;        /*!< Bytes sent with the chip select high, the controller ignores them */
+    uint32_t time_us;     /*!< Time of the emulation in us */
+} HEL_LCD_EMU_StatsTypeDef;
+
+void HEL_LCD_EMU_Run( void );
+void HEL_LCD_EMU_GetRow( uint8_t line, char *text );
+void HEL_LCD_EMU_GetGlyph( uint8_t glyph, uint8_t *rows );
+uint8_t HEL_LCD_EMU_GetCursor( void );
+uint8_t HEL_LCD_EMU_GetContrast( void );
+uint8_t HEL_LCD_EMU_GetBacklight( void );
+void HEL_LCD_EMU_GetStats( HEL_LCD_EMU_StatsTypeDef *stats );
+
+#endif
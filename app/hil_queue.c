@@ -64,7 +64,7 @@ uint8_t HIL_QUEUE_Write( QUEUE_HandleTypeDef *hqueue, void *data )
     if(hqueue->Full == NOT_FULL)
     {
         /* cppcheck-suppress misra-c2012-11.5 ; void in to object conversion is necesary*/
-        (void)memcpy( ((uint8_t*)(hqueue->Buffer) + hqueue->Head), data,hqueue->size);      /* cppcheck-suppress misra-c2012-18.4 ; operator to pointers are needed*/
+        (void)memcpy( ((uint8_t*)(hqueue->Buffer) + (hqueue->Head * hqueue->size)), data,hqueue->size);      /* cppcheck-suppress misra-c2012-18.4 ; operator to pointers are needed*/
         ++(hqueue->Head);
         hqueue->Head %= hqueue->Elements;
         Queue_Status = QUEUE_OK;
@@ -117,7 +117,7 @@ uint8_t HIL_QUEUE_Read( QUEUE_HandleTypeDef *hqueue, void *data )
     if(hqueue->Empty != EMPTY)
     {
         /* cppcheck-suppress misra-c2012-11.5 ; void in to object conversion is necesary*/
-        (void) memcpy( data, (uint8_t*)hqueue->Buffer + hqueue->Tail, hqueue->size );    /* cppcheck-suppress misra-c2012-18.4 ; operator to pointers are needed*/
+        (void) memcpy( data, (uint8_t*)hqueue->Buffer + (hqueue->Tail * hqueue->size), hqueue->size );    /* cppcheck-suppress misra-c2012-18.4 ; operator to pointers are needed*/
         ++(hqueue->Tail);
         hqueue->Tail %= hqueue->Elements;
       Queue_Status = QUEUE_OK;
@@ -0,0 +1,364 @@
+/**
+* @file    hil_store.c
+* @brief   **flash record store functions**
+*
+*   This is a reusable library to keep a block of data on flash, this files contains all the
+*   functions implementation declared on the hil_store.h file. Each record is a header with the
+*   sequence, the size and a CRC of the data followed by the data, written one double word at
+*   a time. The header is written first so a record cut by a reset is seen as written but with
+*   a wrong CRC, it is skipped and the previous record is used.
+*/
+
+#include "hil_store.h"
+#include <string.h>
+
+/**
+* @defgroup STORE_header fields of the header double word
+* @{ */
+#define HEADER_SIZE_MASK    0x0000FFFFu     /*!<size of the data on the high word*/
+#define HEADER_CRC_SHIFT    16u             /*!<the CRC is on the upper half of the high word*/
+#define WORD_SHIFT          32u             /*!<shift of the high word of a double word*/
+#define DOUBLE_WORD         8u              /*!<bytes programmed at a time*/
+#define DOUBLE_WORD_MASK    7u              /*!<mask to round the data to double words*/
+#define ERASED_BYTE         0xFFu           /*!<value of an erased flash byte, used to pad the data*/
+/**
+* @}
+*/
+
+/**
+* @defgroup STORE_crc CRC16 CCITT values
+* @{ */
+#define CRC_INIT            0xFFFFu         /*!<initial value of the CRC*/
+#define CRC_NIBBLE          4u              /*!<the CRC is calculated four bits at a time*/
+#define CRC_NIBBLE_MASK     0x0Fu           /*!<mask of one nibble*/
+#define CRC_TOP_SHIFT       12u             /*!<shift to get the upper nibble of the CRC*/
+#define CRC_MASK            0xFFFFu         /*!<the CRC is 16 bits*/
+/**
+* @}
+*/
+
+/**
+* @brief  CRC16 CCITT of each nibble, 32 bytes of table instead of 512 for the byte table
+*/
+static const uint16_t CrcTable[16] =
+{
+    0x0000u, 0x1021u, 0x2042u, 0x3063u, 0x4084u, 0x50A5u, 0x60C6u, 0x70E7u,
+    0x8108u, 0x9129u, 0xA14Au, 0xB16Bu, 0xC18Cu, 0xD1ADu, 0xE1CEu, 0xF1EFu
+};
+
+static uint32_t Store_SlotSize( const STORE_HandleTypeDef *hstore );
+static uint32_t Store_PageAddress( const STORE_HandleTypeDef *hstore, uint8_t page );
+static uint32_t Store_Written( const STORE_HandleTypeDef *hstore, uint8_t page, uint32_t *sequence );
+static uint8_t Store_IsValid( const STORE_HandleTypeDef *hstore, uint32_t address );
+static uint16_t Store_Crc( const uint8_t *data, uint16_t size );
+static void Store_Erase( STORE_HandleTypeDef *hstore );
+
+/**
+* @brief   **This function finds the last record of the store**
+*
+*  Only the first word of each header is read until an erased one is found, the page with
+*  the highest sequence is where the records are being written. From its last record the CRC
+*  is checked going back until a valid one is found, normally it is the first one tried so
+*  starting takes a few microseconds.
+*
+* @param   hstore[in]   Pointer to a STORE_HandleTypeDef structure with Address, Bank, Page and Size configured
+*/
+void HIL_STORE_Init( STORE_HandleTypeDef *hstore )
+{
+    uint32_t written[HIL_STORE_PAGES];
+    uint32_t sequence[HIL_STORE_PAGES];
+    uint32_t slot;
+    uint32_t address;
+    uint8_t page;
+
+    assert_error( (hstore->Size != 0u), STORE_PAR_ERROR ); /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+    slot = Store_SlotSize( hstore );
+    assert_error( (slot <= FLASH_PAGE_SIZE), STORE_PAR_ERROR ); /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+
+    for( page = 0u; page < HIL_STORE_PAGES; page++ )
+    {
+        written[page] = Store_Written( hstore, page, &sequence[page] );
+    }
+
+    hstore->Active   = (sequence[1] > sequence[0]) ? 1u : 0u;
+    hstore->Sequence = sequence[hstore->Active];
+    hstore->Next     = Store_PageAddress( hstore, hstore->Active ) + (written[hstore->Active] * slot);
+    hstore->Last     = HIL_STORE_NONE;
+    hstore->Erasing  = FALSE;
+
+    /*the active page is searched first, then the other one that has the older records*/
+    page = hstore->Active;
+    for( uint8_t i = 0u; (i < HIL_STORE_PAGES) && (hstore->Last == HIL_STORE_NONE); i++ )
+    {
+        address = Store_PageAddress( hstore, page ) + (written[page] * slot);
+        while( (written[page] > 0u) && (hstore->Last == HIL_STORE_NONE) )
+        {
+            address -= slot;
+            written[page]--;
+            if( Store_IsValid( hstore, address ) == TRUE )
+            {
+                hstore->Last = address;
+            }
+        }
+        page = (page == 0u) ? 1u : 0u;
+    }
+}
+
+/**
+* @brief   **This function reads the data of the last valid record**
+*
+* @param   hstore[in]   Pointer to a STORE_HandleTypeDef structure
+* @param   data[out]    Pointer to the memory where Size bytes are copied
+*
+* @retval  TRUE if there was a record, FALSE if the store is empty and data was not changed
+*/
+uint8_t HIL_STORE_Read( const STORE_HandleTypeDef *hstore, void *data )
+{
+    uint8_t found = FALSE;
+
+    assert_error( (data != NULL), STORE_PAR_ERROR ); /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+
+    if( hstore->Last != HIL_STORE_NONE )
+    {
+        (void)memcpy( data, (const void *)(hstore->Last + HIL_STORE_HEADER_SIZE), hstore->Size ); /* cppcheck-suppress misra-c2012-11.6 ; the record is on a flash address */
+        found = TRUE;
+    }
+
+    return found;
+}
+
+/**
+* @brief   **This function writes a new record**
+*
+*  The record is written after the last one, the header first and then the data padded
+*  with erased bytes. If it does not fit on the page the other page is erased with interrupts
+*  and the function has to be called again once the erase finished. If the record could not
+*  be programmed the page is taken as full so the next write erases the other page.
+*  While other user of the flash is erasing nothing is done and the function has to be called again.
+*
+* @param   hstore[in]   Pointer to a STORE_HandleTypeDef structure
+* @param   data[in]     Pointer to the Size bytes to store
+*
+* @retval  TRUE if the record was written, FALSE if the function has to be called again
+*/
+uint8_t HIL_STORE_Write( STORE_HandleTypeDef *hstore, const void *data )
+{
+    const uint8_t *bytes = (const uint8_t *)data;
+    uint8_t written = FALSE;
+    uint32_t slot = Store_SlotSize( hstore );
+    uint32_t end = Store_PageAddress( hstore, hstore->Active ) + FLASH_PAGE_SIZE;
+    uint64_t double_word;
+    uint32_t high_word;
+    uint32_t chunk;
+    HAL_StatusTypeDef result;
+
+    assert_error( (data != NULL), STORE_PAR_ERROR ); /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+
+    if( (hstore->Erasing == FALSE) && (HIL_STORE_FlashBusy() == FALSE) )
+    {
+        if( (hstore->Next + slot) > end )
+        {
+            Store_Erase( hstore );
+        }
+        else
+        {
+            Status = HAL_FLASH_Unlock();
+            assert_error( Status == HAL_OK, FLASH_UNLOCK_ERROR );   /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+
+            high_word   = ((uint32_t)Store_Crc( bytes, hstore->Size ) << HEADER_CRC_SHIFT) | hstore->Size;
+            double_word = ((uint64_t)high_word << WORD_SHIFT) | (hstore->Sequence + 1u);
+            result = HAL_FLASH_Program( FLASH_TYPEPROGRAM_DOUBLEWORD, hstore->Next, double_word );
+
+            for( uint32_t i = 0u; (i < hstore->Size) && (result == HAL_OK); i += DOUBLE_WORD )
+            {
+                chunk = ((hstore->Size - i) < DOUBLE_WORD) ? (hstore->Size - i) : DOUBLE_WORD;
+                (void)memset( &double_word, (int)ERASED_BYTE, sizeof(double_word) );
+                (void)memcpy( &double_word, &bytes[i], chunk );
+                result = HAL_FLASH_Program( FLASH_TYPEPROGRAM_DOUBLEWORD, hstore->Next + HIL_STORE_HEADER_SIZE + i, double_word );
+            }
+
+            Status = HAL_FLASH_Lock();
+            assert_error( Status == HAL_OK, FLASH_LOCK_ERROR );   /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+
+            if( result == HAL_OK )
+            {
+                hstore->Last = hstore->Next;
+                hstore->Sequence++;
+                written = TRUE;
+            }
+            hstore->Next = (result == HAL_OK) ? (hstore->Next + slot) : end;
+        }
+    }
+
+    return written;
+}
+
+/**
+* @brief   **This function has to be called when the flash finished the erase**
+*
+*  Call it from HAL_FLASH_EndOfOperationCallback and HAL_FLASH_OperationErrorCallback,
+*  a failed erase is reported by the error callback after the state is cleared.
+*
+* @param   hstore[in]   Pointer to a STORE_HandleTypeDef structure
+*/
+void HIL_STORE_EraseCallback( STORE_HandleTypeDef *hstore )
+{
+    if( hstore->Erasing == TRUE )
+    {
+        hstore->Erasing = FALSE;
+        (void)HAL_FLASH_Lock();
+    }
+}
+
+/**
+* @brief   **This function tells if an operation with interrupts is running on the flash**
+*
+*  The HAL keeps the flash locked until the interrupt of the operation, any program or erase
+*  started before would fail, so the users of the flash check it before they start one.
+*
+* @retval  TRUE if the flash is busy, otherwise FALSE
+*/
+uint8_t HIL_STORE_FlashBusy( void )
+{
+    return (pFlash.ProcedureOnGoing != FLASH_TYPENONE) ? TRUE : FALSE;
+}
+
+/**
+* @brief   **This function gets the flash used by one record**
+*
+* @param   hstore[in]   Pointer to a STORE_HandleTypeDef structure
+*
+* @retval  bytes of the header and the data rounded to double words
+*/
+static uint32_t Store_SlotSize( const STORE_HandleTypeDef *hstore )
+{
+    return HIL_STORE_HEADER_SIZE + (((uint32_t)hstore->Size + DOUBLE_WORD_MASK) & ~DOUBLE_WORD_MASK);
+}
+
+/**
+* @brief   **This function gets the address of one of the pages**
+*
+* @param   hstore[in]   Pointer to a STORE_HandleTypeDef structure
+* @param   page[in]     0 or 1
+*
+* @retval  address of the first byte of the page
+*/
+static uint32_t Store_PageAddress( const STORE_HandleTypeDef *hstore, uint8_t page )
+{
+    return hstore->Address + ((uint32_t)page * FLASH_PAGE_SIZE);
+}
+
+/**
+* @brief   **This function counts the records written on a page**
+*
+*  The records are written in order so the first erased header is the end of the page.
+*
+* @param   hstore[in]    Pointer to a STORE_HandleTypeDef structure
+* @param   page[in]      0 or 1
+* @param   sequence[out] sequence of the last record written on the page, 0 if there is none
+*
+* @retval  number of records written, valid or not
+*/
+static uint32_t Store_Written( const STORE_HandleTypeDef *hstore, uint8_t page, uint32_t *sequence )
+{
+    uint32_t slot = Store_SlotSize( hstore );
+    uint32_t address = Store_PageAddress( hstore, page );
+    uint32_t end = address + FLASH_PAGE_SIZE;
+    uint32_t header;
+    uint32_t count = 0u;
+
+    *sequence = 0u;
+    while( (address + slot) <= end )
+    {
+        header = *(const volatile uint32_t *)address;   /* cppcheck-suppress misra-c2012-11.4 ; the header is on a flash address */
+        if( header == HIL_STORE_NONE )
+        {
+            break;
+        }
+        *sequence = header;
+        count++;
+        address += slot;
+    }
+
+    return count;
+}
+
+/**
+* @brief   **This function checks the size and the CRC of a record**
+*
+* @param   hstore[in]   Pointer to a STORE_HandleTypeDef structure
+* @param   address[in]  address of the record
+*
+* @retval  TRUE if the record is valid, otherwise FALSE
+*/
+static uint8_t Store_IsValid( const STORE_HandleTypeDef *hstore, uint32_t address )
+{
+    uint32_t high_word = *(const volatile uint32_t *)(address + sizeof(uint32_t));  /* cppcheck-suppress misra-c2012-11.4 ; the header is on a flash address */
+    const uint8_t *data = (const uint8_t *)(address + HIL_STORE_HEADER_SIZE);       /* cppcheck-suppress misra-c2012-11.4 ; the record is on a flash address */
+    uint8_t valid = FALSE;
+
+    if( ((high_word & HEADER_SIZE_MASK) == hstore->Size) &&
+        ((high_word >> HEADER_CRC_SHIFT) == Store_Crc( data, hstore->Size )) )
+    {
+        valid = TRUE;
+    }
+
+    return valid;
+}
+
+/**
+* @brief   **This function calculates the CRC16 CCITT of the data**
+*
+*  The CRC is calculated one nibble at a time with a table of 16 values.
+*
+* @param   data[in]   Pointer to the data
+* @param   size[in]   bytes of data
+*
+* @retval  CRC of the data
+*/
+static uint16_t Store_Crc( const uint8_t *data, uint16_t size )
+{
+    uint32_t crc = CRC_INIT;
+
+    for( uint16_t i = 0u; i < size; i++ )
+    {
+        crc = ((crc << CRC_NIBBLE) ^ CrcTable[(crc >> CRC_TOP_SHIFT) ^ ((uint32_t)data[i] >> CRC_NIBBLE)]) & CRC_MASK;
+        crc = ((crc << CRC_NIBBLE) ^ CrcTable[(crc >> CRC_TOP_SHIFT) ^ ((uint32_t)data[i] & CRC_NIBBLE_MASK)]) & CRC_MASK;
+    }
+
+    return (uint16_t)crc;
+}
+
+/**
+* @brief   **This function starts the erase of the page that is not active**
+*
+*  The other page becomes the active one, it has the older records so the last valid
+*  record is still readable while the erase runs, the flash stays unlocked until
+*  HIL_STORE_EraseCallback is called.
+*
+* @param   hstore[in]   Pointer to a STORE_HandleTypeDef structure
+*/
+static void Store_Erase( STORE_HandleTypeDef *hstore )
+{
+    FLASH_EraseInitTypeDef EraseInit;
+    uint32_t address;
+
+    hstore->Active  = (hstore->Active == 0u) ? 1u : 0u;
+    address         = Store_PageAddress( hstore, hstore->Active );
+    hstore->Next    = address;
+    hstore->Erasing = TRUE;
+    if( (hstore->Last >= address) && (hstore->Last < (address + FLASH_PAGE_SIZE)) )
+    {
+        hstore->Last = HIL_STORE_NONE;
+    }
+
+    EraseInit.TypeErase = FLASH_TYPEERASE_PAGES;
+    EraseInit.Banks     = hstore->Bank;
+    EraseInit.Page      = hstore->Page + hstore->Active;
+    EraseInit.NbPages   = 1u;
+
+    Status = HAL_FLASH_Unlock();
+    assert_error( Status == HAL_OK, FLASH_UNLOCK_ERROR );   /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+    Status = HAL_FLASHEx_Erase_IT( &EraseInit );
+    assert_error( Status == HAL_OK, FLASH_ERASE_ERROR );    /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+}
@@ -0,0 +1,47 @@
+/**
+* @file    <hil_store.h>
+* @brief   **Header file for the flash record store**
+*
+* This file contains the defines, structures and functions declaration of a log structured
+* store on two flash pages. Every write appends a new copy of the data with a sequence number
+* and a CRC, so one page is erased only when it is full and each page is erased once every
+* many writes. The last valid record is found reading only the headers of the records.
+*/
+#ifndef HIL_STORE_H__
+#define HIL_STORE_H__
+
+    #include "app_bsp.h"
+
+    /**
+    * @defgroup STORE_values record store values
+    * @{ */
+    #define HIL_STORE_PAGES         2u              /*!<pages used by the store, one is erased when the other is full*/
+    #define HIL_STORE_NONE          0xFFFFFFFFu     /*!<no record, also the value of an erased flash word*/
+    #define HIL_STORE_HEADER_SIZE   8u              /*!<bytes of the header of each record, one flash double word*/
+    /**
+    * @}
+    */
+
+    /**
+    * @brief  STORE_HandleTypeDef flash pages of the store and position of the records
+    */
+    typedef struct
+    {
+        uint32_t            Address;    /*!<Address of the first page, the second one is the next page*/
+        uint32_t            Bank;       /*!<Flash bank of the pages, FLASH_BANK_1 or FLASH_BANK_2*/
+        uint32_t            Page;       /*!<Number of the first page on its bank*/
+        uint16_t            Size;       /*!<Bytes of the data of one record*/
+        uint32_t            Sequence;   /*!<Sequence of the last record written*/
+        uint32_t            Last;       /*!<Address of the last valid record, HIL_STORE_NONE if there is none*/
+        uint32_t            Next;       /*!<Address where the next record is written*/
+        uint8_t             Active;     /*!<Page where the records are being written*/
+        volatile uint8_t    Erasing;    /*!<TRUE while the other page is being erased*/
+    } STORE_HandleTypeDef;
+
+    void HIL_STORE_Init( STORE_HandleTypeDef *hstore );
+    uint8_t HIL_STORE_Read( const STORE_HandleTypeDef *hstore, void *data );
+    uint8_t HIL_STORE_Write( STORE_HandleTypeDef *hstore, const void *data );
+    void HIL_STORE_EraseCallback( STORE_HandleTypeDef *hstore );
+    uint8_t HIL_STORE_FlashBusy( void );
+
+#endif
@@ -0,0 +1,379 @@
+/**
+* @file    hil_time.c
+* @brief   **time library functions**
+*
+*   This is a reusable library to keep time and date as the seconds since 2000-01-01 00:00:00,
+*   this files contains all the functions implementation declared on the hil_time.h file.
+*   The Cortex-M0+ has no hardware divider so every division by a constant is done multiplying
+*   by its reciprocal and shifting, and the calendar rules (days of each month, days before each
+*   month and BCD digits) are read from tables instead of being calculated on every call.
+*/
+
+#include "hil_time.h"
+
+/**
+* @defgroup TIME_magic reciprocals to divide by a constant with a multiplication and a shift
+* @{ */
+#define DAY_MAGIC           0xC22E4507u     /*!<(2^48 / 86400) rounded up, exact for all the epoch range*/
+#define DAY_SHIFT           48u             /*!<shift for DAY_MAGIC*/
+#define HOUR_MAGIC          4661u           /*!<(2^20 / 225) rounded up, seconds of the day >> 4 divided by 225*/
+#define HOUR_SHIFT          20u             /*!<shift for HOUR_MAGIC*/
+#define MIN_MAGIC           1093u           /*!<(2^14 / 15) rounded up, seconds of the hour >> 2 divided by 15*/
+#define MIN_SHIFT           14u             /*!<shift for MIN_MAGIC*/
+#define CYCLE_MAGIC         22967u          /*!<(2^25 / 1461) rounded up, days divided by the 4 years cycle*/
+#define CYCLE_SHIFT         25u             /*!<shift for CYCLE_MAGIC*/
+#define WEEK_MAGIC          37450u          /*!<(2^18 / 7) rounded up, days divided by 7*/
+#define WEEK_SHIFT          18u             /*!<shift for WEEK_MAGIC*/
+/**
+* @}
+*/
+
+/**
+* @defgroup TIME_calendar calendar values
+* @{ */
+#define DAYS_PER_CYCLE      1461u   /*!<days of 4 years, one of them leap*/
+#define DAYS_PER_WEEK       7u      /*!<days of one week*/
+#define EPOCH_WEEKDAY       5u      /*!<2000-01-01 was saturday, 6 on the RTC minus 1*/
+#define MONTHS              12u     /*!<months of the year*/
+#define YEAR_DAYS           365u    /*!<days of a non leap year*/
+#define LEAP_YEAR_MASK      0x03u   /*!<on 2000 to 2099 every year multiple of 4 is leap*/
+#define MONTH_GUESS_SHIFT   5u      /*!<day of the year / 32 is the month or the previous one*/
+#define BCD_DIGITS          100u    /*!<number of values that fits on one BCD byte*/
+#define BCD_NIBBLE          0x0Fu   /*!<mask for one BCD digit*/
+#define BCD_MAX_DIGIT       9u      /*!<max value of one BCD digit*/
+/**
+* @}
+*/
+
+/**
+* @brief  Days before the first day of each month, one row for non leap and one for leap years
+*/
+static const uint16_t DaysBeforeMonth[2][MONTHS + 1u] =
+{
+    { 0u, 31u, 59u, 90u, 120u, 151u, 181u, 212u, 243u, 273u, 304u, 334u, 365u },
+    { 0u, 31u, 60u, 91u, 121u, 152u, 182u, 213u, 244u, 274u, 305u, 335u, 366u }
+};
+
+/**
+* @brief  Days before the first day of each year of the 4 years cycle, the first one is leap
+*/
+static const uint16_t DaysBeforeYear[4u] = { 0u, 366u, 731u, 1096u };
+
+/**
+* @brief  BCD value of every binary number from 0 to 99
+*/
+static const uint8_t BinToBcd[BCD_DIGITS] =
+{
+    0x00u,0x01u,0x02u,0x03u,0x04u,0x05u,0x06u,0x07u,0x08u,0x09u,
+    0x10u,0x11u,0x12u,0x13u,0x14u,0x15u,0x16u,0x17u,0x18u,0x19u,
+    0x20u,0x21u,0x22u,0x23u,0x24u,0x25u,0x26u,0x27u,0x28u,0x29u,
+    0x30u,0x31u,0x32u,0x33u,0x34u,0x35u,0x36u,0x37u,0x38u,0x39u,
+    0x40u,0x41u,0x42u,0x43u,0x44u,0x45u,0x46u,0x47u,0x48u,0x49u,
+    0x50u,0x51u,0x52u,0x53u,0x54u,0x55u,0x56u,0x57u,0x58u,0x59u,
+    0x60u,0x61u,0x62u,0x63u,0x64u,0x65u,0x66u,0x67u,0x68u,0x69u,
+    0x70u,0x71u,0x72u,0x73u,0x74u,0x75u,0x76u,0x77u,0x78u,0x79u,
+    0x80u,0x81u,0x82u,0x83u,0x84u,0x85u,0x86u,0x87u,0x88u,0x89u,
+    0x90u,0x91u,0x92u,0x93u,0x94u,0x95u,0x96u,0x97u,0x98u,0x99u
+};
+
+/**
+* @brief  Names of the months, the first one is january
+*/
+static const char MonthNames[MONTHS][HIL_TIME_NAME_SIZE + 1u] =
+{
+    "JAN", "FEB", "MAR", "APR", "MAY", "JUN", "JUL", "AUG", "SEP", "OCT", "NOV", "DEC"
+};
+
+/**
+* @brief  Names of the days of the week, the first one is monday like on the RTC
+*/
+static const char WeekDayNames[DAYS_PER_WEEK][HIL_TIME_NAME_SIZE + 1u] =
+{
+    "MO ", "TU ", "WE ", "TH ", "FR ", "SA ", "SU "
+};
+
+/**
+* @brief  Name returned for a month or day of the week out of range
+*/
+static const char NoName[HIL_TIME_NAME_SIZE + 1u] = "---";
+
+static uint32_t Time_Days( HIL_TIME_EpochTypeDef epoch );
+
+/**
+* @brief   **This function converts a BCD byte to binary**
+*
+*  Each nibble is one decimal digit, the tens are multiplied by 10 with shifts so no
+*  division is needed, if one of the nibbles is not a decimal digit the value is not valid.
+*
+* @param   bcd[in] Value in BCD format
+*
+* @retval  binary value from 0 to 99 or HIL_TIME_INVALID_BCD
+*/
+uint8_t HIL_TIME_BcdToBin( uint8_t bcd )
+{
+    uint8_t tens = (bcd >> 4u) & BCD_NIBBLE;
+    uint8_t ones = bcd & BCD_NIBBLE;
+    uint8_t bin  = HIL_TIME_INVALID_BCD;
+
+    if( (tens <= BCD_MAX_DIGIT) && (ones <= BCD_MAX_DIGIT) )
+    {
+        bin = (tens << 3u) + (tens << 1u) + ones;
+    }
+
+    return bin;
+}
+
+/**
+* @brief   **This function converts a binary value to BCD**
+*
+*  The value is read from the BinToBcd table.
+*
+* @param   bin[in] Binary value from 0 to 99
+*
+* @retval  BCD value or HIL_TIME_INVALID_BCD if the value does not fit on one BCD byte
+*/
+uint8_t HIL_TIME_BinToBcd( uint8_t bin )
+{
+    uint8_t bcd = HIL_TIME_INVALID_BCD;
+
+    if( bin < BCD_DIGITS )
+    {
+        bcd = BinToBcd[bin];
+    }
+
+    return bcd;
+}
+
+/**
+* @brief   **This function writes a BCD byte as two ascii digits**
+*
+*  Each nibble is one digit so only a shift and a mask are needed, the text is not
+*  terminated so it can be written in the middle of a string.
+*
+* @param   bcd[in]   Value in BCD format
+* @param   text[out] two characters
+*/
+void HIL_TIME_BcdToAscii( uint8_t bcd, char *text )
+{
+    text[0] = (char)('0' + ((bcd >> 4u) & BCD_NIBBLE));
+    text[1] = (char)('0' + (bcd & BCD_NIBBLE));
+}
+
+/**
+* @brief   **This function gets the name of a month**
+*
+* @param   mon[in] month, range 1 to 12, the same in binary and BCD up to september
+*
+* @retval  three letters of the month, "---" if it is out of range
+*/
+const char *HIL_TIME_MonthName( uint8_t mon )
+{
+    const char *name = NoName;
+
+    if( (mon >= 1u) && (mon <= MONTHS) )
+    {
+        name = MonthNames[mon - 1u];
+    }
+
+    return name;
+}
+
+/**
+* @brief   **This function gets the name of a day of the week**
+*
+*  The name has two letters and a blank.
+*
+* @param   wday[in] day of the week, 1 monday to 7 sunday like the RTC
+*
+* @retval  three characters of the day, "---" if it is out of range
+*/
+const char *HIL_TIME_WeekDayName( uint8_t wday )
+{
+    const char *name = NoName;
+
+    if( (wday >= 1u) && (wday <= DAYS_PER_WEEK) )
+    {
+        name = WeekDayNames[wday - 1u];
+    }
+
+    return name;
+}
+
+/**
+* @brief   **This function gets the number of days of a month**
+*
+* @param   mon[in]  month, range 1 to 12
+* @param   year[in] years since 2000, range 0 to 99
+*
+* @retval  days of the month or 0 if the month is not valid
+*/
+uint8_t HIL_TIME_DaysInMonth( uint8_t mon, uint8_t year )
+{
+    uint8_t days = 0u;
+    uint8_t leap = ((year & LEAP_YEAR_MASK) == 0u) ? 1u : 0u;
+
+    if( (mon >= 1u) && (mon <= MONTHS) )
+    {
+        days = (uint8_t)(DaysBeforeMonth[leap][mon] - DaysBeforeMonth[leap][mon - 1u]);
+    }
+
+    return days;
+}
+
+/**
+* @brief   **This function checks if the calendar fields are a valid time and date**
+*
+*  The day of the week and the day of the year are not checked since they are
+*  calculated by HIL_TIME_FromEpoch.
+*
+* @param   tm[in] Pointer to the calendar fields
+*
+* @retval  TRUE if the time and date are valid, otherwise FALSE
+*/
+uint8_t HIL_TIME_IsValid( const HIL_TIME_TmTypeDef *tm )
+{
+    uint8_t valid = FALSE;
+
+    if( (tm->sec < HIL_TIME_SEC_PER_MIN) && (tm->min < 60u) && (tm->hour < 24u) && (tm->year < HIL_TIME_YEARS) &&
+        (tm->mday >= 1u) && (tm->mday <= HIL_TIME_DaysInMonth( tm->mon, tm->year )) )
+    {
+        valid = TRUE;
+    }
+
+    return valid;
+}
+
+/**
+* @brief   **This function converts calendar fields to seconds since the epoch**
+*
+*  The days are the days of the previous years, where every fourth year starting on 2000
+*  is leap, plus the days before the month from the table and the day of the month,
+*  then the time of the day is added, only multiplications and shifts are used.
+*
+* @param   tm[in] Pointer to valid calendar fields, check them with HIL_TIME_IsValid
+*
+* @retval  seconds since 2000-01-01 00:00:00
+*/
+HIL_TIME_EpochTypeDef HIL_TIME_ToEpoch( const HIL_TIME_TmTypeDef *tm )
+{
+    uint32_t year = tm->year;
+    uint32_t leap = ((year & LEAP_YEAR_MASK) == 0u) ? 1u : 0u;
+    uint32_t days;
+
+    days = (year * YEAR_DAYS) + ((year + 3u) >> 2u) + DaysBeforeMonth[leap][tm->mon - 1u] + tm->mday - 1u;
+
+    return (days * HIL_TIME_SEC_PER_DAY) + ((uint32_t)tm->hour * HIL_TIME_SEC_PER_HOUR) +
+           ((uint32_t)tm->min * HIL_TIME_SEC_PER_MIN) + tm->sec;
+}
+
+/**
+* @brief   **This function converts seconds since the epoch to calendar fields**
+*
+*  The days are split on 4 years cycles, the year inside the cycle and the month are
+*  found comparing against the DaysBeforeYear and DaysBeforeMonth tables, since every month
+*  has between 28 and 31 days the day of the year divided by 32 is the month or the previous
+*  one so only one compare is needed, the time of the day is split with reciprocals.
+*
+* @param   epoch[in] seconds since 2000-01-01 00:00:00
+* @param   tm[out]   Pointer to the calendar fields
+*/
+void HIL_TIME_FromEpoch( HIL_TIME_EpochTypeDef epoch, HIL_TIME_TmTypeDef *tm )
+{
+    uint32_t days   = Time_Days( epoch );
+    uint32_t secs   = epoch - (days * HIL_TIME_SEC_PER_DAY);
+    uint32_t cycle  = (days * CYCLE_MAGIC) >> CYCLE_SHIFT;
+    uint32_t cdays  = days - (cycle * DAYS_PER_CYCLE);
+    uint32_t year   = 3u;
+    uint32_t leap;
+    uint32_t yday;
+    uint32_t mon;
+    uint32_t hour;
+    uint32_t min;
+
+    while( cdays < DaysBeforeYear[year] )
+    {
+        year--;
+    }
+    yday = cdays - DaysBeforeYear[year];
+    leap = (year == 0u) ? 1u : 0u;
+
+    mon = yday >> MONTH_GUESS_SHIFT;
+    if( yday >= DaysBeforeMonth[leap][mon + 1u] )
+    {
+        mon++;
+    }
+
+    hour = ((secs >> 4u) * HOUR_MAGIC) >> HOUR_SHIFT;
+    secs -= hour * HIL_TIME_SEC_PER_HOUR;
+    min  = ((secs >> 2u) * MIN_MAGIC) >> MIN_SHIFT;
+    secs -= min * HIL_TIME_SEC_PER_MIN;
+
+    tm->year = (uint8_t)((cycle << 2u) + year);
+    tm->yday = (uint16_t)yday;
+    tm->mon  = (uint8_t)(mon + 1u);
+    tm->mday = (uint8_t)(yday - DaysBeforeMonth[leap][mon] + 1u);
+    tm->wday = HIL_TIME_WeekDay( epoch );
+    tm->hour = (uint8_t)hour;
+    tm->min  = (uint8_t)min;
+    tm->sec  = (uint8_t)secs;
+}
+
+/**
+* @brief   **This function gets the day of the week**
+*
+* @param   epoch[in] seconds since 2000-01-01 00:00:00
+*
+* @retval  day of the week, 1 monday to 7 sunday like the RTC
+*/
+uint8_t HIL_TIME_WeekDay( HIL_TIME_EpochTypeDef epoch )
+{
+    uint32_t days = Time_Days( epoch ) + EPOCH_WEEKDAY;
+    uint32_t weeks = (days * WEEK_MAGIC) >> WEEK_SHIFT;
+
+    return (uint8_t)(days - (weeks * DAYS_PER_WEEK) + 1u);
+}
+
+/**
+* @brief   **This function adds days to a time**
+*
+*  The time of the day is kept, a negative value goes back in time, the result
+*  has to stay between 2000 and 2099.
+*
+* @param   epoch[in] seconds since 2000-01-01 00:00:00
+* @param   days[in]  days to add
+*
+* @retval  seconds since 2000-01-01 00:00:00
+*/
+HIL_TIME_EpochTypeDef HIL_TIME_AddDays( HIL_TIME_EpochTypeDef epoch, int32_t days )
+{
+    return epoch + ((uint32_t)days * HIL_TIME_SEC_PER_DAY);
+}
+
+/**
+* @brief   **This function gets the number of days between two dates**
+*
+*  Only the date is used, so from 23:59 to 00:00 of the next day is one day.
+*
+* @param   to[in]    seconds since 2000-01-01 00:00:00 of the last date
+* @param   from[in]  seconds since 2000-01-01 00:00:00 of the first date
+*
+* @retval  days from the first date to the last one, negative if the last date is before
+*/
+int32_t HIL_TIME_DiffDays( HIL_TIME_EpochTypeDef to, HIL_TIME_EpochTypeDef from )
+{
+    return (int32_t)Time_Days( to ) - (int32_t)Time_Days( from );
+}
+
+/**
+* @brief   **This function gets the days since the epoch**
+*
+*  The division by 86400 is done with a 32 x 32 bits multiplication keeping the high part.
+*
+* @param   epoch[in] seconds since 2000-01-01 00:00:00
+*
+* @retval  days since 2000-01-01
+*/
+static uint32_t Time_Days( HIL_TIME_EpochTypeDef epoch )
+{
+    return (uint32_t)(((uint64_t)epoch * DAY_MAGIC) >> DAY_SHIFT);
+}
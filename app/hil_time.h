@@ -0,0 +1,86 @@
+/**
+* @file    <hil_time.h>
+* @brief   **Header file for the time library**
+*
+* This file contains the defines, structures and functions declaration to represent
+* time and date as seconds since an epoch and to convert them to calendar fields or BCD,
+* and to show BCD values and the names of the months and days as text.
+* The epoch is 2000-01-01 00:00:00, the same century the RTC is able to count, so the
+* library covers the years 2000 to 2099.
+*/
+#ifndef HIL_TIME_H__
+#define HIL_TIME_H__
+
+    #include "app_bsp.h"
+
+    /**
+    * @defgroup TIME time library values
+    * @{ */
+    #define HIL_TIME_EPOCH_YEAR     2000u       /*!<year of the epoch, time 0 is 2000-01-01 00:00:00*/
+    #define HIL_TIME_YEARS          100u        /*!<number of years covered by the library*/
+    #define HIL_TIME_SEC_PER_MIN    60u         /*!<seconds of one minute*/
+    #define HIL_TIME_SEC_PER_HOUR   3600u       /*!<seconds of one hour*/
+    #define HIL_TIME_SEC_PER_DAY    86400u      /*!<seconds of one day*/
+    #define HIL_TIME_INVALID_BCD    0xFFu       /*!<value returned when a BCD conversion is not valid*/
+    #define HIL_TIME_NAME_SIZE      3u          /*!<letters of the names of the months and the days of the week*/
+    /**
+    * @}
+    */
+
+    /**
+    * @brief  Seconds since 2000-01-01 00:00:00
+    */
+    typedef uint32_t HIL_TIME_EpochTypeDef;
+
+    /**
+    * @brief  HIL_TIME_StampTypeDef time with resolution below one second
+    */
+    typedef struct
+    {
+        HIL_TIME_EpochTypeDef seconds;      /*!<Seconds since the epoch*/
+        uint16_t              subseconds;   /*!<Fraction of the second in 1/65536 units*/
+    } HIL_TIME_StampTypeDef;
+
+    /**
+    * @brief  HIL_TIME_TmTypeDef calendar fields of a time, all the values are binary
+    */
+    typedef struct
+    {
+        uint8_t sec;    /*!<seconds, range 0 to 59*/
+        uint8_t min;    /*!<minutes, range 0 to 59*/
+        uint8_t hour;   /*!<hours, range 0 to 23*/
+        uint8_t mday;   /*!<day of the month, range 1 to 31*/
+        uint8_t mon;    /*!<month, range 1 to 12 like the RTC*/
+        uint8_t year;   /*!<years since 2000, range 0 to 99 like the RTC*/
+        uint8_t wday;   /*!<day of the week, 1 monday to 7 sunday like the RTC*/
+        uint16_t yday;  /*!<day of the year, range 0 to 365*/
+    } HIL_TIME_TmTypeDef;
+
+    /**
+    * @brief  HIL_TIME_BcdTypeDef calendar fields as the RTC keeps them, all the values are BCD
+    */
+    typedef struct
+    {
+        uint8_t sec;    /*!<seconds, 0x00 to 0x59*/
+        uint8_t min;    /*!<minutes, 0x00 to 0x59*/
+        uint8_t hour;   /*!<hours, 0x00 to 0x23*/
+        uint8_t mday;   /*!<day of the month, 0x01 to 0x31*/
+        uint8_t mon;    /*!<month, 0x01 to 0x12*/
+        uint8_t year;   /*!<years since 2000, 0x00 to 0x99*/
+        uint8_t wday;   /*!<day of the week, 1 monday to 7 sunday*/
+    } HIL_TIME_BcdTypeDef;
+
+    uint8_t HIL_TIME_BcdToBin( uint8_t bcd );
+    void HIL_TIME_BcdToAscii( uint8_t bcd, char *text );
+    const char *HIL_TIME_MonthName( uint8_t mon );
+    const char *HIL_TIME_WeekDayName( uint8_t wday );
+    uint8_t HIL_TIME_BinToBcd( uint8_t bin );
+    uint8_t HIL_TIME_DaysInMonth( uint8_t mon, uint8_t year );
+    uint8_t HIL_TIME_IsValid( const HIL_TIME_TmTypeDef *tm );
+    HIL_TIME_EpochTypeDef HIL_TIME_ToEpoch( const HIL_TIME_TmTypeDef *tm );
+    void HIL_TIME_FromEpoch( HIL_TIME_EpochTypeDef epoch, HIL_TIME_TmTypeDef *tm );
+    uint8_t HIL_TIME_WeekDay( HIL_TIME_EpochTypeDef epoch );
+    HIL_TIME_EpochTypeDef HIL_TIME_AddDays( HIL_TIME_EpochTypeDef epoch, int32_t days );
+    int32_t HIL_TIME_DiffDays( HIL_TIME_EpochTypeDef to, HIL_TIME_EpochTypeDef from );
+
+#endif
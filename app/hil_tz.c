@@ -0,0 +1,233 @@
+/**
+* @file    hil_tz.c
+* @brief   **time zone and daylight saving functions**
+*
+*   This is a reusable library to know when the daylight saving time starts and ends,
+*   this files contains all the functions implementation declared on the hil_tz.h file.
+*   Each rule says the month, the week, the day of the week and the hour of the change,
+*   the hour can be UTC, local standard time or local wall clock time, all of them are
+*   converted to local standard time when the transitions are calculated.
+*/
+
+#include "hil_tz.h"
+#include <string.h>
+
+/**
+* @defgroup TZ_base time base of the hour of a rule
+* @{ */
+#define BASE_UTC            0u      /*!<hour is UTC, the offset is added*/
+#define BASE_STANDARD       1u      /*!<hour is local standard time*/
+#define BASE_WALL           2u      /*!<hour is local wall clock time, during daylight saving it is one hour ahead*/
+/**
+* @}
+*/
+
+/**
+* @defgroup TZ_calendar values to find the day of a rule
+* @{ */
+#define DAYS_PER_WEEK       7u      /*!<days of one week*/
+#define LAST_WEEK           5u      /*!<week value for the last week of the month*/
+#define RULE_START          0u      /*!<position of the start rule*/
+#define RULE_END            1u      /*!<position of the end rule*/
+#define CURRENT_YEARS       2u      /*!<the current and the next year are calculated*/
+/**
+* @}
+*/
+
+/**
+* @brief  TZ_RuleTypeDef date and hour of a daylight saving change
+*/
+typedef struct
+{
+    uint8_t month;  /*!<month of the change, range 1 to 12*/
+    uint8_t week;   /*!<week of the month, 1 to 4 or LAST_WEEK*/
+    uint8_t wday;   /*!<day of the week, 1 monday to 7 sunday*/
+    uint8_t hour;   /*!<hour of the change*/
+    uint8_t base;   /*!<time base of the hour, a value of @ref TZ_base*/
+} TZ_RuleTypeDef;
+
+/**
+* @brief  Start and end of the daylight saving of every rule
+*/
+static const TZ_RuleTypeDef RulesTable[HIL_TZ_RULES][CURRENT_YEARS] =
+{
+    { { 0u, 0u, 0u, 0u, BASE_STANDARD },    { 0u, 0u, 0u, 0u, BASE_STANDARD } },    /*HIL_TZ_RULE_NONE*/
+    { { 3u, LAST_WEEK, 7u, 1u, BASE_UTC },  { 10u, LAST_WEEK, 7u, 1u, BASE_UTC } }, /*HIL_TZ_RULE_EU*/
+    { { 3u, 2u, 7u, 2u, BASE_STANDARD },    { 11u, 1u, 7u, 2u, BASE_WALL } },       /*HIL_TZ_RULE_US*/
+    { { 10u, 1u, 7u, 2u, BASE_STANDARD },   { 4u, 1u, 7u, 3u, BASE_WALL } }         /*HIL_TZ_RULE_AU*/
+};
+
+static HIL_TIME_EpochTypeDef Tz_Transition( const TZ_RuleTypeDef *rule, uint8_t year, int16_t offset, uint8_t type );
+
+/**
+* @brief   **This function calculates the transitions of the current and the next year**
+*
+*  The start and end of the daylight saving of the year of the given time and the next one
+*  are calculated on local standard time and sorted with an insertion sort, then the next
+*  transition is the first one after the given time. This is only done on the configuration
+*  and once every year, not on every second.
+*
+* @param   htz[in]      Pointer to a TZ_HandleTypeDef structure with Offset and Rule configured
+* @param   standard[in] current local standard time
+*/
+void HIL_TZ_Init( TZ_HandleTypeDef *htz, HIL_TIME_EpochTypeDef standard )
+{
+    HIL_TIME_TmTypeDef tm;
+    HIL_TIME_EpochTypeDef transition;
+    uint8_t count = 0u;
+    uint8_t pos;
+    uint8_t year;
+
+    assert_error( (htz->Rule < HIL_TZ_RULES), TZ_PAR_ERROR ); /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+
+    HIL_TIME_FromEpoch( standard, &tm );
+    for( uint8_t i = 0u; i < CURRENT_YEARS; i++ )
+    {
+        year = tm.year + i;
+        for( uint8_t type = RULE_START; type <= RULE_END; type++ )
+        {
+            transition = HIL_TZ_NEVER;
+            if( (htz->Rule != HIL_TZ_RULE_NONE) && (year < HIL_TIME_YEARS) )
+            {
+                transition = Tz_Transition( &RulesTable[htz->Rule][type], year, htz->Offset, type );
+            }
+
+            pos = count;
+            while( (pos > 0u) && (htz->Transition[pos - 1u] > transition) )
+            {
+                htz->Transition[pos] = htz->Transition[pos - 1u];
+                htz->Type[pos]       = htz->Type[pos - 1u];
+                pos--;
+            }
+            htz->Transition[pos] = transition;
+            htz->Type[pos]       = (type == RULE_START) ? HIL_TZ_DST_START : HIL_TZ_DST_END;
+            count++;
+        }
+    }
+
+    if( htz->Rule == HIL_TZ_RULE_NONE )
+    {
+        (void)memset( htz->Type, HIL_TZ_NO_CHANGE, sizeof(htz->Type) );
+    }
+
+    htz->Next = 0u;
+    while( (htz->Next < (HIL_TZ_TRANSITIONS - 1u)) && (htz->Transition[htz->Next] <= standard) )
+    {
+        htz->Next++;
+    }
+}
+
+/**
+* @brief   **This function checks if a daylight saving change has to be done**
+*
+*  Only the next transition is compared, when it is reached the function returns the type of
+*  change and moves to the following one, once both transitions of the current year have
+*  passed the transitions are calculated again so there is always one on the future.
+*
+* @param   htz[in]      Pointer to a TZ_HandleTypeDef structure
+* @param   standard[in] current local standard time
+*
+* @retval  HIL_TZ_NO_CHANGE, HIL_TZ_DST_START or HIL_TZ_DST_END
+*/
+uint8_t HIL_TZ_Check( TZ_HandleTypeDef *htz, HIL_TIME_EpochTypeDef standard )
+{
+    uint8_t change = HIL_TZ_NO_CHANGE;
+
+    if( standard >= htz->Transition[htz->Next] )
+    {
+        change = htz->Type[htz->Next];
+        htz->Next++;
+        if( htz->Next >= CURRENT_YEARS )
+        {
+            HIL_TZ_Init( htz, standard );
+        }
+    }
+
+    return change;
+}
+
+/**
+* @brief   **This function tells if the daylight saving is active at a given time**
+*
+*  The state is given by the last transition before the time, if the time is before
+*  all the transitions the state is the opposite of the first one.
+*
+* @param   htz[in]      Pointer to a TZ_HandleTypeDef structure initialized on the same year
+* @param   standard[in] local standard time
+*
+* @retval  TRUE if the daylight saving is active, otherwise FALSE
+*/
+uint8_t HIL_TZ_IsDst( const TZ_HandleTypeDef *htz, HIL_TIME_EpochTypeDef standard )
+{
+    uint8_t dst = (htz->Type[0] == HIL_TZ_DST_END) ? TRUE : FALSE;
+
+    for( uint8_t i = 0u; i < HIL_TZ_TRANSITIONS; i++ )
+    {
+        if( htz->Transition[i] <= standard )
+        {
+            dst = (htz->Type[i] == HIL_TZ_DST_START) ? TRUE : FALSE;
+        }
+    }
+
+    return dst;
+}
+
+/**
+* @brief   **This function calculates one transition on local standard time**
+*
+*  The first day of the month that is the day of the week of the rule is found with the
+*  day of the week of the first day of the month, then the weeks are added, for the last
+*  week if the day is outside the month one week is subtracted. Then the hour is converted
+*  to local standard time depending on its time base.
+*
+* @param   rule[in]     Pointer to the rule
+* @param   year[in]     years since 2000
+* @param   offset[in]   minutes of the standard time from UTC
+* @param   type[in]     RULE_START or RULE_END
+*
+* @retval  transition in local standard time
+*/
+static HIL_TIME_EpochTypeDef Tz_Transition( const TZ_RuleTypeDef *rule, uint8_t year, int16_t offset, uint8_t type )
+{
+    HIL_TIME_TmTypeDef tm = {0};
+    HIL_TIME_EpochTypeDef transition;
+    uint32_t day;
+    uint8_t first_wday;
+
+    tm.year = year;
+    tm.mon  = rule->month;
+    tm.mday = 1u;
+    transition = HIL_TIME_ToEpoch( &tm );
+    first_wday = HIL_TIME_WeekDay( transition );
+
+    day = (rule->wday >= first_wday) ? (uint32_t)rule->wday - first_wday : ((uint32_t)rule->wday + DAYS_PER_WEEK) - first_wday;
+    day += ((uint32_t)rule->week - 1u) * DAYS_PER_WEEK;
+    if( day >= HIL_TIME_DaysInMonth( rule->month, year ) )
+    {
+        day -= DAYS_PER_WEEK;
+    }
+    transition += (day * HIL_TIME_SEC_PER_DAY) + ((uint32_t)rule->hour * HIL_TIME_SEC_PER_HOUR);
+
+    if( rule->base == BASE_UTC )
+    {
+        /*local standard time is UTC plus the offset*/
+        if( offset >= 0 )
+        {
+            transition += (uint32_t)offset * HIL_TIME_SEC_PER_MIN;
+        }
+        else
+        {
+            transition -= (uint32_t)(-offset) * HIL_TIME_SEC_PER_MIN;
+        }
+    }
+    else if( (rule->base == BASE_WALL) && (type == RULE_END) )
+    {
+        /*the end happens while the wall clock is one hour ahead of the standard time*/
+        transition -= HIL_TIME_SEC_PER_HOUR;
+    }
+    else
+    {
+    }
+
+    return transition;
+}
@@ -0,0 +1,66 @@
+/**
+* @file    <hil_tz.h>
+* @brief   **Header file for the time zone and daylight saving library**
+*
+* This file contains the defines, structures and functions declaration to know when the
+* daylight saving time starts and ends. The transitions of the current and the next year
+* are calculated once and kept sorted, so checking if a change is needed is one comparison.
+* All the times are local standard time (the local time without daylight saving) in seconds
+* since 2000-01-01 00:00:00, see hil_time.h
+*/
+#ifndef HIL_TZ_H__
+#define HIL_TZ_H__
+
+    #include "app_bsp.h"
+    #include "hil_time.h"
+
+    /**
+    * @defgroup TZ_rules daylight saving rules, index of the rules table
+    * @{ */
+    #define HIL_TZ_RULE_NONE        0u      /*!<no daylight saving*/
+    #define HIL_TZ_RULE_EU          1u      /*!<last sunday of march to last sunday of october at 01:00 UTC*/
+    #define HIL_TZ_RULE_US          2u      /*!<second sunday of march to first sunday of november at 02:00 local*/
+    #define HIL_TZ_RULE_AU          3u      /*!<first sunday of october to first sunday of april at 02:00 local standard*/
+    #define HIL_TZ_RULES            4u      /*!<number of rules on the table*/
+    /**
+    * @}
+    */
+
+    /**
+    * @defgroup TZ_change values returned by HIL_TZ_Check
+    * @{ */
+    #define HIL_TZ_NO_CHANGE        0u      /*!<no transition has been reached*/
+    #define HIL_TZ_DST_START        1u      /*!<daylight saving starts, add one hour*/
+    #define HIL_TZ_DST_END          2u      /*!<daylight saving ends, subtract one hour*/
+    /**
+    * @}
+    */
+
+    /**
+    * @defgroup TZ_values time zone values
+    * @{ */
+    #define HIL_TZ_TRANSITIONS      4u              /*!<transitions of the current and the next year*/
+    #define HIL_TZ_NEVER            0xFFFFFFFFu     /*!<transition that will never be reached*/
+    #define HIL_TZ_MAX_OFFSET       840             /*!<max offset from UTC in minutes, UTC+14*/
+    #define HIL_TZ_MIN_OFFSET       (-720)          /*!<min offset from UTC in minutes, UTC-12*/
+    /**
+    * @}
+    */
+
+    /**
+    * @brief  TZ_HandleTypeDef time zone configuration and precalculated transitions
+    */
+    typedef struct
+    {
+        int16_t               Offset;                           /*!<Minutes of the standard time from UTC*/
+        uint8_t               Rule;                             /*!<Daylight saving rule, a value of @ref TZ_rules*/
+        HIL_TIME_EpochTypeDef Transition[HIL_TZ_TRANSITIONS];   /*!<Transitions in local standard time, sorted*/
+        uint8_t               Type[HIL_TZ_TRANSITIONS];         /*!<HIL_TZ_DST_START or HIL_TZ_DST_END for each transition*/
+        uint8_t               Next;                             /*!<Index of the next transition*/
+    } TZ_HandleTypeDef;
+
+    void HIL_TZ_Init( TZ_HandleTypeDef *htz, HIL_TIME_EpochTypeDef standard );
+    uint8_t HIL_TZ_Check( TZ_HandleTypeDef *htz, HIL_TIME_EpochTypeDef standard );
+    uint8_t HIL_TZ_IsDst( const TZ_HandleTypeDef *htz, HIL_TIME_EpochTypeDef standard );
+
+#endif
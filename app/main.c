@@ -3,6 +3,11 @@
 #include "app_clock.h"
 #include "app_display.h"
 #include "app_analog.h"
+#include "app_canhealth.h"
+#include "app_rtccal.h"
+#include "app_config.h"
+#include "app_stopwatch.h"
+#include "app_log.h"
 #include "scheduler.h"
 
 
@@ -15,7 +20,11 @@
 #define CLOCK_TASK_TICK     50u     /*!<Clock task periodicity*/     
 #define DISPLAY_TASK_TICK   100u    /*!<Display task periodicity*/
 #define ANALOG_TIMER       50u   /*!<Software timer one second value*/
-#define ONE_SEC_TIMER       1000u   /*!<Software timer one second value*/
+#define CAN_HEALTH_TICK     50u     /*!<CAN health task periodicity*/
+#define RTC_CAL_TICK        1000u   /*!<RTC compensation task periodicity, one temperature sample per second*/
+#define CONFIG_TASK_TICK    100u    /*!<Configuration task periodicity*/
+#define STOPWATCH_TASK_TICK 10u     /*!<Stopwatch task periodicity, one hundredth of second*/
+#define LOG_TASK_TICK       10u     /*!<Event log task periodicity*/
 /**
   @} */
 
@@ -38,9 +47,9 @@
 /** 
   * @defgroup Scheduler values configuration.
   @{ */  
-#define TASK_NUMBERS          6    /*!<Number of tasks to be handle by the scheduler*/
+#define TASK_NUMBERS          11   /*!<Number of tasks to be handle by the scheduler*/
 #define SCHEDULER_TICK        5    /*!<Tick value of the scheduler*/
-#define TIMER_NUMBERS         1    /*!<Tick value of the scheduler*/
+#define WORK_NUMBERS          2    /*!<Number of deferred works posted by the interrupts*/
 /**
   @} */
 
@@ -74,28 +83,35 @@ static void peth_the_dog(void);
 */
 int main( void )
 {
-  uint32_t timer_1S; 
-  
   Task_TypeDef hsche_tasks[TASK_NUMBERS];
+  Work_TypeDef hsche_works[WORK_NUMBERS];
   sched.tasks   = TASK_NUMBERS;
   sched.tick    = SCHEDULER_TICK;
   sched.taskPtr = hsche_tasks;
   HIL_SCHEDULER_Init(&sched);
 
-  Timer_TypeDef hsche_timer[TIMER_NUMBERS];
-  sched.timers   = TIMER_NUMBERS;
-  sched.timerPtr = hsche_timer;
-  timer_1S = HIL_SCHEDULER_RegisterTimer( &sched, ONE_SEC_TIMER, Display_msg );
-  (void)HIL_SCHEDULER_StartTimer( &sched,timer_1S);
+  /*the display is refreshed by the RTC second event, no software timers are needed*/
+  sched.timers   = 0u;
+  sched.timerPtr = NULL;
+
+  /*the works are registered by the init of the tasks that own the interrupts*/
+  sched.works   = WORK_NUMBERS;
+  sched.workPtr = hsche_works;
 
   HAL_Init();
 
   (void)HIL_SCHEDULER_RegisterTask( &sched,init_watchdog,peth_the_dog,WATCHDOG_REFRESH);
+  /*the configuration is loaded before the init of the other tasks*/
+  (void)HIL_SCHEDULER_RegisterTask( &sched,Config_Init,Config_Task,CONFIG_TASK_TICK);
   (void)HIL_SCHEDULER_RegisterTask( &sched,Serial_Init,Serial_Task,SERIAL_TASK_TICK);
   (void)HIL_SCHEDULER_RegisterTask( &sched,Clock_Init,Clock_Task,CLOCK_TASK_TICK);
   (void)HIL_SCHEDULER_RegisterTask( &sched,Display_Init,Display_Task,DISPLAY_TASK_TICK);
   (void)HIL_SCHEDULER_RegisterTask( &sched,hearth_init,hearth_beat,HEARTH_TICK_VALUE);
   (void)HIL_SCHEDULER_RegisterTask( &sched,Analogs_Init,Display_LcdTask,ANALOG_TIMER);
+  (void)HIL_SCHEDULER_RegisterTask( &sched,CanHealth_Init,CanHealth_Task,CAN_HEALTH_TICK);
+  (void)HIL_SCHEDULER_RegisterTask( &sched,RtcCal_Init,RtcCal_Task,RTC_CAL_TICK);
+  (void)HIL_SCHEDULER_RegisterTask( &sched,Stopwatch_Init,Stopwatch_Task,STOPWATCH_TASK_TICK);
+  (void)HIL_SCHEDULER_RegisterTask( &sched,Log_Init,Log_Task,LOG_TASK_TICK);
 
   HIL_SCHEDULER_Start(&sched);
 }
@@ -200,6 +216,8 @@ void safe_state( uint8_t *file, uint32_t line, uint8_t error )
   /*disable all maskable interrupts*/
   HAL_Init();
   __disable_irq();
+  /*the error is written on the event log before the peripherals are stopped*/
+  Log_Fatal( error, line );
     
   __HAL_RCC_FDCAN_CLK_DISABLE();
   __HAL_RCC_GPIOD_CLK_DISABLE();
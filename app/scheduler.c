@@ -41,6 +41,7 @@ void HIL_SCHEDULER_Init( Scheduler_HandleTypeDef *hscheduler )
     assert_error( (hscheduler->tick != FALSE), SCHEDULER_ERROR );   /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
     hscheduler->tasksCount = ZERO;
     hscheduler->timerCount = ZERO;
+    hscheduler->workCount = ZERO;
 }
 
 /**
@@ -167,7 +168,9 @@ uint8_t HIL_SCHEDULER_PeriodTask( Scheduler_HandleTypeDef *hscheduler, uint32_t
 */
 static uint32_t shceduler_error(uint32_t error)
 {
-    uint32_t return_error[5]= {SHCEDULER_WATCHDOG_ERROR, SHCEDULER_SERIAL_ERROR, SHCEDULER_CLOCK_ERROR, SHCEDULER_DISPLAY_ERROR, SHCEDULER_HEARTH_ERROR};
+    uint32_t return_error[11]= {SHCEDULER_WATCHDOG_ERROR, SHCEDULER_CONFIG_ERROR, SHCEDULER_SERIAL_ERROR, SHCEDULER_CLOCK_ERROR, SHCEDULER_DISPLAY_ERROR,
+                               SHCEDULER_HEARTH_ERROR, SHCEDULER_ANALOG_ERROR, SHCEDULER_CANHEALTH_ERROR, SHCEDULER_RTCCAL_ERROR, SHCEDULER_STOPWATCH_ERROR,
+                               SHCEDULER_LOG_ERROR};
     return return_error[error];
 }
 
@@ -177,7 +180,9 @@ static uint32_t shceduler_error(uint32_t error)
 *   This is the function in charge of running the task init functions one single time and actual
 *   run each registered task according to their periodicity in an infinite loop, 
 *   the function will never return at least something wrong happens, but this will be considered a malfunction.
-*   the function will be checking each tick if the period of a task has passed to be executed
+*   the function will be checking each tick if the period of a task has passed to be executed,
+*   the deferred works posted by the interrupts are run on every turn of the loop so they wait
+*   at most the longest task and never the tick.
 *   the task also has a functional safety measure where it checks with the basic timer 6
 *   if the task has not been called in more time than the period plus 10%
 *   we want the preescaler on the miliseconds frequency so the calculations are:
@@ -214,6 +219,16 @@ void HIL_SCHEDULER_Start( Scheduler_HandleTypeDef *hscheduler )
 
     for (;;)
     {
+        for (i = ZERO; i < hscheduler->workCount; i++)
+        {
+            if(((hscheduler->workPtr)+i)->Pending == TRUE)                                                                  /* cppcheck-suppress misra-c2012-18.4 ; operator to pointer is needed */
+            {
+                /*cleared before the run so a post during the work runs it again*/
+                ((hscheduler->workPtr)+i)->Pending = FALSE;                                                                 /* cppcheck-suppress misra-c2012-18.4 ; operator to pointer is needed */
+                ((hscheduler->workPtr)+i)->workPtr();                                                                       /* cppcheck-suppress misra-c2012-18.4 ; operator to pointer is needed */
+            }
+        }
+
         if( HAL_GetTick() - (hscheduler->elapsed_time ) >= hscheduler->tick )
         {
             hscheduler->elapsed_time = HAL_GetTick();
@@ -402,4 +417,58 @@ uint8_t HIL_SCHEDULER_StopTimer( Scheduler_HandleTypeDef *hscheduler, uint32_t T
     }
 
     return Timer_Status;
-}
\ No newline at end of file
+}
+
+/**
+* @brief   **This function register a deferred work for the scheduler**
+*
+*   this function sets the hscheduler work with the address of the function that does the work,
+*   the interrupts post the work with the returned ID and the scheduler loop runs it, so the
+*   interrupt only sets a flag and the work runs at task level without interleaving with the tasks.
+*   It can be called from the init function of a task.
+*
+* @param   hscheduler[in] Pointer to a Scheduler_HandleTypeDef structure 
+* @param   WorkPtr[in] Pointer to the work function 
+* @retval  Work_ID Is number from 1 to n work registered if the operation was a success, otherwise, it will return zero. 
+*/
+uint8_t HIL_SCHEDULER_RegisterWork( Scheduler_HandleTypeDef *hscheduler, void (*WorkPtr)(void) )
+{
+    assert_error( (WorkPtr != NULL), SCHEDULER_ERROR ); /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+    assert_error( (hscheduler->workPtr != NULL), SCHEDULER_ERROR ); /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+    assert_error( (hscheduler->works != FALSE), SCHEDULER_ERROR );  /* cppcheck-suppress misra-c2012-11.8 ; function cannot be modify */
+    uint8_t Work_ID = FALSE;
+
+    if(hscheduler->workCount < hscheduler->works)
+    {
+        ((hscheduler->workPtr) + hscheduler->workCount)->workPtr = WorkPtr;    /* cppcheck-suppress misra-c2012-18.4 ; operator to pointer is needed */
+        ((hscheduler->workPtr) + hscheduler->workCount)->Pending = FALSE;      /* cppcheck-suppress misra-c2012-18.4 ; operator to pointer is needed */
+        Work_ID = hscheduler->workCount + ONE;
+        hscheduler->workCount++;
+    }
+
+    return Work_ID;
+}
+
+/**
+* @brief   **This function posts a deferred work**
+*
+*   the function first checks if the work has been register by comparing it with the workcount
+*   and then sets its pending flag, the write of the flag is one store so it can be called from
+*   any interrupt. A work posted again before it runs only runs once.
+*
+* @param   hscheduler[in] Pointer to a Scheduler_HandleTypeDef structure 
+* @param   Work[in] Work to post  
+* @retval  Work_Status returns if the operation was a success.  
+*/
+uint8_t HIL_SCHEDULER_PostWork( Scheduler_HandleTypeDef *hscheduler, uint32_t Work )
+{
+    uint8_t Work_Status = FALSE;
+
+    if ((Work <= hscheduler->workCount) && (Work > ZERO))
+    {
+        ((hscheduler->workPtr)+(Work-ONE))->Pending = TRUE;     /* cppcheck-suppress misra-c2012-18.4 ; operator to pointer is needed */
+        Work_Status = TRUE;
+    }
+
+    return Work_Status;
+}
@@ -36,6 +36,15 @@
       void(*callbackPtr)(void);   /*!< pointer to callback function function */
   } Timer_TypeDef;
   
+  /** 
+  * @defgroup _Work_TypeDef parameters for deferred work posted by the interrupts
+  @{ */
+  typedef struct _Work_TypeDef
+  {
+      void(*workPtr)(void);       /*!< pointer to the function that runs the work on the scheduler loop */
+      volatile uint8_t Pending;   /*!< flag set by the interrupt that posted the work */
+  } Work_TypeDef;
+
   /** 
   * @defgroup Scheduler_HandleTypeDef parameters for the scheduler
   @{ */
@@ -49,6 +58,9 @@
     uint32_t timers;        /*!<number of software timer to use*/
     uint32_t timerCount;    /*!<internal timer counter*/
     Timer_TypeDef *timerPtr; /*!<Pointer to buffer timer array*/
+    uint32_t works;         /*!<number of deferred works to use*/
+    uint32_t workCount;     /*!<internal work counter*/
+    Work_TypeDef *workPtr;  /*!<Pointer to buffer work array*/
     //Add more elements if required
   }Scheduler_HandleTypeDef;
 
@@ -65,4 +77,12 @@
   uint8_t HIL_SCHEDULER_StartTimer( Scheduler_HandleTypeDef *hscheduler, uint32_t Timer );
   uint8_t HIL_SCHEDULER_StopTimer( Scheduler_HandleTypeDef *hscheduler, uint32_t Timer );
 
+  uint8_t HIL_SCHEDULER_RegisterWork( Scheduler_HandleTypeDef *hscheduler, void (*WorkPtr)(void) );
+  uint8_t HIL_SCHEDULER_PostWork( Scheduler_HandleTypeDef *hscheduler, uint32_t Work );
+
+  /**
+  * @brief  Scheduler of the application, the interrupts post their deferred work on it.
+  */
+  extern Scheduler_HandleTypeDef sched;
+
 #endif
\ No newline at end of file
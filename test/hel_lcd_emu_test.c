@@ -0,0 +1,145 @@
+/**
+* @file    hel_lcd_emu_test.c
+* @brief   **Host test of the lcd driver on the emulated ST7032**
+*
+*   The driver is linked with the emulator (make host), each check flushes the frame buffer,
+*   runs the emulator and compares the rows and the SPI traffic with what the driver has to
+*   send: the bytes and the chip selects of a full frame and of a delta of one character, a
+*   glyph set already loaded that costs nothing and no byte sent while the controller was busy.
+*   The program returns the number of failed checks so make stops on a failure.
+* @note    Only for the host, it is not part of the firmware
+*/
+#include <stdio.h>
+#include <string.h>
+#include "hel_lcd_emu.h"
+
+/**
+  * @defgroup Test_values expected values of the checks
+  @{ */
+#define TEST_ROW_SIZE       17u     /*!< Characters of one row plus the end of string*/
+#define TEST_FRAME_BYTES    28u     /*!< Bytes of a full frame, DDRAM address and 16 characters per row minus the unchanged ones*/
+#define TEST_FRAME_SELECTS  10u     /*!< Chip selects of a full frame, one for the address and one for the characters of each of its 5 runs*/
+#define TEST_DELTA_BYTES    2u      /*!< Bytes of a change of one character, its DDRAM address and the character*/
+#define TEST_DELTA_SELECTS  2u      /*!< Chip selects of a change of one character, one for the address and one for the character*/
+#define TEST_GLYPH          2u      /*!< Custom character loaded by the test*/
+/**
+  @} */
+
+static GPIO_TypeDef PortA;
+static GPIO_TypeDef PortB;
+static GPIO_TypeDef PortD;
+static SPI_HandleTypeDef SpiHandler;
+static TIM_HandleTypeDef TimHandler;
+static LCD_HandleTypeDef LcdHandler;
+static unsigned int Failures = 0u;
+
+static const uint8_t Glyph[1][HEL_LCD_GLYPH_ROWS] = { { 0x01u, 0x02u, 0x04u, 0x08u, 0x10u, 0x08u, 0x04u, 0x02u } };
+
+static void Test_Check( int condition, const char *name );
+static void Test_Row( uint8_t line, const char *expected );
+static void Test_Run( HEL_LCD_EMU_StatsTypeDef *stats );
+
+/**
+* @brief   **Runs the checks of the driver on the emulator**
+*
+* @retval  Number of failed checks, zero when all of them passed
+*/
+int main( void )
+{
+    HEL_LCD_EMU_StatsTypeDef stats;
+    uint8_t rows[HEL_LCD_GLYPH_ROWS];
+
+    LcdHandler.SpiHandler = &SpiHandler;
+    LcdHandler.TimHandler = &TimHandler;
+    LcdHandler.RstPort    = &PortD;
+    LcdHandler.RstPin     = GPIO_PIN_1;
+    LcdHandler.RsPort     = &PortA;
+    LcdHandler.RsPin      = GPIO_PIN_2;
+    LcdHandler.CsPort     = &PortA;
+    LcdHandler.CsPin      = GPIO_PIN_4;
+    LcdHandler.BklPort    = &PortB;
+    LcdHandler.BklPin     = GPIO_PIN_4;
+
+    (void)HEL_LCD_Init( &LcdHandler );
+    Test_Run( &stats );
+    Test_Check( stats.violations == 0u, "init without violations" );
+
+    /*a full frame*/
+    HEL_LCD_Write( &LcdHandler, FIRST_ROW, 0u, " JAN,01 2000 MO " );
+    HEL_LCD_Write( &LcdHandler, SECOND_ROW, 0u, "   12:30:45 25C " );
+    Test_Check( HEL_LCD_Flush( &LcdHandler ) == HAL_OK, "frame flushed" );
+    Test_Run( &stats );
+    Test_Row( 0u, " JAN,01 2000 MO " );
+    Test_Row( 1u, "   12:30:45 25C " );
+    Test_Check( stats.bytes == TEST_FRAME_BYTES, "frame bytes" );
+    Test_Check( stats.selects == TEST_FRAME_SELECTS, "frame chip selects" );
+    Test_Check( stats.violations == 0u, "frame without violations" );
+
+    /*only the character that changed is sent*/
+    HEL_LCD_Write( &LcdHandler, SECOND_ROW, 10u, "6" );
+    Test_Check( HEL_LCD_Flush( &LcdHandler ) == HAL_OK, "delta flushed" );
+    Test_Run( &stats );
+    Test_Row( 1u, "   12:30:46 25C " );
+    Test_Check( stats.bytes == TEST_DELTA_BYTES, "delta bytes" );
+    Test_Check( stats.selects == TEST_DELTA_SELECTS, "delta chip selects" );
+    Test_Check( stats.violations == 0u, "delta without violations" );
+
+    /*a glyph set already on the CGRAM is not sent again*/
+    Test_Check( HEL_LCD_LoadGlyphs( &LcdHandler, TEST_GLYPH, Glyph, 1u ) == HAL_OK, "glyph loaded" );
+    Test_Run( &stats );
+    HEL_LCD_EMU_GetGlyph( TEST_GLYPH, rows );
+    Test_Check( memcmp( rows, Glyph[0], HEL_LCD_GLYPH_ROWS ) == 0, "glyph rows" );
+    Test_Check( stats.bytes > 0u, "glyph bytes" );
+    Test_Check( stats.violations == 0u, "glyph without violations" );
+    Test_Check( HEL_LCD_LoadGlyphs( &LcdHandler, TEST_GLYPH, Glyph, 1u ) == HAL_OK, "glyph cached" );
+    Test_Run( &stats );
+    Test_Check( stats.bytes == 0u, "glyph cache hit without bytes" );
+    Test_Check( stats.selects == 0u, "glyph cache hit without chip selects" );
+
+    printf( "hel_lcd_emu_test: %u failed\n", Failures );
+    return (int)Failures;
+}
+
+/**
+* @brief   **Counts and prints a failed check**
+*
+* @param   condition[in]  zero when the check failed
+* @param   name[in]       name of the check
+*/
+static void Test_Check( int condition, const char *name )
+{
+    if( condition == 0 )
+    {
+        Failures++;
+        printf( "FAIL: %s\n", name );
+    }
+}
+
+/**
+* @brief   **Compares a row shown by the emulator**
+*
+* @param   line[in]      0 for the first row, 1 for the second
+* @param   expected[in]  the 16 characters the row has to show
+*/
+static void Test_Row( uint8_t line, const char *expected )
+{
+    char text[TEST_ROW_SIZE];
+
+    HEL_LCD_EMU_GetRow( line, text );
+    if( strcmp( text, expected ) != 0 )
+    {
+        Failures++;
+        printf( "FAIL: row %u shows [%s] instead of [%s]\n", line, text, expected );
+    }
+}
+
+/**
+* @brief   **Runs the emulator and takes the counters of the traffic**
+*
+* @param   stats[out]  counters since the last run
+*/
+static void Test_Run( HEL_LCD_EMU_StatsTypeDef *stats )
+{
+    HEL_LCD_EMU_Run();
+    HEL_LCD_EMU_GetStats( stats );
+}